@@ -0,0 +1,115 @@
+// Measures the heap held by keep-alive connections waiting for their next request
+// Each connection serves one request over a socketpair and then stays open
+// The requests are served one at a time, as on a server where few of many open connections are active at once
+// Usage: idle_connection_bench [connections] (keep 2 * connections below the fd limit)
+#include "config/config.hpp"
+#include "handler/handler.hpp"
+#include "server/connection.hpp"
+#include "server/connection_pool.hpp"
+#include "task/io_task_manager.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <malloc.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    const std::size_t kDefaultConnections = 400;
+    const char kRequest[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+    std::size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        return mallinfo2().uordblks;
+#else
+        return static_cast<std::size_t>(mallinfo().uordblks);
+#endif
+    }
+
+    // サーバー側の fd を返す. クライアント側は clients に積む
+    int connectPair(std::vector<int> &clients) {
+        int fds[2] = {-1, -1};
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+            std::perror("socketpair");
+            std::exit(1);
+        }
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+        clients.push_back(fds[1]);
+        return fds[0];
+    }
+
+    void runLoop(IOTaskManager &manager) {
+        for (int i = 0; i < 8; i++) {
+            manager.executeReadyTasks(0);
+        }
+    }
+
+    // 1 人ずつリクエストを送り, レスポンスを読み捨てる
+    void serveOneRequest(IOTaskManager &manager, const std::vector<int> &clients) {
+        char buf[4096];
+        for (std::size_t i = 0; i < clients.size(); i++) {
+            if (write(clients[i], kRequest, sizeof(kRequest) - 1) == -1) {
+                std::perror("write");
+            }
+            runLoop(manager);
+            while (read(clients[i], buf, sizeof(buf)) > 0) {
+            }
+        }
+    }
+
+    void closeClients(IOTaskManager &manager, std::vector<int> &clients) {
+        for (std::size_t i = 0; i < clients.size(); i++) {
+            close(clients[i]);
+        }
+        clients.clear();
+        runLoop(manager);
+    }
+
+    void report(const char *name, std::size_t before, std::size_t after, std::size_t connections) {
+        std::cout << name << ": " << (after - before) / connections << " bytes per idle connection" << std::endl;
+    }
+
+    // 接続ごとに読み込みバッファを持つ
+    void measureUnpooled(IOTaskManager &manager, Handler &handler, const Config &config, std::size_t connections) {
+        std::vector<int> clients;
+        const std::size_t before = heapInUse();
+        for (std::size_t i = 0; i < connections; i++) {
+            (new Connection(manager, connectPair(clients), &handler, config))->start();
+        }
+        serveOneRequest(manager, clients);
+        report("without buffer pool", before, heapInUse(), connections);
+        closeClients(manager, clients);
+    }
+
+    void measurePooled(IOTaskManager &manager, Handler &handler, const Config &config, std::size_t connections) {
+        std::vector<int> clients;
+        const std::size_t before = heapInUse();
+        ConnectionPool pool(manager, &handler, config, connections);
+        for (std::size_t i = 0; i < connections; i++) {
+            pool.acquire(connectPair(clients))->start();
+        }
+        serveOneRequest(manager, clients);
+        report("with buffer pool", before, heapInUse(), connections);
+        closeClients(manager, clients);
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t connections = argc > 1 ? std::strtoul(argv[1], NULL, 10) : kDefaultConnections;
+    if (connections == 0) {
+        std::cerr << "usage: " << argv[0] << " [connections]" << std::endl;
+        return 1;
+    }
+    IOTaskManager manager;
+    Handler handler;
+    const Config config;
+
+    // fd の表などを先に広げておき, 計測に含めない
+    measureUnpooled(manager, handler, config, connections);
+    measureUnpooled(manager, handler, config, connections);
+    measurePooled(manager, handler, config, connections);
+    return 0;
+}
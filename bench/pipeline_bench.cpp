@@ -0,0 +1,98 @@
+// Measures requests per second of one connection receiving pipelined GETs, wrk-style
+// The client sends depth requests at once and waits for all the responses before sending again
+// Usage: pipeline_bench [depth] [rounds]
+#include "config/config.hpp"
+#include "handler/handler.hpp"
+#include "http/date_header.hpp"
+#include "server/connection.hpp"
+#include "task/io_task_manager.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    const unsigned int kDefaultDepth = 16;
+    const unsigned int kDefaultRounds = 20000;
+    const char kRequest[] = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    // Date の行を除いたレスポンス
+    const char kResponse[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nContent-Type: text/plain\r\n\r\n";
+
+    double nowSeconds() {
+        struct timespec ts = {};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+    }
+
+    // 1 ラウンドで返ってくるレスポンスを全て読むまでイベントループを回す
+    bool runRound(IOTaskManager &manager, int client_fd, const std::string &requests, std::size_t response_bytes) {
+        if (write(client_fd, requests.data(), requests.size()) != static_cast<ssize_t>(requests.size())) {
+            std::perror("write");
+            return false;
+        }
+        std::size_t received = 0;
+        char buf[64 * 1024];
+        while (received < response_bytes) {
+            if (manager.executeReadyTasks(IOTaskManager::kWaitForever).isErr()) {
+                return false;
+            }
+            const ssize_t n = read(client_fd, buf, sizeof(buf));
+            if (n > 0) {
+                received += static_cast<std::size_t>(n);
+            }
+        }
+        return true;
+    }
+
+    double measure(unsigned int pipeline_depth, unsigned int depth, unsigned int rounds) {
+        int fds[2] = {-1, -1};
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+            std::perror("socketpair");
+            std::exit(1);
+        }
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+        Config config;
+        config.setKeepaliveRequests(rounds * depth + 1);
+        config.setPipelineDepth(pipeline_depth);
+        IOTaskManager manager;
+        Handler handler;
+        (new Connection(manager, fds[0], &handler, config))->start();
+
+        std::string requests;
+        for (unsigned int i = 0; i < depth; i++) {
+            requests += kRequest;
+        }
+        const std::size_t response_bytes = (sizeof(kResponse) - 1 + DateHeader::kSize) * depth;
+
+        const double start = nowSeconds();
+        for (unsigned int i = 0; i < rounds; i++) {
+            if (!runRound(manager, fds[1], requests, response_bytes)) {
+                std::exit(1);
+            }
+        }
+        const double elapsed = nowSeconds() - start;
+
+        close(fds[1]);
+        manager.executeReadyTasks(0);
+        return static_cast<double>(rounds) * depth / elapsed;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const unsigned int depth = argc > 1 ? std::strtoul(argv[1], NULL, 10) : kDefaultDepth;
+    const unsigned int rounds = argc > 2 ? std::strtoul(argv[2], NULL, 10) : kDefaultRounds;
+    if (depth == 0 || rounds == 0) {
+        std::cerr << "usage: " << argv[0] << " [depth] [rounds]" << std::endl;
+        return 1;
+    }
+    std::cout << "pipeline_depth 1:  " << static_cast<unsigned long>(measure(1, depth, rounds)) << " requests/s" << std::endl;
+    std::cout << "pipeline_depth " << depth << ": " << static_cast<unsigned long>(measure(depth, depth, rounds)) << " requests/s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,192 @@
+// Measures parsing the request-line and header fields of the request fixtures in data/
+// Each fixture is split into lines beforehand, as ReadRequest hands the lines to the parser one by one
+// Usage: request_parser_bench [fixture...] (defaults to the files in data/, run from the repository root)
+#include "http/method.hpp"
+#include "http/request_parser.hpp"
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <time.h>
+#include <vector>
+
+namespace {
+    const char *const kDefaultFixtures[] = {"data/simple_request", "data/simple_post_request"};
+    const std::size_t kDefaultFixtureCount = sizeof(kDefaultFixtures) / sizeof(kDefaultFixtures[0]);
+    const unsigned int kRepeat = 500000;
+
+    // 変更前の RequestParser. 区切りを探してから substr で切り出し, 1 文字ずつ <cctype> で検証する
+    bool legacyIsValidFieldName(const StringView &field_name) {
+        if (field_name.empty()) {
+            return false;
+        }
+        for (size_t i = 0; i < field_name.size(); i++) {
+            unsigned char c = field_name[i];
+            if (!(std::isalnum(c) || c == '!' || c == '#' || c == '$' || c == '%' || c == '&' || c == '\'' || c == '*' || c == '+' || c == '-' || c == '.' || c == '^' || c == '_' || c == '`' || c == '|' || c == '~')) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool legacyIsValidFieldValue(const StringView &field_value) {
+        for (size_t i = 0; i < field_value.size(); i++) {
+            unsigned char c = field_value[i];
+            if (!std::isprint(c) && c < 0x80) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool legacyParseHeaderFieldLine(const StringView &line, RequestParser::HeaderField &field) {
+        const std::size_t colon_pos = line.find(':');
+        if (colon_pos == StringView::npos) {
+            return false;
+        }
+        const StringView raw_field_name = line.substr(0, colon_pos);
+        const StringView raw_field_value = line.substr(colon_pos + 1);
+        if (!legacyIsValidFieldName(raw_field_name)) {
+            return false;
+        }
+        const std::size_t begin = raw_field_value.findFirstNotOf(" \t");
+        const std::size_t end = raw_field_value.findLastNotOf(" \t");
+        if (begin == StringView::npos || end == StringView::npos) {
+            return false;
+        }
+        const StringView value = raw_field_value.substr(begin, end - begin + 1);
+        if (!legacyIsValidFieldValue(value)) {
+            return false;
+        }
+        field = std::make_pair(raw_field_name.toString(), value.toString());
+        return true;
+    }
+
+    bool legacyParseRequestLine(const StringView &line, RequestParser::RequestLine &request_line) {
+        const std::size_t first_space_pos = line.find(' ');
+        const std::size_t last_space_pos = line.rfind(' ');
+        if (first_space_pos == StringView::npos || first_space_pos == last_space_pos) {
+            return false;
+        }
+        const HttpMethod method = httpMethodFromString(line.substr(0, first_space_pos));
+        const StringView version = line.substr(last_space_pos + 1);
+        if (method == kMethodUnknown || version.size() != 8 || !version.startsWith("HTTP/")) {
+            return false;
+        }
+        request_line = std::make_pair(std::make_pair(method, line.substr(first_space_pos + 1, last_space_pos - first_space_pos - 1).toString()), version.toString());
+        return true;
+    }
+
+    // 最適化で消されないよう, 取り出したフィールドの長さの合計を返す
+    std::size_t runLegacy(const std::vector<StringView> &lines) {
+        std::size_t total = 0;
+        RequestParser::RequestLine request_line;
+        if (legacyParseRequestLine(lines[0], request_line)) {
+            total += request_line.first.second.size();
+        }
+        for (std::size_t i = 1; i < lines.size(); i++) {
+            RequestParser::HeaderField field;
+            if (legacyParseHeaderFieldLine(lines[i], field)) {
+                total += field.first.size() + field.second.size();
+            }
+        }
+        return total;
+    }
+
+    std::size_t runParse(const std::vector<StringView> &lines) {
+        std::size_t total = 0;
+        const Result<RequestParser::RequestLine, std::string> request_line = RequestParser::parseRequestLine(lines[0]);
+        if (request_line.isOk()) {
+            total += request_line.unwrap().first.second.size();
+        }
+        for (std::size_t i = 1; i < lines.size(); i++) {
+            const Result<RequestParser::HeaderField, std::string> field = RequestParser::parseHeaderFieldLine(lines[i]);
+            if (field.isOk()) {
+                total += field.unwrap().first.size() + field.unwrap().second.size();
+            }
+        }
+        return total;
+    }
+
+    std::size_t runScan(const std::vector<StringView> &lines) {
+        std::size_t total = 0;
+        const Result<RequestParser::RequestLineView, std::string> request_line = RequestParser::scanRequestLine(lines[0]);
+        if (request_line.isOk()) {
+            total += request_line.unwrap().request_target.size();
+        }
+        for (std::size_t i = 1; i < lines.size(); i++) {
+            const Result<RequestParser::HeaderFieldView, std::string> field = RequestParser::scanHeaderFieldLine(lines[i]);
+            if (field.isOk()) {
+                total += field.unwrap().name.size() + field.unwrap().value.size();
+            }
+        }
+        return total;
+    }
+
+    double nowSeconds() {
+        struct timespec ts = {};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+    }
+
+    void run(const char *name, std::size_t (*parse)(const std::vector<StringView> &), const std::vector<StringView> &lines, std::size_t bytes) {
+        std::size_t total = 0;
+        const double start = nowSeconds();
+        for (unsigned int i = 0; i < kRepeat; i++) {
+            total += parse(lines);
+        }
+        const double elapsed = nowSeconds() - start;
+        std::printf("  %-7s %8.1f MB/s %6.0f ns/request (%zu bytes of fields)\n",
+                    name, static_cast<double>(bytes) * kRepeat / elapsed / 1e6, elapsed / kRepeat * 1e9, total / kRepeat);
+    }
+
+    // header section の行を CRLF を除いて切り出す. message-body と区切りの空行は含めない
+    std::vector<StringView> splitHeaderLines(const std::string &data, std::size_t &header_bytes) {
+        std::vector<StringView> lines;
+        std::size_t pos = 0;
+        while (true) {
+            const std::size_t end = data.find("\r\n", pos);
+            if (end == std::string::npos || end == pos) {
+                header_bytes = pos;
+                return lines;
+            }
+            lines.push_back(StringView(data.data() + pos, end - pos));
+            pos = end + 2;
+        }
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<std::string> fixtures;
+    for (int i = 1; i < argc; i++) {
+        fixtures.push_back(argv[i]);
+    }
+    if (fixtures.empty()) {
+        fixtures.assign(kDefaultFixtures, kDefaultFixtures + kDefaultFixtureCount);
+    }
+
+    for (std::size_t i = 0; i < fixtures.size(); i++) {
+        std::ifstream file(fixtures[i].c_str(), std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: Failed to open " << fixtures[i] << std::endl;
+            return 1;
+        }
+        std::stringstream ss;
+        ss << file.rdbuf();
+        const std::string data = ss.str();
+        std::size_t header_bytes = 0;
+        const std::vector<StringView> lines = splitHeaderLines(data, header_bytes);
+        if (lines.empty()) {
+            std::cerr << "Error: No request-line in " << fixtures[i] << std::endl;
+            return 1;
+        }
+
+        std::printf("%s (%zu lines, %zu bytes)\n", fixtures[i].c_str(), lines.size(), header_bytes);
+        run("legacy", runLegacy, lines, header_bytes);
+        run("parse", runParse, lines, header_bytes);
+        run("scan", runScan, lines, header_bytes);
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Measures building the head of a response and handing it to the queue of the connection
+// Compares the earlier ways of formatting the head with ResponseWriter, which copies precomputed fragments
+// All variants write the same head including the Date header, so the cost of formatting the date is included
+// Usage: response_head_bench [repeat]
+#include "http/response_writer.hpp"
+#include "http/status.hpp"
+#include "task/io_task_manager.hpp"
+#include "task/response_queue.hpp"
+#include "utils/utils.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <time.h>
+
+namespace {
+    const unsigned int kDefaultRepeat = 2000000;
+    const HttpStatusCode kStatuses[] = {kStatusOk, kStatusNotFound, kStatusMovedPermanently, kStatusOk};
+    const std::size_t kStatusCount = sizeof(kStatuses) / sizeof(kStatuses[0]);
+    const char kHeader[] = "Content-Type: text/plain\r\n";
+    const char kBody[] = "hello, world";
+
+    double nowSeconds() {
+        struct timespec ts = {};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+    }
+
+    // 変更前は Date を送っていなかったので, 素朴に毎回 strftime で作ったものを足して比べる
+    std::string legacyDate() {
+        const std::time_t now = std::time(NULL);
+        struct tm tm = {};
+        gmtime_r(&now, &tm);
+        char buf[64];
+        const std::size_t size = std::strftime(buf, sizeof(buf), "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &tm);
+        return std::string(buf, size);
+    }
+
+    // 最初の実装. 数値は文字列ストリームで, 各部分は std::string の連結で作る
+    std::size_t runConcat(ResponseQueue &queue, unsigned int repeat) {
+        std::size_t total = 0;
+        std::string body;
+        for (unsigned int i = 0; i < repeat; i++) {
+            const HttpStatusCode status = kStatuses[i % kStatusCount];
+            body = kBody;
+            const std::string head = std::string("HTTP/1.1") + " " + utils::toString(static_cast<int>(status)) + " " + getHttpStatusText(status) + "\r\n" +
+                                     legacyDate() +
+                                     "Content-Length: " + utils::toString(body.size()) + "\r\n" +
+                                     kHeader + "\r\n";
+            total += head.size();
+            queue.push(head, body);
+            queue.clear();
+        }
+        return total;
+    }
+
+    // 直前の実装. sprintf で 1 つの領域に書くが, 理由句は毎回 std::string で引く
+    std::size_t runSprintf(ResponseQueue &queue, unsigned int repeat) {
+        std::size_t total = 0;
+        std::string body;
+        std::string header;
+        char head[256];
+        for (unsigned int i = 0; i < repeat; i++) {
+            const HttpStatusCode status = kStatuses[i % kStatusCount];
+            body = kBody;
+            header = kHeader;
+            const std::string status_text = getHttpStatusText(status);
+            const std::string date = legacyDate();
+            const int size = std::sprintf(head, "%s %d %s\r\n%sContent-Length: %lu\r\n%s\r\n",
+                                          "HTTP/1.1", static_cast<int>(status), status_text.c_str(), date.c_str(),
+                                          static_cast<unsigned long>(body.size()), header.c_str());
+            total += size;
+            queue.push(StringView(head, size), body);
+            queue.clear();
+        }
+        return total;
+    }
+
+    std::size_t runWriter(IOTaskManager &manager, ResponseQueue &queue, unsigned int repeat) {
+        ResponseWriter<ResponseQueue &> writer(manager, queue, NULL);
+        for (unsigned int i = 0; i < repeat; i++) {
+            writer.setStatus(kStatuses[i % kStatusCount]);
+            writer.addHeader("Content-Type", "text/plain");
+            writer.addBody(kBody);
+            writer.send();
+            writer.reset();
+            queue.clear();
+        }
+        return 0;
+    }
+
+    void report(const char *name, double elapsed, unsigned int repeat) {
+        std::printf("  %-7s %8.1f ns/response %8.2f M responses/s\n", name, elapsed / repeat * 1e9, repeat / elapsed / 1e6);
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    const unsigned int repeat = argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1])) : kDefaultRepeat;
+    if (repeat == 0) {
+        std::fprintf(stderr, "Usage: %s [repeat]\n", argv[0]);
+        return 1;
+    }
+    IOTaskManager manager;
+    ResponseQueue queue(manager, -1, NULL);
+    std::size_t total = 0;
+
+    std::printf("%u responses (%zu statuses, %zu-byte body)\n", repeat, kStatusCount, sizeof(kBody) - 1);
+    double start = nowSeconds();
+    total += runConcat(queue, repeat);
+    report("concat", nowSeconds() - start, repeat);
+
+    start = nowSeconds();
+    total += runSprintf(queue, repeat);
+    report("sprintf", nowSeconds() - start, repeat);
+
+    start = nowSeconds();
+    total += runWriter(manager, queue, repeat);
+    report("writer", nowSeconds() - start, repeat);
+
+    // 最適化で消されないよう, 作ったヘッダーの長さを使う
+    return total == 0 ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+// Measures the delimiter search of BufferedReader on the request fixtures in data/
+// Every implementation splits each fixture into LF-terminated lines, as CrlfLineReader asks BufferedReader to
+// Usage: search_bench [fixture...] (defaults to the files in data/, run from the repository root)
+#include "utils/byte_search.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <time.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+    const char *const kDefaultFixtures[] = {"data/simple_request", "data/simple_post_request"};
+    const std::size_t kDefaultFixtureCount = sizeof(kDefaultFixtures) / sizeof(kDefaultFixtures[0]);
+    const unsigned int kRepeat = 200000;
+
+    typedef const char *(*SearchFunction)(const char *haystack, std::size_t len, const char *needle, std::size_t needle_len);
+
+    // 変更前の utils::strnstr. 残りのバッファ全体を std::string にコピーしてから find する
+    const char *legacySearch(const char *haystack, std::size_t len, const char *needle, std::size_t needle_len) {
+        const std::string haystack_str(haystack, len);
+        const std::size_t pos = haystack_str.find(std::string(needle, needle_len));
+        return pos == std::string::npos ? NULL : haystack + pos;
+    }
+
+    // x86 ではサイクル, それ以外ではナノ秒
+    unsigned long long now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        struct timespec ts = {};
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+    }
+
+    // 行の数を返し, 最適化で消されないようにする
+    std::size_t splitLines(SearchFunction search, const std::string &data) {
+        std::size_t lines = 0;
+        const char *pos = data.data();
+        const char *end = data.data() + data.size();
+        while (pos < end) {
+            const char *found = search(pos, end - pos, "\n", 1);
+            if (found == NULL) {
+                break;
+            }
+            pos = found + 1;
+            lines++;
+        }
+        return lines;
+    }
+
+    void run(const char *name, SearchFunction search, const std::string &data) {
+        std::size_t lines = 0;
+        const unsigned long long start = now();
+        for (unsigned int i = 0; i < kRepeat; i++) {
+            lines += splitLines(search, data);
+        }
+        const unsigned long long elapsed = now() - start;
+        const double bytes = static_cast<double>(data.size()) * kRepeat;
+#if defined(__x86_64__) || defined(__i386__)
+        std::printf("  %-8s %8.3f bytes/cycle (%zu lines)\n", name, bytes / elapsed, lines / kRepeat);
+#else
+        std::printf("  %-8s %8.3f bytes/ns (%zu lines)\n", name, bytes / elapsed, lines / kRepeat);
+#endif
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<std::string> fixtures;
+    for (int i = 1; i < argc; i++) {
+        fixtures.push_back(argv[i]);
+    }
+    if (fixtures.empty()) {
+        fixtures.assign(kDefaultFixtures, kDefaultFixtures + kDefaultFixtureCount);
+    }
+
+    for (std::size_t i = 0; i < fixtures.size(); i++) {
+        std::ifstream file(fixtures[i].c_str(), std::ios::binary);
+        if (!file) {
+            std::cerr << "Error: Failed to open " << fixtures[i] << std::endl;
+            return 1;
+        }
+        std::stringstream ss;
+        ss << file.rdbuf();
+        const std::string data = ss.str();
+
+        std::printf("%s (%zu bytes)\n", fixtures[i].c_str(), data.size());
+        run("legacy", legacySearch, data);
+        run("search", utils::searchBytes, data);
+    }
+    return 0;
+}
@@ -16,7 +16,11 @@ int main(int argc, char **argv) {
     Config config = parse_result.unwrap();
     Server server;
 
-    Server::start();
+    const Result<types::Unit, std::string> start_result = Server::start(config);
+    if (start_result.isErr()) {
+        std::cerr << start_result.unwrapErr();
+        return 1;
+    }
 
     return 0;
 }
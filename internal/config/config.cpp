@@ -2,14 +2,42 @@
 #include "utils/result.hpp"
 
 const std::string Config::kDefaultPath = "conf/default.conf";
+const std::string Config::kDefaultClientBodyTempPath = "/tmp";
 
-Config::Config() : client_max_body_size_(kDefaultClientMaxBodySize) {}
+Config::Config()
+    : client_max_body_size_(kDefaultClientMaxBodySize),
+      keepalive_timeout_(kDefaultKeepaliveTimeout),
+      keepalive_requests_(kDefaultKeepaliveRequests),
+      client_header_timeout_(kDefaultClientHeaderTimeout),
+      client_body_timeout_(kDefaultClientBodyTimeout),
+      send_timeout_(kDefaultSendTimeout),
+      worker_threads_(kDefaultWorkerThreads),
+      worker_processes_(kDefaultWorkerProcesses),
+      accept_budget_(kDefaultAcceptBudget),
+      client_header_buffer_size_(kDefaultClientHeaderBufferSize),
+      large_client_header_buffer_size_(kDefaultLargeClientHeaderBufferSize),
+      client_body_buffer_size_(kDefaultClientBodyBufferSize),
+      client_body_temp_path_(kDefaultClientBodyTempPath),
+      pipeline_depth_(kDefaultPipelineDepth) {}
 
 Config::Config(
         const std::vector<VirtualServerConfig> &virtual_servers,
         const std::map<HttpStatusCode, std::string> &error_pages,
         unsigned int client_max_body_size)
     : client_max_body_size_(client_max_body_size),
+      keepalive_timeout_(kDefaultKeepaliveTimeout),
+      keepalive_requests_(kDefaultKeepaliveRequests),
+      client_header_timeout_(kDefaultClientHeaderTimeout),
+      client_body_timeout_(kDefaultClientBodyTimeout),
+      send_timeout_(kDefaultSendTimeout),
+      worker_threads_(kDefaultWorkerThreads),
+      worker_processes_(kDefaultWorkerProcesses),
+      accept_budget_(kDefaultAcceptBudget),
+      client_header_buffer_size_(kDefaultClientHeaderBufferSize),
+      large_client_header_buffer_size_(kDefaultLargeClientHeaderBufferSize),
+      client_body_buffer_size_(kDefaultClientBodyBufferSize),
+      client_body_temp_path_(kDefaultClientBodyTempPath),
+      pipeline_depth_(kDefaultPipelineDepth),
       virtual_servers_(virtual_servers),
       error_pages_(error_pages) {}
 
@@ -17,12 +45,38 @@ Config::~Config() {}
 
 Config::Config(const Config &other)
     : client_max_body_size_(other.client_max_body_size_),
+      keepalive_timeout_(other.keepalive_timeout_),
+      keepalive_requests_(other.keepalive_requests_),
+      client_header_timeout_(other.client_header_timeout_),
+      client_body_timeout_(other.client_body_timeout_),
+      send_timeout_(other.send_timeout_),
+      worker_threads_(other.worker_threads_),
+      worker_processes_(other.worker_processes_),
+      accept_budget_(other.accept_budget_),
+      client_header_buffer_size_(other.client_header_buffer_size_),
+      large_client_header_buffer_size_(other.large_client_header_buffer_size_),
+      client_body_buffer_size_(other.client_body_buffer_size_),
+      client_body_temp_path_(other.client_body_temp_path_),
+      pipeline_depth_(other.pipeline_depth_),
       virtual_servers_(other.virtual_servers_),
       error_pages_(other.error_pages_) {}
 
 Config &Config::operator=(const Config &other) {
     if (this != &other) {
         client_max_body_size_ = other.client_max_body_size_;
+        keepalive_timeout_ = other.keepalive_timeout_;
+        keepalive_requests_ = other.keepalive_requests_;
+        client_header_timeout_ = other.client_header_timeout_;
+        client_body_timeout_ = other.client_body_timeout_;
+        send_timeout_ = other.send_timeout_;
+        worker_threads_ = other.worker_threads_;
+        worker_processes_ = other.worker_processes_;
+        accept_budget_ = other.accept_budget_;
+        client_header_buffer_size_ = other.client_header_buffer_size_;
+        large_client_header_buffer_size_ = other.large_client_header_buffer_size_;
+        client_body_buffer_size_ = other.client_body_buffer_size_;
+        client_body_temp_path_ = other.client_body_temp_path_;
+        pipeline_depth_ = other.pipeline_depth_;
         virtual_servers_ = other.virtual_servers_;
         error_pages_ = other.error_pages_;
     }
@@ -50,6 +104,58 @@ unsigned int Config::getClientMaxBodySize() const {
     return client_max_body_size_;
 }
 
+unsigned int Config::getKeepaliveTimeout() const {
+    return keepalive_timeout_;
+}
+
+unsigned int Config::getKeepaliveRequests() const {
+    return keepalive_requests_;
+}
+
+unsigned int Config::getClientHeaderTimeout() const {
+    return client_header_timeout_;
+}
+
+unsigned int Config::getClientBodyTimeout() const {
+    return client_body_timeout_;
+}
+
+unsigned int Config::getSendTimeout() const {
+    return send_timeout_;
+}
+
+unsigned int Config::getWorkerThreads() const {
+    return worker_threads_;
+}
+
+unsigned int Config::getWorkerProcesses() const {
+    return worker_processes_;
+}
+
+unsigned int Config::getAcceptBudget() const {
+    return accept_budget_;
+}
+
+unsigned int Config::getClientHeaderBufferSize() const {
+    return client_header_buffer_size_;
+}
+
+unsigned int Config::getLargeClientHeaderBufferSize() const {
+    return large_client_header_buffer_size_;
+}
+
+unsigned int Config::getClientBodyBufferSize() const {
+    return client_body_buffer_size_;
+}
+
+const std::string &Config::getClientBodyTempPath() const {
+    return client_body_temp_path_;
+}
+
+unsigned int Config::getPipelineDepth() const {
+    return pipeline_depth_;
+}
+
 const std::vector<VirtualServerConfig> &Config::getVirtualServers() const {
     return virtual_servers_;
 }
@@ -62,3 +168,80 @@ const std::string &Config::getErrorPage(HttpStatusCode code) {
     setDefaultErrorPage(code);
     return error_pages_.at(code);
 }
+
+const VirtualServerConfig *Config::findVirtualServer(const StringView &host) const {
+    if (virtual_servers_.empty()) {
+        return NULL;
+    }
+    for (std::size_t i = 0; i < virtual_servers_.size(); i++) {
+        if (virtual_servers_[i].isNamed(host)) {
+            return &virtual_servers_[i];
+        }
+    }
+    return &virtual_servers_[0];
+}
+
+unsigned int Config::resolveClientMaxBodySize(const StringView &host, const StringView &path) const {
+    const VirtualServerConfig *server = findVirtualServer(host);
+    if (server == NULL) {
+        return client_max_body_size_;
+    }
+    const RouteConfig *route = server->findRoute(path);
+    if (route != NULL && route->getClientMaxBodySize().isSome()) {
+        return route->getClientMaxBodySize().unwrap();
+    }
+    return server->getClientMaxBodySize().unwrapOr(client_max_body_size_);
+}
+
+/* setters */
+void Config::setKeepaliveTimeout(unsigned int keepalive_timeout) {
+    keepalive_timeout_ = keepalive_timeout;
+}
+
+void Config::setKeepaliveRequests(unsigned int keepalive_requests) {
+    keepalive_requests_ = keepalive_requests;
+}
+
+void Config::setClientHeaderTimeout(unsigned int client_header_timeout) {
+    client_header_timeout_ = client_header_timeout;
+}
+
+void Config::setClientBodyTimeout(unsigned int client_body_timeout) {
+    client_body_timeout_ = client_body_timeout;
+}
+
+void Config::setSendTimeout(unsigned int send_timeout) {
+    send_timeout_ = send_timeout;
+}
+
+void Config::setWorkerThreads(unsigned int worker_threads) {
+    worker_threads_ = worker_threads;
+}
+
+void Config::setWorkerProcesses(unsigned int worker_processes) {
+    worker_processes_ = worker_processes;
+}
+
+void Config::setAcceptBudget(unsigned int accept_budget) {
+    accept_budget_ = accept_budget;
+}
+
+void Config::setClientHeaderBufferSize(unsigned int client_header_buffer_size) {
+    client_header_buffer_size_ = client_header_buffer_size;
+}
+
+void Config::setLargeClientHeaderBufferSize(unsigned int large_client_header_buffer_size) {
+    large_client_header_buffer_size_ = large_client_header_buffer_size;
+}
+
+void Config::setClientBodyBufferSize(unsigned int client_body_buffer_size) {
+    client_body_buffer_size_ = client_body_buffer_size;
+}
+
+void Config::setClientBodyTempPath(const std::string &client_body_temp_path) {
+    client_body_temp_path_ = client_body_temp_path;
+}
+
+void Config::setPipelineDepth(unsigned int pipeline_depth) {
+    pipeline_depth_ = pipeline_depth;
+}
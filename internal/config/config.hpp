@@ -3,6 +3,7 @@
 
 #include "http/status.hpp"
 #include "utils/result.hpp"
+#include "utils/string_view.hpp"
 #include "utils/utils.hpp"
 #include "virtual_server_config.hpp"
 #include <map>
@@ -20,7 +21,40 @@ public:
     Config &operator=(const Config &other);
 
     unsigned int getClientMaxBodySize() const;
+    unsigned int getKeepaliveTimeout() const;
+    unsigned int getKeepaliveRequests() const;
+    unsigned int getClientHeaderTimeout() const;
+    unsigned int getClientBodyTimeout() const;
+    unsigned int getSendTimeout() const;
+    unsigned int getWorkerThreads() const;
+    unsigned int getWorkerProcesses() const;
+    unsigned int getAcceptBudget() const;
+    unsigned int getClientHeaderBufferSize() const;
+    unsigned int getLargeClientHeaderBufferSize() const;
+    unsigned int getClientBodyBufferSize() const;
+    const std::string &getClientBodyTempPath() const;
+    unsigned int getPipelineDepth() const;
+    // The tuning knobs below start with their defaults and are set one by one
+    void setKeepaliveTimeout(unsigned int keepalive_timeout);
+    void setKeepaliveRequests(unsigned int keepalive_requests);
+    void setClientHeaderTimeout(unsigned int client_header_timeout);
+    void setClientBodyTimeout(unsigned int client_body_timeout);
+    void setSendTimeout(unsigned int send_timeout);
+    void setWorkerThreads(unsigned int worker_threads);
+    void setWorkerProcesses(unsigned int worker_processes);
+    void setAcceptBudget(unsigned int accept_budget);
+    void setClientHeaderBufferSize(unsigned int client_header_buffer_size);
+    void setLargeClientHeaderBufferSize(unsigned int large_client_header_buffer_size);
+    void setClientBodyBufferSize(unsigned int client_body_buffer_size);
+    void setClientBodyTempPath(const std::string &client_body_temp_path);
+    void setPipelineDepth(unsigned int pipeline_depth);
     const std::vector<VirtualServerConfig> &getVirtualServers() const;
+    // The virtual server named host, or the first one (the default server) if none is
+    // NULL if there is no virtual server
+    const VirtualServerConfig *findVirtualServer(const StringView &host) const;
+    // client_max_body_size of a request for path on host, 0 for no limit
+    // A route inherits the value of its virtual server, which inherits the global one
+    unsigned int resolveClientMaxBodySize(const StringView &host, const StringView &path) const;
     // There should be no need for the map itself, so no getter has been provided
     const std::string &getErrorPage(HttpStatusCode status_code);
     static Result<Config, std::string> parseConfigFile(const std::string &path);
@@ -31,9 +65,60 @@ private:
     // Same as nginx default
     // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#client_max_body_size
     static const unsigned int kDefaultClientMaxBodySize = utils::kMiB;
+    // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#keepalive_timeout
+    static const unsigned int kDefaultKeepaliveTimeout = 75;
+    // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#keepalive_requests
+    static const unsigned int kDefaultKeepaliveRequests = 1000;
+    // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#client_header_timeout
+    static const unsigned int kDefaultClientHeaderTimeout = 60;
+    // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#client_body_timeout
+    static const unsigned int kDefaultClientBodyTimeout = 60;
+    // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#send_timeout
+    static const unsigned int kDefaultSendTimeout = 60;
+    static const unsigned int kDefaultWorkerThreads = 1;
+    static const unsigned int kDefaultWorkerProcesses = 0;
+    static const unsigned int kDefaultAcceptBudget = 64;
+    static const unsigned int kDefaultClientHeaderBufferSize = 4 * utils::kKiB;
+    static const unsigned int kDefaultLargeClientHeaderBufferSize = 32 * utils::kKiB;
+    // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#client_body_buffer_size
+    static const unsigned int kDefaultClientBodyBufferSize = 16 * utils::kKiB;
+    static const std::string kDefaultClientBodyTempPath;
+    static const unsigned int kDefaultPipelineDepth = 16;
 
-    // Max body size of client request (bytes)
+    // Max body size of client request (bytes), 0 disables the limit
     unsigned int client_max_body_size_;
+    // Seconds an idle keep-alive connection stays open, 0 disables keep-alive
+    unsigned int keepalive_timeout_;
+    // Max number of requests served through one keep-alive connection
+    unsigned int keepalive_requests_;
+    // Seconds to receive the request-line and header section, 0 disables
+    unsigned int client_header_timeout_;
+    // Seconds allowed between two successive reads of the request body, 0 disables
+    unsigned int client_body_timeout_;
+    // Seconds allowed between two successive writes of the response, 0 disables
+    unsigned int send_timeout_;
+    // Number of threads running their own event loop, each accepting on its own listening socket
+    unsigned int worker_threads_;
+    // Number of worker processes forked by a master process that restarts them when they die
+    // 0 runs the workers in the server process without a master
+    unsigned int worker_processes_;
+    // Max number of connections accepted each time a listening socket becomes readable
+    // Bounds the time an event loop spends accepting while its connections wait
+    unsigned int accept_budget_;
+    // Initial size of the read buffer of a connection (bytes)
+    unsigned int client_header_buffer_size_;
+    // Size the read buffer may grow to for a long request-line or header field (bytes)
+    // Similar to large_client_header_buffers directive in nginx, but one buffer is grown instead
+    // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#large_client_header_buffers
+    unsigned int large_client_header_buffer_size_;
+    // Max bytes of a request body kept in memory. Larger bodies are written to a temporary file
+    unsigned int client_body_buffer_size_;
+    // Directory of the temporary files holding request bodies
+    // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#client_body_temp_path
+    std::string client_body_temp_path_;
+    // Max number of responses of a connection waiting to be written
+    // Pipelined requests are read ahead until this many responses are queued, 1 disables pipelining
+    unsigned int pipeline_depth_;
     // Config consists of virtual server configs
     std::vector<VirtualServerConfig> virtual_servers_;
     // Similar to error_page directive in nginx
@@ -1,6 +1,6 @@
 #include "route_config.hpp"
 
-RouteConfig::RouteConfig() : autoindex_enabled_() {}
+RouteConfig::RouteConfig() : autoindex_enabled_(), client_max_body_size_(None) {}
 
 RouteConfig::RouteConfig(
         const std::string &route_path,
@@ -11,7 +11,8 @@ RouteConfig::RouteConfig(
         bool autoindex_enabled,
         const std::string &index_file_name,
         const std::vector<std::string> &cgi_extensions,
-        const std::map<std::string, std::string> &response_headers)
+        const std::map<std::string, std::string> &response_headers,
+        const Option<unsigned int> &client_max_body_size)
     : route_path_(route_path),
       allowed_methods_(allowed_methods),
       upload_path_(upload_path),
@@ -20,7 +21,8 @@ RouteConfig::RouteConfig(
       index_file_name_(index_file_name),
       redirect_path_(redirect_path),
       cgi_extensions_(cgi_extensions),
-      response_headers_(response_headers) {}
+      response_headers_(response_headers),
+      client_max_body_size_(client_max_body_size) {}
 
 RouteConfig::~RouteConfig() {}
 
@@ -33,7 +35,8 @@ RouteConfig::RouteConfig(const RouteConfig &other)
       index_file_name_(other.index_file_name_),
       redirect_path_(other.redirect_path_),
       cgi_extensions_(other.cgi_extensions_),
-      response_headers_(other.response_headers_) {}
+      response_headers_(other.response_headers_),
+      client_max_body_size_(other.client_max_body_size_) {}
 
 RouteConfig &RouteConfig::operator=(const RouteConfig &other) {
     if (this != &other) {
@@ -46,6 +49,7 @@ RouteConfig &RouteConfig::operator=(const RouteConfig &other) {
         redirect_path_ = other.redirect_path_;
         cgi_extensions_ = other.cgi_extensions_;
         response_headers_ = other.response_headers_;
+        client_max_body_size_ = other.client_max_body_size_;
     }
     return *this;
 }
@@ -91,3 +95,12 @@ const std::vector<std::string> &RouteConfig::getCgiExtensions() const {
 const std::map<std::string, std::string> &RouteConfig::getResponseHeaders() const {
     return response_headers_;
 }
+
+const Option<unsigned int> &RouteConfig::getClientMaxBodySize() const {
+    return client_max_body_size_;
+}
+
+// nginx の prefix location と同じく, 単純な前方一致
+bool RouteConfig::matches(const StringView &path) const {
+    return path.startsWith(route_path_);
+}
@@ -2,6 +2,8 @@
 #define INTERNAL_CONFIG_ROUTE_CONFIG_HPP
 
 #include "http/method.hpp"
+#include "utils/option.hpp"
+#include "utils/string_view.hpp"
 #include <map>
 #include <string>
 #include <vector>
@@ -18,7 +20,8 @@ public:
             bool autoindex_enabled = false,
             const std::string &index_file_name = "index.html",
             const std::vector<std::string> &cgi_extensions = std::vector<std::string>(),
-            const std::map<std::string, std::string> &response_headers = std::map<std::string, std::string>());
+            const std::map<std::string, std::string> &response_headers = std::map<std::string, std::string>(),
+            const Option<unsigned int> &client_max_body_size = None);
     ~RouteConfig();
     RouteConfig(const RouteConfig &other);
     RouteConfig &operator=(const RouteConfig &other);
@@ -32,6 +35,9 @@ public:
     const std::string &getRedirectPath() const;
     const std::vector<std::string> &getCgiExtensions() const;
     const std::map<std::string, std::string> &getResponseHeaders() const;
+    const Option<unsigned int> &getClientMaxBodySize() const;
+    // Whether the route applies to path. Like a prefix location in nginx
+    bool matches(const StringView &path) const;
 
     static RouteConfig parseRouteConfigString(const std::string &config_string);
 
@@ -59,6 +65,9 @@ private:
     std::vector<std::string> cgi_extensions_;
     // Server responds by appending these headers
     std::map<std::string, std::string> response_headers_;
+    // Max body size of client request (bytes), 0 disables the limit
+    // None inherits the value of the virtual server
+    Option<unsigned int> client_max_body_size_;
 };
 
 #endif //INTERNAL_CONFIG_ROUTE_CONFIG_HPP
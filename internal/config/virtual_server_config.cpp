@@ -1,17 +1,36 @@
 #include "virtual_server_config.hpp"
+#include <algorithm>
+#include <strings.h>
 
-VirtualServerConfig::VirtualServerConfig() {}
+VirtualServerConfig::VirtualServerConfig()
+    : backlog_(kDefaultBacklog), reuse_address_(true), defer_accept_(0), fastopen_(0), client_max_body_size_(None) {}
 
 VirtualServerConfig::VirtualServerConfig(
         const std::vector<RouteConfig> &routes,
         const std::string &host, const std::string &port,
         const std::vector<std::string> &server_names)
-    : host_(host), port_(port), server_names_(server_names), routes_(routes) {}
+    : host_(host),
+      port_(port),
+      server_names_(server_names),
+      routes_(routes),
+      backlog_(kDefaultBacklog),
+      reuse_address_(true),
+      defer_accept_(0),
+      fastopen_(0),
+      client_max_body_size_(None) {}
 
 VirtualServerConfig::~VirtualServerConfig() {}
 
 VirtualServerConfig::VirtualServerConfig(const VirtualServerConfig &other)
-    : host_(other.host_), port_(other.port_), server_names_(other.server_names_), routes_(other.routes_) {}
+    : host_(other.host_),
+      port_(other.port_),
+      server_names_(other.server_names_),
+      routes_(other.routes_),
+      backlog_(other.backlog_),
+      reuse_address_(other.reuse_address_),
+      defer_accept_(other.defer_accept_),
+      fastopen_(other.fastopen_),
+      client_max_body_size_(other.client_max_body_size_) {}
 
 VirtualServerConfig &VirtualServerConfig::operator=(const VirtualServerConfig &other) {
     if (this != &other) {
@@ -19,6 +38,11 @@ VirtualServerConfig &VirtualServerConfig::operator=(const VirtualServerConfig &o
         port_ = other.port_;
         server_names_ = other.server_names_;
         routes_ = other.routes_;
+        backlog_ = other.backlog_;
+        reuse_address_ = other.reuse_address_;
+        defer_accept_ = other.defer_accept_;
+        fastopen_ = other.fastopen_;
+        client_max_body_size_ = other.client_max_body_size_;
     }
     return *this;
 }
@@ -44,3 +68,68 @@ const std::vector<std::string> &VirtualServerConfig::getServerNames() const {
 const std::vector<RouteConfig> &VirtualServerConfig::getRoutes() const {
     return routes_;
 }
+
+int VirtualServerConfig::getBacklog() const {
+    return backlog_;
+}
+
+bool VirtualServerConfig::isReuseAddress() const {
+    return reuse_address_;
+}
+
+unsigned int VirtualServerConfig::getDeferAccept() const {
+    return defer_accept_;
+}
+
+int VirtualServerConfig::getFastopen() const {
+    return fastopen_;
+}
+
+const Option<unsigned int> &VirtualServerConfig::getClientMaxBodySize() const {
+    return client_max_body_size_;
+}
+
+// ホスト名は大文字小文字を区別しない
+// refs: https://datatracker.ietf.org/doc/html/rfc9110#section-4.2.3
+bool VirtualServerConfig::isNamed(const StringView &host) const {
+    const std::size_t name_size = std::min(host.find(':'), host.size());
+    for (std::size_t i = 0; i < server_names_.size(); i++) {
+        const std::string &name = server_names_[i];
+        if (name.size() == name_size && strncasecmp(name.c_str(), host.data(), name_size) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const RouteConfig *VirtualServerConfig::findRoute(const StringView &path) const {
+    const RouteConfig *found = NULL;
+    for (std::size_t i = 0; i < routes_.size(); i++) {
+        const RouteConfig &route = routes_[i];
+        if (route.matches(path) && (found == NULL || route.getRoutePath().size() > found->getRoutePath().size())) {
+            found = &route;
+        }
+    }
+    return found;
+}
+
+/* setters */
+void VirtualServerConfig::setBacklog(int backlog) {
+    backlog_ = backlog;
+}
+
+void VirtualServerConfig::setReuseAddress(bool reuse_address) {
+    reuse_address_ = reuse_address;
+}
+
+void VirtualServerConfig::setDeferAccept(unsigned int defer_accept) {
+    defer_accept_ = defer_accept;
+}
+
+void VirtualServerConfig::setFastopen(int fastopen) {
+    fastopen_ = fastopen;
+}
+
+void VirtualServerConfig::setClientMaxBodySize(const Option<unsigned int> &client_max_body_size) {
+    client_max_body_size_ = client_max_body_size;
+}
@@ -2,6 +2,8 @@
 #define INTERNAL_CONFIG_VIRTUAL_SERVER_CONFIG_HPP
 
 #include "route_config.hpp"
+#include "utils/option.hpp"
+#include "utils/string_view.hpp"
 #include <string>
 #include <vector>
 
@@ -20,10 +22,30 @@ public:
     const std::string &getPort() const;
     const std::vector<std::string> &getServerNames() const;
     const std::vector<RouteConfig> &getRoutes() const;
+    int getBacklog() const;
+    bool isReuseAddress() const;
+    unsigned int getDeferAccept() const;
+    int getFastopen() const;
+    const Option<unsigned int> &getClientMaxBodySize() const;
+    // Whether host (the Host header field, with or without the port) is one of the server names
+    bool isNamed(const StringView &host) const;
+    // The route with the longest path matching path, NULL if none matches
+    const RouteConfig *findRoute(const StringView &path) const;
+
+    // The listen options below start with their defaults and are set one by one
+    void setBacklog(int backlog);
+    void setReuseAddress(bool reuse_address);
+    void setDeferAccept(unsigned int defer_accept);
+    void setFastopen(int fastopen);
+    void setClientMaxBodySize(const Option<unsigned int> &client_max_body_size);
 
     static VirtualServerConfig parseVirtualServerConfigString(const std::string &config_string);
 
 private:
+    // Same as nginx default on Linux
+    // refs: https://nginx.org/en/docs/http/ngx_http_core_module.html#listen
+    static const int kDefaultBacklog = 511;
+
     // Listen host
     std::string host_;
     // Listen port
@@ -32,6 +54,19 @@ private:
     std::vector<std::string> server_names_;
     // VirtualServerConfig consists of route configs
     std::vector<RouteConfig> routes_;
+    // The following options apply to the listening socket of host:port
+    // When several virtual servers share host:port, the options of the first one are used
+    // Max length of the queue of pending connections, passed to listen(2)
+    int backlog_;
+    // SO_REUSEADDR, allows restarting while old connections are in TIME_WAIT
+    bool reuse_address_;
+    // Seconds to wait for the first data before accepting (TCP_DEFER_ACCEPT, Linux only), 0 disables
+    unsigned int defer_accept_;
+    // Max queue length of TCP Fast Open connections (TCP_FASTOPEN), 0 disables
+    int fastopen_;
+    // Max body size of client request (bytes), 0 disables the limit
+    // None inherits the value of Config. Each route may override it
+    Option<unsigned int> client_max_body_size_;
 };
 
 #endif //INTERNAL_CONFIG_VIRTUAL_SERVER_CONFIG_HPP
@@ -7,6 +7,12 @@ Result<types::Unit, std::string> Handler::trigger(IContext *ctx) {
     if (ctx == NULL) {
         return Ok(unit);
     }
-    ctx->text(kStatusOk, ctx->getRequest().body());
+    // 受け取った body をそのまま返す
+    const Result<std::string, std::string> body = ctx->getRequestBody().toString();
+    if (body.isErr()) {
+        ctx->text(kStatusInternalServerError, "");
+        return Err(body.unwrapErr());
+    }
+    ctx->text(kStatusOk, body.unwrap());
     return Ok(unit);
 }
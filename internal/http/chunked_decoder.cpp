@@ -0,0 +1,172 @@
+#include "chunked_decoder.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+    // chunk-data をリーダーから RequestBody に移すときの単位
+    const std::size_t kDataChunkSize = 8 * 1024;
+    // chunk-ext やトレーラーのフィールドは読み捨てるが, 1 行が無制限に溜まらないよう上限を設ける
+    const std::size_t kMaxLineSize = 8 * 1024;
+
+    int hexDigitValue(char c) {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+} // namespace
+
+ChunkedDecoder::ChunkedDecoder(std::size_t max_body_size)
+    : max_body_size_(max_body_size),
+      state_(kStateChunkSize),
+      line_reader_(kMaxLineSize),
+      chunk_bytes_left_(0),
+      body_size_(0),
+      too_large_(false) {}
+
+// chunked-body = *chunk last-chunk trailer-section CRLF
+Result<std::size_t, std::string> ChunkedDecoder::decode(IBufferedReader &reader, RequestBody &body) {
+    std::size_t consumed = 0;
+    while (state_ != kStateDone) {
+        bool progressed = false;
+        switch (state_) {
+            case kStateChunkSize: progressed = TRY(readChunkSize(reader, consumed)); break;
+            case kStateChunkData: progressed = TRY(readChunkData(reader, body, consumed)); break;
+            case kStateChunkDataEnd: progressed = TRY(readChunkDataEnd(reader, consumed)); break;
+            case kStateTrailer: progressed = TRY(readTrailer(reader, consumed)); break;
+            case kStateDone: break;
+        }
+        if (!progressed) {
+            break;
+        }
+    }
+    return Ok(consumed);
+}
+
+bool ChunkedDecoder::isDone() const {
+    return state_ == kStateDone;
+}
+
+std::size_t ChunkedDecoder::bodySize() const {
+    return body_size_;
+}
+
+bool ChunkedDecoder::isTooLarge() const {
+    return too_large_;
+}
+
+void ChunkedDecoder::reset(std::size_t max_body_size) {
+    max_body_size_ = max_body_size;
+    state_ = kStateChunkSize;
+    line_reader_.reset();
+    chunk_bytes_left_ = 0;
+    body_size_ = 0;
+    too_large_ = false;
+}
+
+// chunk-size [ chunk-ext ] CRLF
+// last-chunk = 1*("0") [ chunk-ext ] CRLF
+Result<bool, std::string> ChunkedDecoder::readChunkSize(IBufferedReader &reader, std::size_t &consumed) {
+    const Option<StringView> line = TRY(line_reader_.readLine(reader));
+    if (line.isNone()) {
+        return Ok(false);
+    }
+    consumed += line.unwrap().size() + 2;
+
+    const std::size_t chunk_size = TRY(parseChunkSize(line.unwrap()));
+    if (chunk_size == 0) {
+        state_ = kStateTrailer;
+        return Ok(true);
+    }
+    // 宣言された大きさの時点で拒否し, 上限を超える chunk-data は読まない
+    if (max_body_size_ > 0 && chunk_size > max_body_size_ - std::min(body_size_, max_body_size_)) {
+        too_large_ = true;
+        return Err<std::string>("request body is larger than client_max_body_size");
+    }
+    chunk_bytes_left_ = chunk_size;
+    state_ = kStateChunkData;
+    return Ok(true);
+}
+
+// chunk-data = 1*OCTET
+Result<bool, std::string> ChunkedDecoder::readChunkData(IBufferedReader &reader, RequestBody &body, std::size_t &consumed) {
+    char buf[kDataChunkSize];
+    while (chunk_bytes_left_ > 0) {
+        const std::size_t bytes_to_read = std::min(chunk_bytes_left_, sizeof(buf));
+        const std::size_t bytes_read = TRY(reader.read(buf, bytes_to_read));
+        TRY(body.append(buf, bytes_read));
+        chunk_bytes_left_ -= bytes_read;
+        body_size_ += bytes_read;
+        consumed += bytes_read;
+        // 要求より少なければ, 今読めるバイトは読み切った
+        if (bytes_read < bytes_to_read) {
+            break;
+        }
+    }
+    if (chunk_bytes_left_ > 0) {
+        return Ok(false);
+    }
+    state_ = kStateChunkDataEnd;
+    return Ok(true);
+}
+
+// chunk-data の後の CRLF
+Result<bool, std::string> ChunkedDecoder::readChunkDataEnd(IBufferedReader &reader, std::size_t &consumed) {
+    const Option<StringView> line = TRY(line_reader_.readLine(reader));
+    if (line.isNone()) {
+        return Ok(false);
+    }
+    if (!line.unwrap().empty()) {
+        return Err<std::string>("chunk-data is longer than chunk-size");
+    }
+    consumed += 2;
+    state_ = kStateChunkSize;
+    return Ok(true);
+}
+
+// trailer-section = *( field-line CRLF ) の後の CRLF
+// trailer のフィールドは使わないので読み捨てる
+Result<bool, std::string> ChunkedDecoder::readTrailer(IBufferedReader &reader, std::size_t &consumed) {
+    const Option<StringView> line = TRY(line_reader_.readLine(reader));
+    if (line.isNone()) {
+        return Ok(false);
+    }
+    consumed += line.unwrap().size() + 2;
+    if (line.unwrap().empty()) {
+        state_ = kStateDone;
+    }
+    return Ok(true);
+}
+
+// chunk-size = 1*HEXDIG
+// chunk-ext = *( BWS ";" BWS chunk-ext-name [ BWS "=" BWS chunk-ext-val ] )
+Result<std::size_t, std::string> ChunkedDecoder::parseChunkSize(const StringView &line) {
+    std::size_t chunk_size = 0;
+    std::size_t i = 0;
+    for (; i < line.size(); i++) {
+        const int digit = hexDigitValue(line[i]);
+        if (digit < 0) {
+            break;
+        }
+        if (chunk_size > (std::numeric_limits<std::size_t>::max() >> 4)) {
+            return Err<std::string>("chunk-size is too large");
+        }
+        chunk_size = (chunk_size << 4) | static_cast<std::size_t>(digit);
+    }
+    if (i == 0) {
+        return Err<std::string>("invalid chunk-size");
+    }
+    // chunk-ext は読み捨てる
+    const StringView rest = line.substr(i);
+    const std::size_t ext_pos = rest.findFirstNotOf(" \t");
+    if (ext_pos != StringView::npos && rest[ext_pos] != ';') {
+        return Err<std::string>("invalid chunk-ext");
+    }
+    return Ok(chunk_size);
+}
@@ -0,0 +1,56 @@
+#ifndef INTERNAL_HTTP_CHUNKED_DECODER_HPP
+#define INTERNAL_HTTP_CHUNKED_DECODER_HPP
+
+#include "io/line_reader.hpp"
+#include "io/reader.hpp"
+#include "request_body.hpp"
+#include "utils/result.hpp"
+#include <string>
+
+// Decodes a message-body with the chunked transfer coding incrementally from a non-blocking reader
+// Each call consumes the bytes available now and appends the chunk data to the body as it arrives,
+// so the body is never reassembled in memory
+// Chunk extensions and trailer fields are discarded, and a chunk-size or trailer line may not exceed 8 KiB
+// refs: https://datatracker.ietf.org/doc/html/rfc9112#section-7.1
+class ChunkedDecoder {
+public:
+    // The body may not exceed max_body_size bytes, 0 disables the limit
+    explicit ChunkedDecoder(std::size_t max_body_size = 0);
+    // Returns the number of bytes consumed from reader, which may be 0 if nothing is available now
+    // Fails if the body is malformed or larger than max_body_size
+    Result<std::size_t, std::string> decode(IBufferedReader &reader, RequestBody &body);
+    // Whether the last chunk and the trailer section have been read
+    bool isDone() const;
+    // Total bytes of chunk data decoded so far
+    std::size_t bodySize() const;
+    // Whether decode() failed because the body is larger than max_body_size
+    bool isTooLarge() const;
+    // Decode another body
+    void reset(std::size_t max_body_size);
+
+private:
+    enum State {
+        kStateChunkSize,
+        kStateChunkData,
+        kStateChunkDataEnd,
+        kStateTrailer,
+        kStateDone,
+    };
+
+    std::size_t max_body_size_;
+    State state_;
+    CrlfLineReader line_reader_;
+    // Bytes of the current chunk not decoded yet
+    std::size_t chunk_bytes_left_;
+    std::size_t body_size_;
+    bool too_large_;
+
+    // Each returns whether to go on to the next element, and adds the bytes consumed to consumed
+    Result<bool, std::string> readChunkSize(IBufferedReader &reader, std::size_t &consumed);
+    Result<bool, std::string> readChunkData(IBufferedReader &reader, RequestBody &body, std::size_t &consumed);
+    Result<bool, std::string> readChunkDataEnd(IBufferedReader &reader, std::size_t &consumed);
+    Result<bool, std::string> readTrailer(IBufferedReader &reader, std::size_t &consumed);
+    static Result<std::size_t, std::string> parseChunkSize(const StringView &line);
+};
+
+#endif //INTERNAL_HTTP_CHUNKED_DECODER_HPP
@@ -2,15 +2,20 @@
 
 IContext::~IContext() {}
 
-Context::Context(IOTaskManager &manager, int client_fd)
-    : manager_(manager), client_fd_(client_fd), writer_(manager, client_fd, new CloseConnectionCallback(this)) {}
+Context::Context(IOTaskManager &manager, int client_fd, IWriteFileCallback *cb)
+    : manager_(manager), client_fd_(client_fd), responses_(manager, client_fd, cb), writer_(manager, responses_, NULL, &arena_) {}
 
 const Request &Context::getRequest() const {
     return request_;
 }
 
-void Context::setRequest(const Request &request) {
-    request_ = request;
+// ReadRequest はリクエストをこのアリーナに組み立てるので, 入れ替えるだけでコピーしない
+void Context::setRequest(Request &request) {
+    request_.swap(request);
+}
+
+RequestBody &Context::getRequestBody() {
+    return request_body_;
 }
 
 void Context::setHeader(const std::string &name, const std::string &value) {
@@ -44,3 +49,35 @@ IOTaskManager &Context::getManager() const {
 int Context::getClientFd() const {
     return client_fd_;
 }
+
+// レスポンスはキューにコピー済みなので, アリーナをまとめて解放できる
+// リクエストはアリーナを指しているので, 代入で既定値をアリーナにコピーせず, 空のものと入れ替える
+void Context::reset() {
+    Request empty;
+    request_.swap(empty);
+    request_body_.clear();
+    writer_.reset();
+    arena_.reset();
+}
+
+Arena &Context::getArena() {
+    return arena_;
+}
+
+void Context::setClientFd(int client_fd) {
+    client_fd_ = client_fd;
+    responses_.setOutput(client_fd);
+}
+
+ResponseQueue &Context::getResponseQueue() {
+    return responses_;
+}
+
+void Context::setSendTimeout(unsigned int timeout_ms) {
+    responses_.setSendTimeout(timeout_ms);
+}
+
+void Context::setRequestBodyBuffer(std::size_t memory_limit, const std::string &temp_dir) {
+    request_body_.setMemoryLimit(memory_limit);
+    request_body_.setTempDir(temp_dir);
+}
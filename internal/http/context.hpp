@@ -6,24 +6,44 @@
 #include "response_writer.hpp"
 #include "status.hpp"
 #include "task/io_task_manager.hpp"
+#include "utils/arena.hpp"
 
 class Context : public IContext {
 public:
-    Context(IOTaskManager &manager, int client_fd);
+    // cb is borrowed and is called every time the queued responses have all been written
+    Context(IOTaskManager &manager, int client_fd, IWriteFileCallback *cb = NULL);
     virtual const Request &getRequest() const;
-    virtual void setRequest(const Request &request);
+    virtual void setRequest(Request &request);
+    virtual RequestBody &getRequestBody();
     virtual void setHeader(const std::string &name, const std::string &value);
     virtual void text(HttpStatusCode status, const std::string &body);
     virtual void html(HttpStatusCode status, const std::string &body);
     virtual void redirect(HttpStatusCode status, const std::string &location);
     virtual IOTaskManager &getManager() const;
     virtual int getClientFd() const;
+    // Clear the request and response to serve the next request on the same connection
+    // The responses already queued are kept, and everything allocated from the arena is released
+    void reset();
+    // Memory for one request, e.g. the parsed request-line and header fields and the response head
+    Arena &getArena();
+    // Serve another client. Call reset() as well to discard the previous request
+    void setClientFd(int client_fd);
+    // Responses are pushed here in request order and written when the queue is flushed
+    ResponseQueue &getResponseQueue();
+    // Milliseconds a response may take to be written, 0 disables
+    void setSendTimeout(unsigned int timeout_ms);
+    // Request bodies larger than memory_limit bytes are spilled to a temporary file in temp_dir
+    void setRequestBodyBuffer(std::size_t memory_limit, const std::string &temp_dir);
 
 private:
     IOTaskManager &manager_;
+    // Declared before the members using it
+    Arena arena_;
     Request request_;
+    RequestBody request_body_;
     int client_fd_;
-    ResponseWriter<int> writer_;
+    ResponseQueue responses_;
+    ResponseWriter<ResponseQueue &> writer_;
 };
 
 #endif //INTERNAL_HTTP_CONTEXT_HPP
@@ -0,0 +1,57 @@
+#include "date_header.hpp"
+#include <cstring>
+
+const std::size_t DateHeader::kSize;
+
+namespace {
+    const char *const kDayNames[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    const char *const kMonthNames[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    // ワーカースレッドごとに最後に作った行を持つ. -1 は未作成
+    __thread std::time_t formatted_time = -1;
+    __thread char formatted_line[DateHeader::kSize];
+
+    char *writeTwoDigits(char *out, int value) {
+        out[0] = static_cast<char>('0' + value / 10);
+        out[1] = static_cast<char>('0' + value % 10);
+        return out + 2;
+    }
+
+    char *writeString(char *out, const char *str) {
+        const std::size_t size = std::strlen(str);
+        std::memcpy(out, str, size);
+        return out + size;
+    }
+} // namespace
+
+// 秒が変わったときだけ作り直す
+StringView DateHeader::get(std::time_t now) {
+    if (now != formatted_time) {
+        format(now, formatted_line);
+        formatted_time = now;
+    }
+    return StringView(formatted_line, kSize);
+}
+
+// 曜日・月の名前がロケールに依存しないよう, strftime を使わずに書く
+void DateHeader::format(std::time_t now, char *out) {
+    struct tm tm = {};
+    gmtime_r(&now, &tm);
+    out = writeString(out, "Date: ");
+    out = writeString(out, kDayNames[tm.tm_wday]);
+    out = writeString(out, ", ");
+    out = writeTwoDigits(out, tm.tm_mday);
+    *out++ = ' ';
+    out = writeString(out, kMonthNames[tm.tm_mon]);
+    *out++ = ' ';
+    const int year = tm.tm_year + 1900;
+    out = writeTwoDigits(out, year / 100 % 100);
+    out = writeTwoDigits(out, year % 100);
+    *out++ = ' ';
+    out = writeTwoDigits(out, tm.tm_hour);
+    *out++ = ':';
+    out = writeTwoDigits(out, tm.tm_min);
+    *out++ = ':';
+    out = writeTwoDigits(out, tm.tm_sec);
+    writeString(out, " GMT\r\n");
+}
@@ -0,0 +1,23 @@
+#ifndef INTERNAL_HTTP_DATE_HEADER_HPP
+#define INTERNAL_HTTP_DATE_HEADER_HPP
+
+#include "utils/string_view.hpp"
+#include <cstddef>
+#include <ctime>
+
+// The Date header field line of the responses, e.g. "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n" (IMF-fixdate)
+// Each thread keeps the line of the last second it was asked for, so it is formatted at most once per second
+class DateHeader {
+public:
+    // "Date: " + IMF-fixdate (29) + CRLF
+    static const std::size_t kSize = 6 + 29 + 2;
+
+    // The line for now (seconds since the epoch), including the CRLF
+    // Valid until the next call with another second on the same thread
+    static StringView get(std::time_t now);
+
+private:
+    static void format(std::time_t now, char *out);
+};
+
+#endif
@@ -0,0 +1,291 @@
+#include "header_table.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace {
+    const char *const kHeaderNames[kHeaderUnknown] = {
+            "Host",
+            "Connection",
+            "Content-Length",
+            "Content-Type",
+            "Transfer-Encoding",
+            "Expect",
+            "Range",
+            "If-Range",
+            "If-None-Match",
+            "If-Modified-Since",
+            "Accept",
+            "Accept-Encoding",
+            "User-Agent",
+            "Cookie",
+            "Authorization",
+            "Cache-Control",
+    };
+
+    // 既知の名前の数の倍の大きさにすると, 長さと先頭・末尾のバイトから衝突なく決まる
+    const std::size_t kBucketCount = 32;
+    const HttpHeader kBuckets[kBucketCount] = {
+            kHeaderUnknown, // 0
+            kHeaderAcceptEncoding, // 1
+            kHeaderUnknown, // 2
+            kHeaderUnknown, // 3
+            kHeaderCacheControl, // 4
+            kHeaderUnknown, // 5
+            kHeaderUnknown, // 6
+            kHeaderUnknown, // 7
+            kHeaderUnknown, // 8
+            kHeaderContentLength, // 9
+            kHeaderUnknown, // 10
+            kHeaderUserAgent, // 11
+            kHeaderCookie, // 12
+            kHeaderUnknown, // 13
+            kHeaderIfNoneMatch, // 14
+            kHeaderConnection, // 15
+            kHeaderAuthorization, // 16
+            kHeaderUnknown, // 17
+            kHeaderContentType, // 18
+            kHeaderAccept, // 19
+            kHeaderIfRange, // 20
+            kHeaderUnknown, // 21
+            kHeaderTransferEncoding, // 22
+            kHeaderExpect, // 23
+            kHeaderHost, // 24
+            kHeaderUnknown, // 25
+            kHeaderRange, // 26
+            kHeaderUnknown, // 27
+            kHeaderUnknown, // 28
+            kHeaderIfModifiedSince, // 29
+            kHeaderUnknown, // 30
+            kHeaderUnknown, // 31
+    };
+
+    // field-name は tchar なので, 英大文字だけを変換すればよい
+    char toLower(char c) {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    bool equalsIgnoreCase(const StringView &lhs, const StringView &rhs) {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+        const char *l = lhs.data();
+        const char *r = rhs.data();
+        for (std::size_t i = 0; i < lhs.size(); i++) {
+            if (toLower(l[i]) != toLower(r[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+HttpHeader httpHeaderFromName(const StringView &name) {
+    if (name.empty()) {
+        return kHeaderUnknown;
+    }
+    const std::size_t first = static_cast<unsigned char>(toLower(name.data()[0]));
+    const std::size_t last = static_cast<unsigned char>(toLower(name.data()[name.size() - 1]));
+    const HttpHeader header = kBuckets[(name.size() + first + 7 * last) % kBucketCount];
+    if (header == kHeaderUnknown || !equalsIgnoreCase(name, kHeaderNames[header])) {
+        return kHeaderUnknown;
+    }
+    return header;
+}
+
+const char *httpHeaderName(HttpHeader header) {
+    return header < kHeaderUnknown ? kHeaderNames[header] : "";
+}
+
+const std::size_t HeaderTable::kMinOthersCapacity;
+
+HeaderTable::HeaderTable(Arena *arena)
+    : arena_(arena != NULL ? arena : &own_arena_), present_(0), others_(NULL), others_size_(0), others_capacity_(0), size_(0) {}
+
+HeaderTable::HeaderTable(const HeaderTable &other)
+    : arena_(&own_arena_), present_(0), others_(NULL), others_size_(0), others_capacity_(0), size_(0) {
+    *this = other;
+}
+
+// 借りているアリーナは持ち主がまとめて解放する
+HeaderTable::~HeaderTable() {}
+
+// 自分のアリーナは空にしてから使うので, 代入を繰り返しても確保したメモリが再利用される
+HeaderTable &HeaderTable::operator=(const HeaderTable &other) {
+    if (this == &other) {
+        return *this;
+    }
+    clear();
+    for (std::size_t i = 0; i < kHeaderUnknown; i++) {
+        if (other.present_ & (1u << i)) {
+            known_[i] = copy(other.known_[i], other);
+        }
+    }
+    present_ = other.present_;
+    for (std::size_t i = 0; i < other.others_size_; i++) {
+        addOther(copy(other.others_[i].name, other), copy(other.others_[i].value, other));
+    }
+    size_ = other.size_;
+    return *this;
+}
+
+bool HeaderTable::operator==(const HeaderTable &other) const {
+    if (size_ != other.size_) {
+        return false;
+    }
+    for (std::size_t i = 0; i < kHeaderUnknown; i++) {
+        if (get(static_cast<HttpHeader>(i)) != other.get(static_cast<HttpHeader>(i))) {
+            return false;
+        }
+    }
+    for (std::size_t i = 0; i < others_size_; i++) {
+        if (other.get(others_[i].name) != Some(others_[i].value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Option<HttpHeader> HeaderTable::add(const StringView &name, const StringView &value) {
+    const HttpHeader header = httpHeaderFromName(name);
+    if (header != kHeaderUnknown) {
+        const unsigned int bit = 1u << header;
+        if (present_ & bit) {
+            return None;
+        }
+        known_[header] = arena_->copy(value);
+        present_ |= bit;
+    } else {
+        if (findOther(name) != NULL) {
+            return None;
+        }
+        addOther(arena_->copy(name), arena_->copy(value));
+    }
+    size_++;
+    return Some(header);
+}
+
+// 繰り返されたリスト形式のフィールドは, カンマでつないだ 1 行と同じ意味になる
+// refs: https://datatracker.ietf.org/doc/html/rfc9110#section-5.3
+void HeaderTable::combine(const StringView &name, const StringView &value) {
+    const HttpHeader header = httpHeaderFromName(name);
+    StringView *existing = NULL;
+    if (header != kHeaderUnknown) {
+        if (present_ & (1u << header)) {
+            existing = &known_[header];
+        }
+    } else {
+        Field *field = findOther(name);
+        if (field != NULL) {
+            existing = &field->value;
+        }
+    }
+    if (existing == NULL) {
+        add(name, value);
+        return;
+    }
+
+    const char kSeparator[] = ", ";
+    const std::size_t separator_size = sizeof(kSeparator) - 1;
+    const std::size_t size = existing->size() + separator_size + value.size();
+    char *joined = static_cast<char *>(arena_->allocate(size));
+    std::memcpy(joined, existing->data(), existing->size());
+    std::memcpy(joined + existing->size(), kSeparator, separator_size);
+    std::memcpy(joined + existing->size() + separator_size, value.data(), value.size());
+    *existing = StringView(joined, size);
+}
+
+Option<StringView> HeaderTable::get(HttpHeader header) const {
+    if (header >= kHeaderUnknown || !(present_ & (1u << header))) {
+        return None;
+    }
+    return Some(known_[header]);
+}
+
+Option<StringView> HeaderTable::get(const StringView &name) const {
+    const HttpHeader header = httpHeaderFromName(name);
+    if (header != kHeaderUnknown) {
+        return get(header);
+    }
+    const Field *field = findOther(name);
+    if (field == NULL) {
+        return None;
+    }
+    return Some(field->value);
+}
+
+std::size_t HeaderTable::size() const {
+    return size_;
+}
+
+// 借りているアリーナのメモリは持ち主が解放するまで使われないまま残る
+void HeaderTable::clear() {
+    if (arena_ == &own_arena_) {
+        own_arena_.reset();
+    }
+    present_ = 0;
+    others_ = NULL;
+    others_size_ = 0;
+    others_capacity_ = 0;
+    size_ = 0;
+}
+
+// 自分のアリーナを使っている方は, 入れ替えた後も自分のアリーナを指すようにする
+void HeaderTable::swap(HeaderTable &other) {
+    const bool uses_own_arena = arena_ == &own_arena_;
+    const bool other_uses_own_arena = other.arena_ == &other.own_arena_;
+    own_arena_.swap(other.own_arena_);
+    std::swap(arena_, other.arena_);
+    if (uses_own_arena) {
+        other.arena_ = &other.own_arena_;
+    }
+    if (other_uses_own_arena) {
+        arena_ = &own_arena_;
+    }
+    std::swap(present_, other.present_);
+    for (std::size_t i = 0; i < kHeaderUnknown; i++) {
+        std::swap(known_[i], other.known_[i]);
+    }
+    std::swap(others_, other.others_);
+    std::swap(others_size_, other.others_size_);
+    std::swap(others_capacity_, other.others_capacity_);
+    std::swap(size_, other.size_);
+}
+
+// 配列が一杯なら倍の大きさの配列に移す. 古い配列はアリーナと一緒に解放される
+void HeaderTable::addOther(const StringView &name, const StringView &value) {
+    if (others_size_ == others_capacity_) {
+        const std::size_t capacity = others_capacity_ == 0 ? kMinOthersCapacity : others_capacity_ * 2;
+        Field *others = static_cast<Field *>(arena_->allocate(capacity * sizeof(Field)));
+        for (std::size_t i = 0; i < others_size_; i++) {
+            new (&others[i]) Field(others_[i]);
+        }
+        others_ = others;
+        others_capacity_ = capacity;
+    }
+    Field *field = new (&others_[others_size_]) Field();
+    field->name = name;
+    field->value = value;
+    others_size_++;
+}
+
+const HeaderTable::Field *HeaderTable::findOther(const StringView &name) const {
+    for (std::size_t i = 0; i < others_size_; i++) {
+        if (equalsIgnoreCase(others_[i].name, name)) {
+            return &others_[i];
+        }
+    }
+    return NULL;
+}
+
+HeaderTable::Field *HeaderTable::findOther(const StringView &name) {
+    return const_cast<Field *>(static_cast<const HeaderTable *>(this)->findOther(name));
+}
+
+// 同じアリーナにあるものは寿命も同じなので, コピーせずに参照する
+StringView HeaderTable::copy(const StringView &str, const HeaderTable &from) const {
+    if (from.arena_ == arena_) {
+        return str;
+    }
+    return arena_->copy(str);
+}
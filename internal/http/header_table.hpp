@@ -0,0 +1,93 @@
+#ifndef INTERNAL_HTTP_HEADER_TABLE_HPP
+#define INTERNAL_HTTP_HEADER_TABLE_HPP
+
+#include "utils/arena.hpp"
+#include "utils/option.hpp"
+#include "utils/string_view.hpp"
+
+// Field names the server looks up, each stored in its own slot of HeaderTable
+enum HttpHeader {
+    kHeaderHost,
+    kHeaderConnection,
+    kHeaderContentLength,
+    kHeaderContentType,
+    kHeaderTransferEncoding,
+    kHeaderExpect,
+    kHeaderRange,
+    kHeaderIfRange,
+    kHeaderIfNoneMatch,
+    kHeaderIfModifiedSince,
+    kHeaderAccept,
+    kHeaderAcceptEncoding,
+    kHeaderUserAgent,
+    kHeaderCookie,
+    kHeaderAuthorization,
+    kHeaderCacheControl,
+    // Number of the known field names, also used for the others
+    kHeaderUnknown,
+};
+
+// Recognizes a known field name case-insensitively with a perfect hash of its length and first and last bytes
+// Returns kHeaderUnknown for the others
+HttpHeader httpHeaderFromName(const StringView &name);
+// Canonical spelling of a known field name
+const char *httpHeaderName(HttpHeader header);
+
+// Header fields of a request
+// Known fields are kept in fixed slots and found in O(1), the others in a flat array searched linearly
+// Names and values are copied into an arena, so adding a field allocates only when the arena grows
+// The table either borrows the arena of its owner, e.g. the per-request one of the connection,
+// or has its own that keeps its memory through clear() and assignment
+// Field names are case-insensitive. Only the first field of each name is kept unless combined
+class HeaderTable {
+public:
+    // The fields are stored in arena if given, which must outlive the table and is reset by its owner
+    explicit HeaderTable(Arena *arena = NULL);
+    // The copy has its own arena
+    HeaderTable(const HeaderTable &other);
+    ~HeaderTable();
+    // Fields already in the same arena are shared instead of copied
+    HeaderTable &operator=(const HeaderTable &other);
+    // Equal if they have the same fields, in any order
+    bool operator==(const HeaderTable &other) const;
+
+    // Returns which known field name was added, or kHeaderUnknown for another name
+    // Returns None if a field of the same name has been added before, and the field is discarded
+    Option<HttpHeader> add(const StringView &name, const StringView &value);
+    // Appends value to the field of the same name as a comma-separated list, or adds it if absent
+    // Only for fields defined as lists, whose repeated lines mean the same as one joined line
+    void combine(const StringView &name, const StringView &value);
+    // The views are valid until the table is cleared or destroyed
+    Option<StringView> get(HttpHeader header) const;
+    Option<StringView> get(const StringView &name) const;
+    std::size_t size() const;
+    // Remove all the fields, keeping the allocated memory
+    void clear();
+    // Exchange the fields without copying them. A table using its own arena takes it along
+    void swap(HeaderTable &other);
+
+private:
+    struct Field {
+        StringView name;
+        StringView value;
+    };
+    static const std::size_t kMinOthersCapacity = 8;
+
+    Arena own_arena_;
+    Arena *arena_;
+    // Bit i is set if known_[i] is present
+    unsigned int present_;
+    StringView known_[kHeaderUnknown];
+    // Allocated from arena_ and moved to a twice as large array when full
+    Field *others_;
+    std::size_t others_size_;
+    std::size_t others_capacity_;
+    std::size_t size_;
+
+    void addOther(const StringView &name, const StringView &value);
+    const Field *findOther(const StringView &name) const;
+    Field *findOther(const StringView &name);
+    StringView copy(const StringView &str, const HeaderTable &from) const;
+};
+
+#endif //INTERNAL_HTTP_HEADER_TABLE_HPP
@@ -2,6 +2,7 @@
 #define INTERNAL_HTTP_INTERFACE_CONTEXT_HPP
 
 #include "http/request.hpp"
+#include "http/request_body.hpp"
 #include "http/status.hpp"
 #include "task/io_task_manager.hpp"
 
@@ -9,7 +10,10 @@ class IContext {
 public:
     virtual ~IContext();
     virtual const Request &getRequest() const = 0;
-    virtual void setRequest(const Request &request) = 0;
+    // Takes over request by swapping, so the fields are not copied. request is left with the previous one
+    virtual void setRequest(Request &request) = 0;
+    // Body of the request, appended while it is read and then read by the handler
+    virtual RequestBody &getRequestBody() = 0;
     virtual void setHeader(const std::string &name, const std::string &value) = 0;
     virtual void text(HttpStatusCode status, const std::string &body) = 0;
     virtual void html(HttpStatusCode status, const std::string &body) = 0;
@@ -1,6 +1,6 @@
 #include "method.hpp"
 
-HttpMethod httpMethodFromString(const std::string &method) {
+HttpMethod httpMethodFromString(const StringView &method) {
     if (method == "GET") {
         return kMethodGet;
     } else if (method == "POST") {
@@ -22,4 +22,4 @@ HttpMethod httpMethodFromString(const std::string &method) {
     } else {
         return kMethodUnknown;
     }
-}
\ No newline at end of file
+}
@@ -1,7 +1,7 @@
 #ifndef INTERNAL_HTTP_METHOD_HPP
 #define INTERNAL_HTTP_METHOD_HPP
 
-#include <string>
+#include "utils/string_view.hpp"
 
 enum HttpMethod {
     kMethodUnknown,
@@ -16,6 +16,6 @@ enum HttpMethod {
     kMethodPatch,
 };
 
-HttpMethod httpMethodFromString(const std::string &method);
+HttpMethod httpMethodFromString(const StringView &method);
 
 #endif //INTERNAL_HTTP_METHOD_HPP
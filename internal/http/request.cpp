@@ -1,25 +1,102 @@
 #include "request.hpp"
+#include <algorithm>
+#include <cctype>
 
-Request::Request() : method_(kMethodUnknown), request_target_("/"), http_version_("HTTP/1.1"), headers_(), body_() {}
+namespace {
+    // Connection = #connection-option (カンマ区切り, 大文字小文字を区別しない)
+    // refs: https://datatracker.ietf.org/doc/html/rfc9110#section-7.6.1
+    bool hasConnectionOption(const StringView &value, const std::string &option) {
+        std::size_t begin = 0;
+        while (begin <= value.size()) {
+            std::size_t end = value.find(',', begin);
+            if (end == StringView::npos) {
+                end = value.size();
+            }
+            StringView element = value.substr(begin, end - begin);
+            const std::size_t first = element.findFirstNotOf(" \t");
+            if (first != StringView::npos) {
+                element = element.substr(first, element.findLastNotOf(" \t") + 1 - first);
+                if (element.size() == option.size()) {
+                    bool matched = true;
+                    for (std::size_t i = 0; i < option.size(); i++) {
+                        if (std::tolower(static_cast<unsigned char>(element[i])) != option[i]) {
+                            matched = false;
+                            break;
+                        }
+                    }
+                    if (matched) {
+                        return true;
+                    }
+                }
+            }
+            begin = end + 1;
+        }
+        return false;
+    }
+
+    // HTTP-version = "HTTP/" DIGIT "." DIGIT なので, 文字列の大小で比べられる
+    bool isOlderThanHttp11(const StringView &http_version) {
+        const StringView http11("HTTP/1.1");
+        return std::lexicographical_compare(http_version.data(), http_version.data() + http_version.size(),
+                                            http11.data(), http11.data() + http11.size());
+    }
+} // namespace
+
+// 既定値はリテラルを指すので, コピーしない
+Request::Request()
+    : arena_(&own_arena_), method_(kMethodUnknown), request_target_("/"), http_version_("HTTP/1.1"), headers_(&own_arena_) {}
 
 Request::Request(HttpMethod method,
                  const std::string &request_target,
                  const std::string &http_version,
-                 const std::map<std::string, std::string> &headers,
-                 const std::string &body)
-    : method_(method), request_target_(request_target), http_version_(http_version), headers_(headers), body_(body) {}
+                 const std::map<std::string, std::string> &headers)
+    : arena_(&own_arena_),
+      method_(method),
+      request_target_(own_arena_.copy(request_target)),
+      http_version_(own_arena_.copy(http_version)),
+      headers_(&own_arena_) {
+    for (std::map<std::string, std::string>::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+        headers_.add(it->first, it->second);
+    }
+}
+
+Request::Request(HttpMethod method, const std::string &request_target, const std::string &http_version, const HeaderTable &headers)
+    : arena_(&own_arena_),
+      method_(method),
+      request_target_(own_arena_.copy(request_target)),
+      http_version_(own_arena_.copy(http_version)),
+      headers_(&own_arena_) {
+    headers_ = headers;
+}
+
+// headers が同じアリーナにあれば, フィールドもコピーされない
+Request::Request(HttpMethod method, const StringView &request_target, const StringView &http_version, const HeaderTable &headers, Arena &arena)
+    : arena_(&arena), method_(method), request_target_(request_target), http_version_(http_version), headers_(&arena) {
+    headers_ = headers;
+}
 
 Request::Request(const Request &other)
-    : method_(other.method_), request_target_(other.request_target_), http_version_(other.http_version_), headers_(other.headers_), body_(other.body_) {}
+    : arena_(&own_arena_),
+      method_(other.method_),
+      request_target_(own_arena_.copy(other.request_target_)),
+      http_version_(own_arena_.copy(other.http_version_)),
+      headers_(&own_arena_) {
+    headers_ = other.headers_;
+}
 
+// 自分のアリーナは空にしてから使うので, 同じリクエストに代入を繰り返しても確保したメモリが再利用される
 Request &Request::operator=(const Request &other) {
-    if (this != &other) {
-        method_ = other.method_;
-        request_target_ = other.request_target_;
-        http_version_ = other.http_version_;
-        headers_ = other.headers_;
-        body_ = other.body_;
+    if (this == &other) {
+        return *this;
+    }
+    headers_.clear();
+    if (arena_ == &own_arena_) {
+        own_arena_.reset();
     }
+    method_ = other.method_;
+    request_target_ = arena_->copy(other.request_target_);
+    http_version_ = arena_->copy(other.http_version_);
+    headers_ = other.headers_;
     return *this;
 }
 
@@ -27,7 +104,7 @@ HttpMethod Request::method() const {
     return method_;
 }
 
-const std::string &Request::path() const {
+const StringView &Request::path() const {
     // TODO: クエリパラメータが含まれる場合, またはリクエストターゲットが origin-form 以外の場合に返す値を検討する
     // refs: https://datatracker.ietf.org/doc/html/rfc9112#section-3.2
     // refs: https://github.com/EringiShimeji/webserv/pull/84#discussion_r1540941614
@@ -41,27 +118,53 @@ Option<std::string> Request::query(const std::string &key) const {
     return None;
 }
 
-const std::string &Request::httpVersion() const {
+const StringView &Request::httpVersion() const {
     return http_version_;
 }
 
-// Returns nullptr when key is not found.
-Option<std::string> Request::header(const std::string &key) const {
-    std::map<std::string, std::string>::const_iterator value = headers_.find(key);
+Option<StringView> Request::header(const StringView &name) const {
+    return headers_.get(name);
+}
+
+Option<StringView> Request::header(HttpHeader header) const {
+    return headers_.get(header);
+}
+
+const HeaderTable &Request::headers() const {
+    return headers_;
+}
 
-    if (value == headers_.end())
-        return None;
-    return Some(value->second);
+// HTTP/1.1 以降は close が指定されない限り持続, HTTP/1.0 以前は keep-alive が指定された場合のみ持続
+// refs: https://datatracker.ietf.org/doc/html/rfc9112#section-9.3
+bool Request::isKeepAlive() const {
+    const StringView connection = header(kHeaderConnection).unwrapOr(StringView());
+    if (isOlderThanHttp11(http_version_)) {
+        return hasConnectionOption(connection, "keep-alive");
+    }
+    return !hasConnectionOption(connection, "close");
 }
 
-const std::string &Request::body() const {
-    return body_;
+// 自分のアリーナを使っている方は, 入れ替えた後も自分のアリーナを指すようにする
+void Request::swap(Request &other) {
+    const bool uses_own_arena = arena_ == &own_arena_;
+    const bool other_uses_own_arena = other.arena_ == &other.own_arena_;
+    own_arena_.swap(other.own_arena_);
+    std::swap(arena_, other.arena_);
+    if (uses_own_arena) {
+        other.arena_ = &other.own_arena_;
+    }
+    if (other_uses_own_arena) {
+        arena_ = &own_arena_;
+    }
+    std::swap(method_, other.method_);
+    std::swap(request_target_, other.request_target_);
+    std::swap(http_version_, other.http_version_);
+    headers_.swap(other.headers_);
 }
 
 bool Request::operator==(const Request &rhs) const {
     return method_ == rhs.method_
             && request_target_ == rhs.request_target_
             && http_version_ == rhs.http_version_
-            && headers_ == rhs.headers_
-            && body_ == rhs.body_;
+            && headers_ == rhs.headers_;
 }
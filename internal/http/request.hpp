@@ -1,36 +1,53 @@
 #ifndef INTERNAL_HTTP_REQUEST_HPP
 #define INTERNAL_HTTP_REQUEST_HPP
 
+#include "header_table.hpp"
 #include "method.hpp"
 #include "utils/option.hpp"
 #include <map>
 #include <string>
 
+// Request-line and header section of a request
+// The message-body is streamed separately through RequestBody
+// The fields are stored in an arena: the one the request is built in, or its own one for copies,
+// which keeps its memory through assignment
 class Request {
 public:
     Request();
     explicit Request(HttpMethod method,
                      const std::string &request_target,
                      const std::string &http_version = "HTTP/1.1",
-                     const std::map<std::string, std::string> &headers = std::map<std::string, std::string>(),
-                     const std::string &body = "");
+                     const std::map<std::string, std::string> &headers = std::map<std::string, std::string>());
+    Request(HttpMethod method, const std::string &request_target, const std::string &http_version, const HeaderTable &headers);
+    // Build the request in arena without copying, e.g. from the parser
+    // request_target, http_version and headers must be valid as long as arena
+    Request(HttpMethod method, const StringView &request_target, const StringView &http_version, const HeaderTable &headers, Arena &arena);
+    // The copy has its own arena
     Request(const Request &other);
     Request &operator=(const Request &other);
     bool operator==(const Request &rhs) const;
+    // Exchange the requests without copying the fields, e.g. to hand over one built in a borrowed arena
+    void swap(Request &other);
 
     HttpMethod method() const;
-    const std::string &path() const;
+    const StringView &path() const;
     Option<std::string> query(const std::string &key) const;
-    const std::string &httpVersion() const;
-    Option<std::string> header(const std::string &key) const;
-    const std::string &body() const;
+    const StringView &httpVersion() const;
+    // Case-insensitive. The view is valid as long as the request
+    Option<StringView> header(const StringView &name) const;
+    // O(1) and never allocates
+    Option<StringView> header(HttpHeader header) const;
+    const HeaderTable &headers() const;
+    // Whether the client wants the connection to persist after the response
+    bool isKeepAlive() const;
 
 private:
+    Arena own_arena_;
+    Arena *arena_;
     HttpMethod method_;
-    std::string request_target_;
-    std::string http_version_;
-    std::map<std::string, std::string> headers_;
-    std::string body_;
+    StringView request_target_;
+    StringView http_version_;
+    HeaderTable headers_;
 };
 
 #endif
@@ -0,0 +1,163 @@
+#include "request_body.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+
+const std::string RequestBody::kDefaultTempDir = "/tmp";
+
+namespace {
+    // CGI などの子プロセスに他のリクエストの body を引き継がないよう, close-on-exec で作る
+    int createTempFile(char *path) {
+#if defined(__linux__)
+        return mkostemp(path, O_CLOEXEC);
+#else
+        const int fd = mkstemp(path);
+        if (fd == -1) {
+            return -1;
+        }
+        if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) {
+            const int saved_errno = errno;
+            close(fd);
+            unlink(path);
+            errno = saved_errno;
+            return -1;
+        }
+        return fd;
+#endif
+    }
+} // namespace
+
+RequestBody::RequestBody(std::size_t memory_limit, const std::string &temp_dir)
+    : memory_limit_(memory_limit), temp_dir_(temp_dir), fd_(-1), size_(0), read_pos_(0) {}
+
+RequestBody::~RequestBody() {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+Result<types::Unit, std::string> RequestBody::append(const char *data, std::size_t n) {
+    if (fd_ == -1 && size_ + n > memory_limit_) {
+        TRY(spill());
+    }
+    if (fd_ == -1) {
+        memory_.append(data, n);
+    } else {
+        TRY(writeFile(data, n));
+    }
+    size_ += n;
+    return Ok(unit);
+}
+
+Result<std::size_t, std::string> RequestBody::read(char *buf, std::size_t n) {
+    const std::size_t bytes_read = TRY(readAt(buf, n, read_pos_));
+    read_pos_ += bytes_read;
+    return Ok(bytes_read);
+}
+
+bool RequestBody::eof() const {
+    return read_pos_ == size_;
+}
+
+std::size_t RequestBody::size() const {
+    return size_;
+}
+
+bool RequestBody::isSpilled() const {
+    return fd_ != -1;
+}
+
+void RequestBody::rewind() {
+    read_pos_ = 0;
+}
+
+Result<std::string, std::string> RequestBody::toString() const {
+    if (fd_ == -1) {
+        return Ok(memory_);
+    }
+    std::string body(size_, '\0');
+    std::size_t offset = 0;
+    while (offset < size_) {
+        const std::size_t bytes_read = TRY(readAt(&body[offset], size_ - offset, offset));
+        if (bytes_read == 0) {
+            return Err<std::string>("request body file is truncated");
+        }
+        offset += bytes_read;
+    }
+    return Ok(body);
+}
+
+// 次のリクエストまで接続を待たせる間にメモリを持ち続けないよう, 確保した領域も解放する
+void RequestBody::clear() {
+    if (fd_ != -1) {
+        close(fd_);
+        fd_ = -1;
+    }
+    std::string().swap(memory_);
+    size_ = 0;
+    read_pos_ = 0;
+}
+
+void RequestBody::setMemoryLimit(std::size_t memory_limit) {
+    memory_limit_ = memory_limit;
+}
+
+void RequestBody::setTempDir(const std::string &temp_dir) {
+    temp_dir_ = temp_dir;
+}
+
+// 一時ファイルは作成直後に unlink し, fd を閉じればカーネルが消す
+// プロセスが異常終了しても一時ファイルが残らない
+Result<types::Unit, std::string> RequestBody::spill() {
+    const std::string path_template = temp_dir_ + "/webserv_body_XXXXXX";
+    std::vector<char> path(path_template.begin(), path_template.end());
+    path.push_back('\0');
+    const int fd = createTempFile(&path[0]);
+    if (fd == -1) {
+        return Err(std::string("failed to create request body file: ") + std::strerror(errno));
+    }
+    unlink(&path[0]);
+    fd_ = fd;
+    TRY(writeFile(memory_.data(), memory_.size()));
+    std::string().swap(memory_);
+    return Ok(unit);
+}
+
+Result<types::Unit, std::string> RequestBody::writeFile(const char *data, std::size_t n) {
+    std::size_t written = 0;
+    while (written < n) {
+        const ssize_t bytes_written = write(fd_, data + written, n - written);
+        if (bytes_written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return Err(std::string("failed to write request body file: ") + std::strerror(errno));
+        }
+        written += static_cast<std::size_t>(bytes_written);
+    }
+    return Ok(unit);
+}
+
+Result<std::size_t, std::string> RequestBody::readAt(char *buf, std::size_t n, std::size_t offset) const {
+    if (offset >= size_) {
+        return Ok<std::size_t>(0);
+    }
+    const std::size_t bytes_to_read = std::min(n, size_ - offset);
+    if (fd_ == -1) {
+        std::memcpy(buf, memory_.data() + offset, bytes_to_read);
+        return Ok(bytes_to_read);
+    }
+    while (true) {
+        const ssize_t bytes_read = pread(fd_, buf, bytes_to_read, static_cast<off_t>(offset));
+        if (bytes_read != -1) {
+            return Ok(static_cast<std::size_t>(bytes_read));
+        }
+        if (errno != EINTR) {
+            return Err(std::string("failed to read request body file: ") + std::strerror(errno));
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef INTERNAL_HTTP_REQUEST_BODY_HPP
+#define INTERNAL_HTTP_REQUEST_BODY_HPP
+
+#include "io/reader.hpp"
+#include "utils/result.hpp"
+#include "utils/unit.hpp"
+#include <string>
+
+// Message-body of a request, appended while it is received and read by the handler as a stream
+// Kept in memory up to memory_limit bytes and spilled to an unlinked temporary file in temp_dir beyond it,
+// so the memory held by one request is bounded regardless of the body size
+class RequestBody : public IReader {
+public:
+    static const std::size_t kDefaultMemoryLimit = 16 * 1024;
+    static const std::string kDefaultTempDir;
+
+    explicit RequestBody(std::size_t memory_limit = kDefaultMemoryLimit, const std::string &temp_dir = kDefaultTempDir);
+    // Close the temporary file, which is removed by the kernel
+    virtual ~RequestBody();
+
+    // Append data after the bytes appended so far
+    Result<types::Unit, std::string> append(const char *data, std::size_t n);
+    // Read the bytes after the last read, from the beginning at first
+    virtual Result<std::size_t, std::string> read(char *buf, std::size_t n);
+    // Whether all the bytes appended so far have been read
+    virtual bool eof() const;
+    std::size_t size() const;
+    // Whether the body has been spilled to a temporary file
+    bool isSpilled() const;
+    // Read from the beginning again
+    void rewind();
+    // Copy the whole body regardless of the read position. Only for bodies known to be small
+    Result<std::string, std::string> toString() const;
+    // Discard the body to receive the next one. The limits are kept
+    void clear();
+    // Takes effect from the next body
+    void setMemoryLimit(std::size_t memory_limit);
+    void setTempDir(const std::string &temp_dir);
+
+private:
+    std::size_t memory_limit_;
+    std::string temp_dir_;
+    // Body while it fits in memory_limit_
+    std::string memory_;
+    // Temporary file once spilled, -1 otherwise
+    int fd_;
+    std::size_t size_;
+    std::size_t read_pos_;
+
+    Result<types::Unit, std::string> spill();
+    Result<types::Unit, std::string> writeFile(const char *data, std::size_t n);
+    Result<std::size_t, std::string> readAt(char *buf, std::size_t n, std::size_t offset) const;
+
+    RequestBody(const RequestBody &other);
+    RequestBody &operator=(const RequestBody &other);
+};
+
+#endif //INTERNAL_HTTP_REQUEST_BODY_HPP
@@ -2,8 +2,60 @@
 #include "method.hpp"
 #include "utils/utils.hpp"
 
+namespace {
+    // 1 バイトごとの文字クラス. 1 回の表引きで ABNF の規則を判定する
+    // refs: https://datatracker.ietf.org/doc/html/rfc9110#section-5.6.2
+    enum CharClass {
+        kTchar = 1 << 0,      // tchar (field-name, method)
+        kFieldVchar = 1 << 1, // VCHAR / obs-text (field-value, request-target)
+        kOws = 1 << 2,        // SP / HTAB
+        kDigit = 1 << 3,      // DIGIT
+    };
+    // 表を 16 列に収めるための略記
+    enum {
+        kT = kTchar,
+        kV = kFieldVchar,
+        kO = kOws,
+        kTV = kTchar | kFieldVchar,
+        kTVD = kTchar | kFieldVchar | kDigit,
+    };
+    const unsigned char kCharClasses[256] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 0, kO, 0, 0, 0, 0, 0, 0, // 0x00
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x10
+            kO, kTV, kV, kTV, kTV, kTV, kTV, kTV, kV, kV, kTV, kTV, kV, kTV, kTV, kV, // 0x20
+            kTVD, kTVD, kTVD, kTVD, kTVD, kTVD, kTVD, kTVD, kTVD, kTVD, kV, kV, kV, kV, kV, kV, // 0x30
+            kV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, // 0x40
+            kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kV, kV, kV, kTV, kTV, // 0x50
+            kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, // 0x60
+            kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kTV, kV, kTV, kV, kTV, 0, // 0x70
+            kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, // 0x80
+            kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, // 0x90
+            kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, // 0xA0
+            kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, // 0xB0
+            kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, // 0xC0
+            kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, // 0xD0
+            kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, // 0xE0
+            kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, kV, // 0xF0
+    };
+
+    bool is(char c, CharClass char_class) {
+        return (kCharClasses[static_cast<unsigned char>(c)] & char_class) != 0;
+    }
+
+    // pos から char_class のバイトが続く間進め, 続かなくなった位置を返す
+    // StringView::operator[] は inline 展開されないので, ポインタで走査する
+    std::size_t skip(const StringView &line, std::size_t pos, CharClass char_class) {
+        const char *data = line.data();
+        const std::size_t size = line.size();
+        while (pos < size && is(data[pos], char_class)) {
+            pos++;
+        }
+        return pos;
+    }
+} // namespace
+
 Result<Request, std::string>
-RequestParser::parseRequest(const std::string &request_line, const std::vector<std::string> &headers, const std::string &body) {
+RequestParser::parseRequest(const std::string &request_line, const std::vector<std::string> &headers) {
     // TODO: parse query
     const RequestLine parsed_request_line = TRY(parseRequestLine(request_line));
 
@@ -17,132 +69,88 @@ RequestParser::parseRequest(const std::string &request_line, const std::vector<s
             parsed_request_line.first.first,  // method
             parsed_request_line.first.second, // request-target
             parsed_request_line.second,       // HTTP-version
-            parsed_headers,
-            body));
+            parsed_headers));
 }
 
-// field-line = field-name ":" OWS field-value OWS
-Result<std::pair<std::string, std::string>, std::string>
-RequestParser::parseHeaderFieldLine(const std::string &line) {
-    // : の前後で区切る
-    const std::size_t colon_pos = line.find(':');
-    if (colon_pos == std::string::npos) {
-        return Err<std::string>("invalid field-line");
-    }
-    const std::string raw_field_name = line.substr(0, colon_pos);
-    const std::string raw_field_value = line.substr(colon_pos + 1);
+Result<RequestParser::HeaderField, std::string>
+RequestParser::parseHeaderFieldLine(const StringView &line) {
+    const HeaderFieldView field = TRY(scanHeaderFieldLine(line));
+    return Ok(std::make_pair(field.name.toString(), field.value.toString()));
+}
 
-    // field-name の検証
-    if (!isValidFieldName(raw_field_name)) {
+Result<RequestParser::RequestLine, std::string> RequestParser::parseRequestLine(const StringView &line) {
+    const RequestLineView request_line = TRY(scanRequestLine(line));
+    return Ok(std::make_pair(std::make_pair(request_line.method, request_line.request_target.toString()), request_line.http_version.toString()));
+}
+
+// field-line = field-name ":" OWS field-value OWS
+// field-name = token
+// field-value = *field-content
+// field-content = field-vchar [ 1*( SP / HTAB / field-vchar ) field-vchar ]
+// 先頭から 1 回だけ走査し, 名前と値の位置を記録する
+Result<RequestParser::HeaderFieldView, std::string>
+RequestParser::scanHeaderFieldLine(const StringView &line) {
+    // field-name と : の間に空白は許されない
+    // refs: https://datatracker.ietf.org/doc/html/rfc9112#section-5.1
+    const std::size_t colon_pos = skip(line, 0, kTchar);
+    if (colon_pos == 0) {
         return Err<std::string>("invalid field-name");
     }
-
-    // field-value の検証
-    // OWS = *( SP / HTAB ) で trim する
-    /* (RFC 9110)
-     * A field value does not include leading or trailing whitespace.
-     * When a specific version of HTTP allows such whitespace to appear in a message,
-     * a field parsing implementation MUST exclude such whitespace
-     * prior to evaluating the field value.
-     */
-    const std::string::size_type begin = raw_field_value.find_first_not_of(" \t");
-    const std::string::size_type end = raw_field_value.find_last_not_of(" \t");
-    if (begin == std::string::npos || end == std::string::npos) {
-        return Err<std::string>("invalid field-value");
+    if (colon_pos == line.size() || line[colon_pos] != ':') {
+        return Err<std::string>("invalid field-line");
     }
-    const std::string trimmed_raw_field_value = raw_field_value.substr(begin, end - begin + 1);
-    if (!isValidFieldValue(trimmed_raw_field_value)) {
-        return Err<std::string>("invalid field-value");
+
+    // 前後の OWS は field-value に含めない (MUST)
+    // refs: https://datatracker.ietf.org/doc/html/rfc9110#section-5.5
+    const std::size_t value_begin = skip(line, colon_pos + 1, kOws);
+    const char *data = line.data();
+    std::size_t value_end = value_begin;
+    for (std::size_t i = value_begin; i < line.size(); i++) {
+        const unsigned char char_class = kCharClasses[static_cast<unsigned char>(data[i])];
+        if (char_class & kFieldVchar) {
+            value_end = i + 1;
+        } else if (!(char_class & kOws)) {
+            return Err<std::string>("invalid field-value");
+        }
     }
 
-    return Ok(std::make_pair(raw_field_name, trimmed_raw_field_value));
+    const HeaderFieldView field = {line.substr(0, colon_pos), line.substr(value_begin, value_end - value_begin)};
+    return Ok(field);
 }
 
 // request-line = method SP request-target SP HTTP-version
+// method = token
 // NOTE: サーバーは SP 以外にも HTAB, VT, FF, CR を区切りとしてもよい (MAY)
-Result<RequestParser::RequestLine, std::string> RequestParser::parseRequestLine(const std::string &line) {
-    // 最初と最後のスペースを探し, 3分割する
-    const std::string::size_type first_space_pos = line.find(' ');
-    const std::string::size_type last_space_pos = line.find_last_of(' ');
-    if (first_space_pos == std::string::npos || last_space_pos == std::string::npos) {
+Result<RequestParser::RequestLineView, std::string> RequestParser::scanRequestLine(const StringView &line) {
+    const std::size_t method_end = skip(line, 0, kTchar);
+    if (method_end == 0 || method_end == line.size() || line[method_end] != ' ') {
         return Err<std::string>("invalid request-line");
     }
-    if (first_space_pos == last_space_pos) {
+    // TODO: request-target の validation
+    const std::size_t target_begin = method_end + 1;
+    const std::size_t target_end = skip(line, target_begin, kFieldVchar);
+    if (target_end == target_begin || target_end == line.size() || line[target_end] != ' ') {
         return Err<std::string>("invalid request-line");
     }
-    const std::string raw_method = line.substr(0, first_space_pos);
-    const std::string raw_request_target = line.substr(first_space_pos + 1, last_space_pos - first_space_pos - 1);
-    const std::string raw_http_version = line.substr(last_space_pos + 1);
 
-    // TODO: request-target の validation
-    const HttpMethod method = httpMethodFromString(raw_method);
+    const HttpMethod method = httpMethodFromString(line.substr(0, method_end));
     if (method == kMethodUnknown) {
         return Err<std::string>("unknown method");
     }
-    if (!isValidHttpVersion(raw_http_version)) {
+    const StringView http_version = line.substr(target_end + 1);
+    if (!isValidHttpVersion(http_version)) {
         return Err<std::string>("invalid HTTP-version");
     }
 
-    return Ok(std::make_pair(std::make_pair(method, raw_request_target), raw_http_version));
+    const RequestLineView request_line = {method, line.substr(target_begin, target_end - target_begin), http_version};
+    return Ok(request_line);
 }
 
-/*
-* field-name = token
-* token = 1*tchar
-* tchar = "!" / "#" / "$" / "%" / "&" / "'" / "*"
-*       / "+" / "-" / "." / "^" / "_" / "`" / "|" / "~"
-*       / DIGIT / ALPHA ; any VCHAR, except delimiters
-*/
-bool RequestParser::isValidFieldName(const std::string &field_name) {
-    if (field_name.empty()) {
-        return false;
-    }
-
-    for (size_t i = 0; i < field_name.size(); i++) {
-        unsigned char c = field_name[i];
-        if (!(std::isalnum(c) || c == '!' || c == '#' || c == '$' || c == '%' || c == '&' || c == '\'' || c == '*' || c == '+' || c == '-' || c == '.' || c == '^' || c == '_' || c == '`' || c == '|' || c == '~')) {
-            return false;
-        }
-    }
-    return true;
-}
-
-/*
-* field-value = *field-content
-* field-content = field-vchar [ 1*( SP / HTAB / field-vchar ) field-vchar) ]
-* field-vchar = VCHAR / obs-text
-* obs-text = %x80-FF
-*/
-// NOTE: trim 済みであることを仮定すれば, field-value = *field-vchar
-bool RequestParser::isValidFieldValue(const std::string &field_value) {
-    if (field_value.empty()) {
-        return true;
-    }
-
-    // 先頭・末尾が SP / HTAB でないことを確認
-    if (field_value[0] == ' ' || field_value[0] == '\t' || field_value[field_value.size() - 1] == ' ' || field_value[field_value.size() - 1] == '\t') {
-        return false;
-    }
-
-    // 最後に *( SP / HTAB / field-vchar ) であることを確認すればよい
-    for (size_t i = 0; i < field_value.size(); i++) {
-        unsigned char c = field_value[i];
-        // TODO: std::isprint で適切か
-        if (!std::isprint(c) && !(c >= 0x80 && c <= 0xff)) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-bool RequestParser::isValidHttpVersion(const std::string &http_version) {
-    // HTTP/1.1 の形式, 8文字
-    if (!(http_version.size() == 8 && utils::startsWith(http_version, "HTTP/"))) {
-        return false;
-    }
-    // バージョンをチェック
-    char major = http_version[5];
-    char minor = http_version[7];
-    return http_version[6] == '.' && std::isdigit(major) && std::isdigit(minor);
+// HTTP-version = HTTP-name "/" DIGIT "." DIGIT
+bool RequestParser::isValidHttpVersion(const StringView &http_version) {
+    return http_version.size() == 8
+            && http_version.startsWith("HTTP/")
+            && is(http_version[5], kDigit)
+            && http_version[6] == '.'
+            && is(http_version[7], kDigit);
 }
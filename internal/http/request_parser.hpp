@@ -3,24 +3,41 @@
 
 #include "request.hpp"
 #include "utils/result.hpp"
+#include "utils/string_view.hpp"
 #include <vector>
 
+// Each line is parsed in a single pass, validating every byte with one lookup in a 256-entry table
+// The scan functions only record where the fields are, and the parse ones copy them
 class RequestParser {
 public:
     typedef std::pair<std::string, std::string> HeaderField;
-
-    static Result<Request, std::string> parseRequest(const std::string &request_line, const std::vector<std::string> &headers, const std::string &body);
-    static Result<std::pair<std::string, std::string>, std::string> parseHeaderFieldLine(const std::string &line);
-
-private:
     // TODO: 分かりにくいのでクラスにする (使用箇所は限定的なので後回し)
     // method, request-target, HTTP-version
     typedef std::pair<std::pair<HttpMethod, std::string>, std::string> RequestLine;
 
-    static Result<RequestLine, std::string> parseRequestLine(const std::string &line);
-    static bool isValidFieldName(const std::string &field_name);
-    static bool isValidFieldValue(const std::string &field_value);
-    static bool isValidHttpVersion(const std::string &http_version);
+    // Views into the parsed line, valid as long as the line
+    struct RequestLineView {
+        HttpMethod method;
+        StringView request_target;
+        StringView http_version;
+    };
+    struct HeaderFieldView {
+        StringView name;
+        // Without the leading and trailing whitespace, may be empty
+        StringView value;
+    };
+
+    static Result<Request, std::string> parseRequest(const std::string &request_line, const std::vector<std::string> &headers);
+    // The lines are taken without CRLF
+    // Only the parsed fields are copied, so the lines may point into a read buffer
+    static Result<RequestLine, std::string> parseRequestLine(const StringView &line);
+    static Result<HeaderField, std::string> parseHeaderFieldLine(const StringView &line);
+    // Same as the parse ones, but nothing is copied
+    static Result<RequestLineView, std::string> scanRequestLine(const StringView &line);
+    static Result<HeaderFieldView, std::string> scanHeaderFieldLine(const StringView &line);
+
+private:
+    static bool isValidHttpVersion(const StringView &http_version);
 };
 
 #endif //INTERNAL_HTTP_REQUEST_PARSER_HPP
@@ -2,7 +2,15 @@
 
 template<>
 void ResponseWriter<int>::send() {
-    new WriteFile(manager_, output_, generateRawResponseText(), cb_);
+    new WriteFile(manager_, output_, generateRawResponseText(), cb_, kOwnBorrow, send_timeout_);
+}
+
+// 書き込みはキューが前のレスポンスの後に行う
+// body はコピーせずにキューの文字列と入れ替え, ヘッダーとは別の iovec セグメントとして writev で書かれる
+// 連結した文字列は作らない
+template<>
+void ResponseWriter<ResponseQueue &>::send() {
+    output_.push(generateHead(), body_);
 }
 
 // This function is for testing purposes only.
@@ -1,11 +1,16 @@
 #ifndef INTERNAL_HTTP_RESPONSE_WRITER_HPP
 #define INTERNAL_HTTP_RESPONSE_WRITER_HPP
 
+#include "date_header.hpp"
 #include "status.hpp"
 #include "task/io_task_manager.hpp"
+#include "task/response_queue.hpp"
 #include "task/write_file.hpp"
+#include "utils/arena.hpp"
+#include "utils/string_view.hpp"
 #include "utils/unit.hpp"
 #include "utils/utils.hpp"
+#include <cstring>
 #include <sstream>
 #include <unistd.h>
 
@@ -14,7 +19,11 @@ class ResponseWriter {
 public:
     static const std::string kProtocolVersion;
 
-    ResponseWriter(IOTaskManager &manager, T output, IWriteFileCallback *cb) : manager_(manager), output_(output), cb_(cb), status_code_(kStatusOk) {}
+    // cb is borrowed and is called every time a response has been written
+    // The head of each response is formatted in arena, which must outlive the writer and is reset by its owner
+    // If NULL, the writer uses its own arena, reused for every response
+    ResponseWriter(IOTaskManager &manager, T output, IWriteFileCallback *cb, Arena *arena = NULL)
+        : manager_(manager), output_(output), cb_(cb), arena_(arena != NULL ? arena : &own_arena_), send_timeout_(0), status_code_(kStatusOk) {}
 
     ~ResponseWriter() {}
 
@@ -22,9 +31,18 @@ public:
         body_ += content;
     }
 
+    // 一時的な文字列を作らずに header_ に追記する
+    void addHeader(const std::string &key, const std::string &value) {
+        appendHeaderLine(key, value);
+    }
+
+    void addHeader(const std::string &key, const char *value) {
+        appendHeaderLine(key, value);
+    }
+
     template<class V>
     void addHeader(const std::string &key, V value) {
-        header_ += generateHeaderLine(key, value);
+        appendHeaderLine(key, utils::toString(value));
     }
 
     void setStatus(HttpStatusCode code) {
@@ -33,39 +51,88 @@ public:
 
     void send();
 
+    // Milliseconds the output may stay unwritable before the write fails, 0 disables
+    void setSendTimeout(unsigned int timeout_ms) {
+        send_timeout_ = timeout_ms;
+    }
+
+    void setOutput(T output) {
+        output_ = output;
+    }
+
+    // Discard the response built so far to write the next one
+    void reset() {
+        status_code_ = kStatusOk;
+        body_.clear();
+        header_.clear();
+    }
+
 private:
+    // 表にないステータスコードの status-line ("HTTP/1.1 " + 数字 + " " + CRLF)
+    // + "Content-Length: " + 数字 + CRLF + 空行
+    static const std::size_t kHeadFixedSize = 9 + utils::kMaxDecimalDigits + 3 + 16 + utils::kMaxDecimalDigits + 2 + 2;
+
     IOTaskManager &manager_;
     T output_;
     IWriteFileCallback *cb_;
+    Arena own_arena_;
+    Arena *arena_;
+    unsigned int send_timeout_;
     HttpStatusCode status_code_;
     std::string body_;
     std::string header_;
 
-    std::string generateStatusLine() {
-        std::string status_code = utils::toString(status_code_);
-        std::string status_text = getHttpStatusText(status_code_);
-
-        return kProtocolVersion + " " + status_code + " " + status_text + "\r\n";
+    void appendHeaderLine(const std::string &key, const StringView &value) {
+        header_.append(key).append(": ").append(value.data(), value.size()).append("\r\n");
     }
 
-    template<class V>
-    std::string generateHeaderLine(const std::string &key, V value) {
-        return key + ": " + utils::toString(value) + "\r\n";
+    // status-line, Date, Content-Length, the other header fields and the empty line
+    // Valid until the arena is reset, i.e. until the next response if the arena is the writer's own
+    StringView generateHead() {
+        if (arena_ == &own_arena_) {
+            own_arena_.reset();
+        }
+        // status-line と Date は作成済みのものをコピーし, 数値は確保なしで書く
+        const StringView status_line = getHttpStatusLine(status_code_);
+        const StringView date = DateHeader::get(manager_.getCurrentTime());
+        const std::size_t max_size = kHeadFixedSize + status_line.size() + date.size() + header_.size();
+        char *head = static_cast<char *>(arena_->allocate(max_size));
+
+        std::size_t size = 0;
+        if (status_line.empty()) {
+            // 表にないコードは理由句を空にする
+            size += append(head + size, kProtocolVersion);
+            head[size++] = ' ';
+            size += utils::formatDecimal(head + size, static_cast<unsigned long>(status_code_));
+            size += append(head + size, " \r\n");
+        } else {
+            size += append(head + size, status_line);
+        }
+        size += append(head + size, date);
+        size += append(head + size, "Content-Length: ");
+        size += utils::formatDecimal(head + size, body_.size());
+        size += append(head + size, "\r\n");
+        size += append(head + size, header_);
+        size += append(head + size, "\r\n");
+        return StringView(head, size);
     }
 
-    template<>
-    std::string generateHeaderLine(const std::string &key, const std::string &value) {
-        return key + ": " + value + "\r\n";
+    static std::size_t append(char *out, const StringView &str) {
+        std::memcpy(out, str.data(), str.size());
+        return str.size();
     }
 
     std::string generateRawResponseText() {
-        std::string content_length = generateHeaderLine("Content-Length", body_.size());
-
-        return generateStatusLine() + content_length + header_ + "\r\n" + body_;
+        const StringView head = generateHead();
+        std::string response(head.data(), head.size());
+        return response.append(body_);
     }
 };
 
 template<class T>
 const std::string ResponseWriter<T>::kProtocolVersion = "HTTP/1.1";
 
+template<class T>
+const std::size_t ResponseWriter<T>::kHeadFixedSize;
+
 #endif
@@ -1,139 +1,122 @@
 #include "status.hpp"
 
+namespace {
+    // 定義済みのステータスコードはこれより小さい
+    const int kStatusCodeLimit = 600;
+    // "HTTP/1.1 " + 3 桁のステータスコード + " "
+    const std::size_t kReasonPhraseOffset = 13;
+
+    struct StatusLineEntry {
+        HttpStatusCode code;
+        const char *line;
+    };
+
+    // レスポンスの先頭にそのまま書ける status-line
+    const StatusLineEntry kStatusLineEntries[] = {
+        {kStatusContinue, "HTTP/1.1 100 Continue\r\n"},
+        {kStatusSwitchingProtocols, "HTTP/1.1 101 Switching Protocols\r\n"},
+        {kStatusProcessing, "HTTP/1.1 102 Processing\r\n"},
+        {kStatusEarlyHints, "HTTP/1.1 103 Early Hints\r\n"},
+        {kStatusOk, "HTTP/1.1 200 OK\r\n"},
+        {kStatusCreated, "HTTP/1.1 201 Created\r\n"},
+        {kStatusAccepted, "HTTP/1.1 202 Accepted\r\n"},
+        {kStatusNonAuthoritativeInformation, "HTTP/1.1 203 Non-Authoritative Information\r\n"},
+        {kStatusNoContent, "HTTP/1.1 204 No Content\r\n"},
+        {kStatusResetContent, "HTTP/1.1 205 Reset Content\r\n"},
+        {kStatusPartialContent, "HTTP/1.1 206 Partial Content\r\n"},
+        {kStatusMultiStatus, "HTTP/1.1 207 Multi-Status\r\n"},
+        {kStatusAlreadyReported, "HTTP/1.1 208 Already Reported\r\n"},
+        {kStatusImUsed, "HTTP/1.1 226 IM Used\r\n"},
+        {kStatusMultipleChoices, "HTTP/1.1 300 Multiple Choices\r\n"},
+        {kStatusMovedPermanently, "HTTP/1.1 301 Moved Permanently\r\n"},
+        {kStatusFound, "HTTP/1.1 302 Found\r\n"},
+        {kStatusSeeOther, "HTTP/1.1 303 See Other\r\n"},
+        {kStatusNotModified, "HTTP/1.1 304 Not Modified\r\n"},
+        {kStatusUseProxy, "HTTP/1.1 305 Use Proxy\r\n"},
+        {kStatusTemporaryRedirect, "HTTP/1.1 307 Temporary Redirect\r\n"},
+        {kStatusPermanentRedirect, "HTTP/1.1 308 Permanent Redirect\r\n"},
+        {kStatusBadRequest, "HTTP/1.1 400 Bad Request\r\n"},
+        {kStatusUnauthorized, "HTTP/1.1 401 Unauthorized\r\n"},
+        {kStatusPaymentRequired, "HTTP/1.1 402 Payment Required\r\n"},
+        {kStatusForbidden, "HTTP/1.1 403 Forbidden\r\n"},
+        {kStatusNotFound, "HTTP/1.1 404 Not Found\r\n"},
+        {kStatusMethodNotAllowed, "HTTP/1.1 405 Method Not Allowed\r\n"},
+        {kStatusNotAcceptable, "HTTP/1.1 406 Not Acceptable\r\n"},
+        {kStatusProxyAuthenticationRequired, "HTTP/1.1 407 Proxy Authentication Required\r\n"},
+        {kStatusRequestTimeout, "HTTP/1.1 408 Request Timeout\r\n"},
+        {kStatusConflict, "HTTP/1.1 409 Conflict\r\n"},
+        {kStatusGone, "HTTP/1.1 410 Gone\r\n"},
+        {kStatusLengthRequired, "HTTP/1.1 411 Length Required\r\n"},
+        {kStatusPreconditionFailed, "HTTP/1.1 412 Precondition Failed\r\n"},
+        {kStatusPayloadTooLarge, "HTTP/1.1 413 Payload Too Large\r\n"},
+        {kStatusUriTooLong, "HTTP/1.1 414 URI Too Long\r\n"},
+        {kStatusUnsupportedMediaType, "HTTP/1.1 415 Unsupported Media Type\r\n"},
+        {kStatusRangeNotSatisfiable, "HTTP/1.1 416 Range Not Satisfiable\r\n"},
+        {kStatusExpectationFailed, "HTTP/1.1 417 Expectation Failed\r\n"},
+        {kStatusImATeapot, "HTTP/1.1 418 I'm a teapot\r\n"},
+        {kStatusMisdirectedRequest, "HTTP/1.1 421 Misdirected Request\r\n"},
+        {kStatusUnprocessableEntity, "HTTP/1.1 422 Unprocessable Entity\r\n"},
+        {kStatusLocked, "HTTP/1.1 423 Locked\r\n"},
+        {kStatusFailedDependency, "HTTP/1.1 424 Failed Dependency\r\n"},
+        {kStatusTooEarly, "HTTP/1.1 425 Too Early\r\n"},
+        {kStatusUpgradeRequired, "HTTP/1.1 426 Upgrade Required\r\n"},
+        {kStatusPreconditionRequired, "HTTP/1.1 428 Precondition Required\r\n"},
+        {kStatusTooManyRequests, "HTTP/1.1 429 Too Many Requests\r\n"},
+        {kStatusRequestHeaderFieldsTooLarge, "HTTP/1.1 431 Request Header Fields Too Large\r\n"},
+        {kStatusUnavailableForLegalReasons, "HTTP/1.1 451 Unavailable For Legal Reasons\r\n"},
+        {kStatusInternalServerError, "HTTP/1.1 500 Internal Server Error\r\n"},
+        {kStatusNotImplemented, "HTTP/1.1 501 Not Implemented\r\n"},
+        {kStatusBadGateway, "HTTP/1.1 502 Bad Gateway\r\n"},
+        {kStatusServiceUnavailable, "HTTP/1.1 503 Service Unavailable\r\n"},
+        {kStatusGatewayTimeout, "HTTP/1.1 504 Gateway Timeout\r\n"},
+        {kStatusHttpVersionNotSupported, "HTTP/1.1 505 HTTP Version Not Supported\r\n"},
+        {kStatusVariantAlsoNegotiates, "HTTP/1.1 506 Variant Also Negotiates\r\n"},
+        {kStatusInsufficientStorage, "HTTP/1.1 507 Insufficient Storage\r\n"},
+        {kStatusLoopDetected, "HTTP/1.1 508 Loop Detected\r\n"},
+        {kStatusNotExtended, "HTTP/1.1 510 Not Extended\r\n"},
+        {kStatusNetworkAuthenticationRequired, "HTTP/1.1 511 Network Authentication Required\r\n"},
+    };
+
+    // ステータスコードから直接引けるよう, 起動時に 1 度だけ並べ替える
+    // 定義されていないコードは空
+    class StatusLineTable {
+    public:
+        StatusLineTable() {
+            for (std::size_t i = 0; i < sizeof(kStatusLineEntries) / sizeof(kStatusLineEntries[0]); i++) {
+                lines_[kStatusLineEntries[i].code] = StringView(kStatusLineEntries[i].line);
+            }
+        }
+
+        StringView get(int code) const {
+            if (code < 0 || code >= kStatusCodeLimit) {
+                return StringView();
+            }
+            return lines_[code];
+        }
+
+    private:
+        StringView lines_[kStatusCodeLimit];
+    };
+
+    const StatusLineTable kStatusLineTable;
+} // namespace
+
 HttpStatusCode httpStatusCodeFromInt(int code) {
-    switch (code) {
-        case kStatusContinue:
-        case kStatusSwitchingProtocols:
-        case kStatusProcessing:
-        case kStatusEarlyHints:
-        case kStatusOk:
-        case kStatusCreated:
-        case kStatusAccepted:
-        case kStatusNonAuthoritativeInformation:
-        case kStatusNoContent:
-        case kStatusResetContent:
-        case kStatusPartialContent:
-        case kStatusMultiStatus:
-        case kStatusAlreadyReported:
-        case kStatusImUsed:
-        case kStatusMultipleChoices:
-        case kStatusMovedPermanently:
-        case kStatusFound:
-        case kStatusSeeOther:
-        case kStatusNotModified:
-        case kStatusUseProxy:
-        case kStatusTemporaryRedirect:
-        case kStatusPermanentRedirect:
-        case kStatusBadRequest:
-        case kStatusUnauthorized:
-        case kStatusPaymentRequired:
-        case kStatusForbidden:
-        case kStatusNotFound:
-        case kStatusMethodNotAllowed:
-        case kStatusNotAcceptable:
-        case kStatusProxyAuthenticationRequired:
-        case kStatusRequestTimeout:
-        case kStatusConflict:
-        case kStatusGone:
-        case kStatusLengthRequired:
-        case kStatusPreconditionFailed:
-        case kStatusPayloadTooLarge:
-        case kStatusUriTooLong:
-        case kStatusUnsupportedMediaType:
-        case kStatusRangeNotSatisfiable:
-        case kStatusExpectationFailed:
-        case kStatusImATeapot:
-        case kStatusMisdirectedRequest:
-        case kStatusUnprocessableEntity:
-        case kStatusLocked:
-        case kStatusFailedDependency:
-        case kStatusTooEarly:
-        case kStatusUpgradeRequired:
-        case kStatusPreconditionRequired:
-        case kStatusTooManyRequests:
-        case kStatusRequestHeaderFieldsTooLarge:
-        case kStatusUnavailableForLegalReasons:
-        case kStatusInternalServerError:
-        case kStatusNotImplemented:
-        case kStatusBadGateway:
-        case kStatusServiceUnavailable:
-        case kStatusGatewayTimeout:
-        case kStatusHttpVersionNotSupported:
-        case kStatusVariantAlsoNegotiates:
-        case kStatusInsufficientStorage:
-        case kStatusLoopDetected:
-        case kStatusNotExtended:
-        case kStatusNetworkAuthenticationRequired:
-            return static_cast<HttpStatusCode>(code);
-        default:
-            return kStatusUnknown;
+    if (kStatusLineTable.get(code).empty()) {
+        return kStatusUnknown;
     }
+    return static_cast<HttpStatusCode>(code);
 }
 
 std::string getHttpStatusText(HttpStatusCode code) {
-    switch (code) {
-        case kStatusContinue: return "Continue";
-        case kStatusSwitchingProtocols: return "Switching Protocols";
-        case kStatusProcessing: return "Processing";
-        case kStatusEarlyHints: return "Early Hints";
-        case kStatusOk: return "OK";
-        case kStatusCreated: return "Created";
-        case kStatusAccepted: return "Accepted";
-        case kStatusNonAuthoritativeInformation: return "Non-Authoritative Information";
-        case kStatusNoContent: return "No Content";
-        case kStatusResetContent: return "Reset Content";
-        case kStatusPartialContent: return "Partial Content";
-        case kStatusMultiStatus: return "Multi-Status";
-        case kStatusAlreadyReported: return "Already Reported";
-        case kStatusImUsed: return "IM Used";
-        case kStatusMultipleChoices: return "Multiple Choices";
-        case kStatusMovedPermanently: return "Moved Permanently";
-        case kStatusFound: return "Found";
-        case kStatusSeeOther: return "See Other";
-        case kStatusNotModified: return "Not Modified";
-        case kStatusUseProxy: return "Use Proxy";
-        case kStatusTemporaryRedirect: return "Temporary Redirect";
-        case kStatusPermanentRedirect: return "Permanent Redirect";
-        case kStatusBadRequest: return "Bad Request";
-        case kStatusUnauthorized: return "Unauthorized";
-        case kStatusPaymentRequired: return "Payment Required";
-        case kStatusForbidden: return "Forbidden";
-        case kStatusNotFound: return "Not Found";
-        case kStatusMethodNotAllowed: return "Method Not Allowed";
-        case kStatusNotAcceptable: return "Not Acceptable";
-        case kStatusProxyAuthenticationRequired: return "Proxy Authentication Required";
-        case kStatusRequestTimeout: return "Request Timeout";
-        case kStatusConflict: return "Conflict";
-        case kStatusGone: return "Gone";
-        case kStatusLengthRequired: return "Length Required";
-        case kStatusPreconditionFailed: return "Precondition Failed";
-        case kStatusPayloadTooLarge: return "Payload Too Large";
-        case kStatusUriTooLong: return "URI Too Long";
-        case kStatusUnsupportedMediaType: return "Unsupported Media Type";
-        case kStatusRangeNotSatisfiable: return "Range Not Satisfiable";
-        case kStatusExpectationFailed: return "Expectation Failed";
-        case kStatusImATeapot: return "I'm a teapot";
-        case kStatusMisdirectedRequest: return "Misdirected Request";
-        case kStatusUnprocessableEntity: return "Unprocessable Entity";
-        case kStatusLocked: return "Locked";
-        case kStatusFailedDependency: return "Failed Dependency";
-        case kStatusTooEarly: return "Too Early";
-        case kStatusUpgradeRequired: return "Upgrade Required";
-        case kStatusPreconditionRequired: return "Precondition Required";
-        case kStatusTooManyRequests: return "Too Many Requests";
-        case kStatusRequestHeaderFieldsTooLarge: return "Request Header Fields Too Large";
-        case kStatusUnavailableForLegalReasons: return "Unavailable For Legal Reasons";
-        case kStatusInternalServerError: return "Internal Server Error";
-        case kStatusNotImplemented: return "Not Implemented";
-        case kStatusBadGateway: return "Bad Gateway";
-        case kStatusServiceUnavailable: return "Service Unavailable";
-        case kStatusGatewayTimeout: return "Gateway Timeout";
-        case kStatusHttpVersionNotSupported: return "HTTP Version Not Supported";
-        case kStatusVariantAlsoNegotiates: return "Variant Also Negotiates";
-        case kStatusInsufficientStorage: return "Insufficient Storage";
-        case kStatusLoopDetected: return "Loop Detected";
-        case kStatusNotExtended: return "Not Extended";
-        case kStatusNetworkAuthenticationRequired: return "Network Authentication Required";
-        default: return "";
+    const StringView line = kStatusLineTable.get(code);
+    if (line.empty()) {
+        return "";
     }
+    // 末尾の CRLF を除く
+    return line.substr(kReasonPhraseOffset, line.size() - kReasonPhraseOffset - 2).toString();
+}
+
+StringView getHttpStatusLine(HttpStatusCode code) {
+    return kStatusLineTable.get(code);
 }
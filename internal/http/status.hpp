@@ -1,6 +1,7 @@
 #ifndef INTERNAL_HTTP_STATUS_HPP
 #define INTERNAL_HTTP_STATUS_HPP
 
+#include "utils/string_view.hpp"
 #include <string>
 
 enum HttpStatusCode {
@@ -81,5 +82,8 @@ enum HttpStatusCode {
 
 HttpStatusCode httpStatusCodeFromInt(int code);
 std::string getHttpStatusText(HttpStatusCode code);
+// "HTTP/1.1 200 OK\r\n" including the CRLF, or an empty view if code is not defined
+// Points to static storage, so no formatting is needed for each response
+StringView getHttpStatusLine(HttpStatusCode code);
 
 #endif //INTERNAL_HTTP_STATUS_HPP
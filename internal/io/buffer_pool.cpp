@@ -0,0 +1,36 @@
+#include "buffer_pool.hpp"
+
+BufferPool::BufferPool(std::size_t buffer_size, std::size_t max_free) : buffer_size_(buffer_size), max_free_(max_free) {
+    free_.reserve(max_free_);
+}
+
+BufferPool::~BufferPool() {
+    for (std::size_t i = 0; i < free_.size(); i++) {
+        delete[] free_[i];
+    }
+}
+
+char *BufferPool::acquire() {
+    if (free_.empty()) {
+        return new char[buffer_size_];
+    }
+    char *buf = free_.back();
+    free_.pop_back();
+    return buf;
+}
+
+void BufferPool::release(char *buf) {
+    if (free_.size() >= max_free_) {
+        delete[] buf;
+        return;
+    }
+    free_.push_back(buf);
+}
+
+std::size_t BufferPool::bufferSize() const {
+    return buffer_size_;
+}
+
+std::size_t BufferPool::available() const {
+    return free_.size();
+}
@@ -0,0 +1,36 @@
+#ifndef INTERNAL_IO_BUFFER_POOL_HPP
+#define INTERNAL_IO_BUFFER_POOL_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Fixed-size read buffers shared by the connections of one worker
+// A BufferedReader borrows a buffer only while it has unconsumed bytes,
+// so idle keep-alive connections hold no buffer memory
+// At most max_free returned buffers are kept, and the rest are deleted
+// Not thread-safe. Must outlive the readers borrowing from it
+class BufferPool {
+public:
+    static const std::size_t kDefaultMaxFree = 256;
+
+    explicit BufferPool(std::size_t buffer_size, std::size_t max_free = kDefaultMaxFree);
+    ~BufferPool();
+    // Returns a buffer of bufferSize() bytes
+    char *acquire();
+    // buf must have been acquired from this pool
+    void release(char *buf);
+    std::size_t bufferSize() const;
+    // Number of returned buffers waiting for reuse
+    std::size_t available() const;
+
+private:
+    std::size_t buffer_size_;
+    std::size_t max_free_;
+    // Free list. Its capacity is reserved up front so that release() does not allocate
+    std::vector<char *> free_;
+
+    BufferPool(const BufferPool &other);
+    BufferPool &operator=(const BufferPool &other);
+};
+
+#endif //INTERNAL_IO_BUFFER_POOL_HPP
@@ -0,0 +1,50 @@
+#include "line_reader.hpp"
+
+CrlfLineReader::CrlfLineReader(std::size_t max_size) : max_size_(max_size), too_long_(false) {}
+
+// NOTE: 区切りを LF にすることで, CRLF が 2 回の read にまたがる場合も正しく扱う
+Result<Option<StringView>, std::string> CrlfLineReader::readLine(IBufferedReader &reader) {
+    StringView line = TRY(reader.readLineView("\n"));
+    // リーダーのバッファが一杯になると行は分割されて返るので, つないだ長さで上限を見る
+    if (max_size_ > 0 && line_.size() + line.size() > max_size_) {
+        too_long_ = true;
+        return Err<std::string>("line is longer than the limit");
+    }
+    // 行が呼び出しをまたぐ場合だけコピーする
+    if (!line_.empty() || !line.endsWith("\n")) {
+        line_.append(line.data(), line.size());
+        if (!StringView(line_).endsWith("\n")) {
+            if (reader.eof()) {
+                return Err<std::string>("connection closed before line ends with CRLF");
+            }
+            return Ok<Option<StringView> >(None);
+        }
+        completed_line_.swap(line_);
+        line_.clear();
+        line = StringView(completed_line_);
+    }
+    if (!line.endsWith("\r\n")) {
+        return Err<std::string>("line does not end with CRLF");
+    }
+
+    line.removeSuffix(2); // remove CRLF
+    return Ok<Option<StringView> >(Some(line));
+}
+
+bool CrlfLineReader::hasPartialLine() const {
+    return !line_.empty();
+}
+
+bool CrlfLineReader::isTooLong() const {
+    return too_long_;
+}
+
+void CrlfLineReader::setMaxSize(std::size_t max_size) {
+    max_size_ = max_size;
+}
+
+void CrlfLineReader::reset() {
+    too_long_ = false;
+    line_.clear();
+    completed_line_.clear();
+}
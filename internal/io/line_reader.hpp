@@ -0,0 +1,36 @@
+#ifndef INTERNAL_IO_LINE_READER_HPP
+#define INTERNAL_IO_LINE_READER_HPP
+
+#include "reader.hpp"
+#include "utils/option.hpp"
+#include "utils/result.hpp"
+#include "utils/string_view.hpp"
+#include <string>
+
+// Reads CRLF-terminated lines from a non-blocking reader, resuming a line across calls
+// A line received at once is viewed in the reader's buffer, and only a line split across reads is copied
+// A line longer than the max size fails as soon as the excess arrives, so that it is not buffered without bound
+class CrlfLineReader {
+public:
+    // max_size is the max length of a line including CRLF, 0 for no limit
+    explicit CrlfLineReader(std::size_t max_size = 0);
+    // Returns the line without CRLF, or None if no more data is available before the line ends
+    // The view is valid until the next call to the reader or to this object
+    Result<Option<StringView>, std::string> readLine(IBufferedReader &reader);
+    // Whether part of a line has been received
+    bool hasPartialLine() const;
+    // Whether readLine() failed because the line is longer than the max size
+    bool isTooLong() const;
+    void setMaxSize(std::size_t max_size);
+    void reset();
+
+private:
+    std::size_t max_size_;
+    bool too_long_;
+    // Line received so far, kept across calls until CRLF arrives
+    std::string line_;
+    // line_ once CRLF arrived, kept while the line is being used
+    std::string completed_line_;
+};
+
+#endif //INTERNAL_IO_LINE_READER_HPP
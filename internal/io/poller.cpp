@@ -0,0 +1,170 @@
+#include "poller.hpp"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <sys/event.h>
+#include <sys/time.h>
+#endif
+
+namespace {
+    types::Err<std::string> errnoToErr(const std::string &what) {
+        return Err(what + ": " + std::strerror(errno));
+    }
+} // namespace
+
+#if defined(__linux__)
+
+namespace {
+    uint32_t toEpollEvents(unsigned int events) {
+        uint32_t epoll_events = 0;
+        if (events & kEventRead) {
+            epoll_events |= EPOLLIN;
+        }
+        if (events & kEventWrite) {
+            epoll_events |= EPOLLOUT;
+        }
+#ifdef EPOLLEXCLUSIVE
+        if (events & kEventExclusive) {
+            epoll_events |= EPOLLEXCLUSIVE;
+        }
+#endif
+        return epoll_events;
+    }
+
+    unsigned int fromEpollEvents(uint32_t epoll_events) {
+        unsigned int events = kEventNone;
+        if (epoll_events & EPOLLIN) {
+            events |= kEventRead;
+        }
+        if (epoll_events & EPOLLOUT) {
+            events |= kEventWrite;
+        }
+        if (epoll_events & (EPOLLERR | EPOLLHUP)) {
+            events |= kEventError;
+        }
+        return events;
+    }
+
+    Result<types::Unit, std::string> control(int epoll_fd, int op, int fd, unsigned int events) {
+        struct epoll_event ev = {};
+        ev.events = toEpollEvents(events);
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd, op, fd, &ev) == -1) {
+            return errnoToErr("epoll_ctl");
+        }
+        return Ok(unit);
+    }
+} // namespace
+
+Poller::Poller() : fd_(epoll_create1(EPOLL_CLOEXEC)) {}
+
+Result<types::Unit, std::string> Poller::add(int fd, unsigned int events) {
+    return control(fd_, EPOLL_CTL_ADD, fd, events);
+}
+
+Result<types::Unit, std::string> Poller::modify(int fd, unsigned int events) {
+    return control(fd_, EPOLL_CTL_MOD, fd, events);
+}
+
+Result<types::Unit, std::string> Poller::remove(int fd) {
+    return control(fd_, EPOLL_CTL_DEL, fd, kEventNone);
+}
+
+Result<types::Unit, std::string> Poller::wait(std::vector<Event> &ready, int timeout_ms) {
+    ready.clear();
+    struct epoll_event evs[kMaxEventsPerWait];
+    const int n = epoll_wait(fd_, evs, kMaxEventsPerWait, timeout_ms);
+    if (n == -1) {
+        // シグナルによる中断はエラーとして扱わない
+        if (errno == EINTR) {
+            return Ok(unit);
+        }
+        return errnoToErr("epoll_wait");
+    }
+    for (int i = 0; i < n; i++) {
+        const Event ev = {evs[i].data.fd, fromEpollEvents(evs[i].events)};
+        ready.push_back(ev);
+    }
+    return Ok(unit);
+}
+
+#else
+
+namespace {
+    // filter の登録・解除を 1 つずつ行う
+    // 解除時に登録されていない filter (ENOENT) は無視する
+    Result<types::Unit, std::string> control(int kqueue_fd, int fd, short filter, unsigned short flags) {
+        struct kevent change;
+        EV_SET(&change, fd, filter, flags, 0, 0, NULL);
+        if (kevent(kqueue_fd, &change, 1, NULL, 0, NULL) == -1) {
+            if ((flags & EV_DELETE) && errno == ENOENT) {
+                return Ok(unit);
+            }
+            return errnoToErr("kevent");
+        }
+        return Ok(unit);
+    }
+} // namespace
+
+Poller::Poller() : fd_(kqueue()) {}
+
+Result<types::Unit, std::string> Poller::add(int fd, unsigned int events) {
+    return modify(fd, events);
+}
+
+Result<types::Unit, std::string> Poller::modify(int fd, unsigned int events) {
+    TRY(control(fd_, fd, EVFILT_READ, (events & kEventRead) ? EV_ADD : EV_DELETE));
+    TRY(control(fd_, fd, EVFILT_WRITE, (events & kEventWrite) ? EV_ADD : EV_DELETE));
+    return Ok(unit);
+}
+
+Result<types::Unit, std::string> Poller::remove(int fd) {
+    return modify(fd, kEventNone);
+}
+
+Result<types::Unit, std::string> Poller::wait(std::vector<Event> &ready, int timeout_ms) {
+    ready.clear();
+    struct kevent evs[kMaxEventsPerWait];
+    struct timespec timeout = {};
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000 * 1000;
+    const int n = kevent(fd_, NULL, 0, evs, kMaxEventsPerWait, timeout_ms < 0 ? NULL : &timeout);
+    if (n == -1) {
+        // シグナルによる中断はエラーとして扱わない
+        if (errno == EINTR) {
+            return Ok(unit);
+        }
+        return errnoToErr("kevent");
+    }
+    for (int i = 0; i < n; i++) {
+        unsigned int events = kEventNone;
+        if (evs[i].filter == EVFILT_READ) {
+            events |= kEventRead;
+        }
+        if (evs[i].filter == EVFILT_WRITE) {
+            events |= kEventWrite;
+        }
+        if (evs[i].flags & EV_ERROR) {
+            events |= kEventError;
+        }
+        const Event ev = {static_cast<int>(evs[i].ident), events};
+        ready.push_back(ev);
+    }
+    return Ok(unit);
+}
+
+#endif
+
+Poller::~Poller() {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+bool Poller::isValid() const {
+    return fd_ != -1;
+}
@@ -0,0 +1,52 @@
+#ifndef INTERNAL_IO_POLLER_HPP
+#define INTERNAL_IO_POLLER_HPP
+
+#include "utils/result.hpp"
+#include "utils/unit.hpp"
+#include <string>
+#include <vector>
+
+// Readiness events a task can be interested in
+// Combined as a bit set, e.g. kEventRead | kEventWrite
+enum IOEvent {
+    kEventNone = 0,
+    kEventRead = 1 << 0,
+    kEventWrite = 1 << 1,
+    // Error or hang-up on the fd. Always reported, cannot be subscribed to
+    kEventError = 1 << 2,
+    // Wake only one of the pollers waiting on an fd shared between processes, e.g. a listening socket
+    // EPOLLEXCLUSIVE on Linux, ignored elsewhere. The interest of such an fd cannot be modified
+    kEventExclusive = 1 << 3,
+};
+
+// Thin wrapper over the readiness API of the platform
+// epoll on Linux, kqueue on BSD / macOS
+class Poller {
+public:
+    struct Event {
+        int fd;
+        unsigned int events;
+    };
+
+    Poller();
+    ~Poller();
+
+    // False if the kernel object could not be created
+    bool isValid() const;
+    Result<types::Unit, std::string> add(int fd, unsigned int events);
+    Result<types::Unit, std::string> modify(int fd, unsigned int events);
+    Result<types::Unit, std::string> remove(int fd);
+    // Block until at least one fd is ready or timeout_ms elapses (-1 blocks forever)
+    // ready is cleared and filled with the ready fds
+    Result<types::Unit, std::string> wait(std::vector<Event> &ready, int timeout_ms);
+
+private:
+    static const int kMaxEventsPerWait = 256;
+    int fd_;
+
+    // Owns a kernel object, so copying is not allowed
+    Poller(const Poller &other);
+    Poller &operator=(const Poller &other);
+};
+
+#endif //INTERNAL_IO_POLLER_HPP
@@ -1,4 +1,6 @@
 #include "reader.hpp"
+#include "utils/byte_search.hpp"
+#include <algorithm>
 #include <cstring>
 #include <unistd.h>
 
@@ -13,8 +15,16 @@ FdReader::~FdReader() {
 }
 
 Result<std::size_t, std::string> FdReader::read(char *buf, const std::size_t n) {
-    ssize_t bytes_read = ::read(fd_, buf, n);
+    ssize_t bytes_read;
+    // シグナルによる中断はエラーとして扱わず読み直す
+    do {
+        bytes_read = ::read(fd_, buf, n);
+    } while (bytes_read == -1 && errno == EINTR);
     if (bytes_read == -1) {
+        // ノンブロッキングな fd で今読めるデータがない場合は EOF ではない 0 バイトとして扱う
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return Ok<std::size_t>(0);
+        }
         return Err(std::string(std::strerror(errno)));
     }
     if (bytes_read == 0) {
@@ -27,18 +37,57 @@ bool FdReader::eof() const {
     return eof_;
 }
 
-BufferedReader::BufferedReader(IReader *reader, Ownership ownership)
-    : reader_(reader), ownership_(ownership), buf_size_(kDefaultBufferSize), buf_read_pos_(0), buf_write_pos_(0) {
-    buf_ = new char[buf_size_];
+void FdReader::reset(int fd) {
+    fd_ = fd;
+    eof_ = false;
 }
 
+BufferedReader::BufferedReader(IReader *reader, Ownership ownership)
+    : reader_(reader),
+      ownership_(ownership),
+      pool_(NULL),
+      buf_(NULL),
+      buf_size_(kDefaultBufferSize),
+      initial_buf_size_(kDefaultBufferSize),
+      max_buf_size_(kDefaultBufferSize),
+      buf_read_pos_(0),
+      buf_write_pos_(0) {}
+
 BufferedReader::BufferedReader(IReader *reader, std::size_t buffer_size, Ownership ownership)
-    : reader_(reader), ownership_(ownership), buf_size_(buffer_size), buf_read_pos_(0), buf_write_pos_(0) {
-    buf_ = new char[buf_size_];
-}
+    : reader_(reader),
+      ownership_(ownership),
+      pool_(NULL),
+      buf_(NULL),
+      buf_size_(buffer_size),
+      initial_buf_size_(buffer_size),
+      max_buf_size_(buffer_size),
+      buf_read_pos_(0),
+      buf_write_pos_(0) {}
+
+BufferedReader::BufferedReader(IReader *reader, std::size_t buffer_size, std::size_t max_buffer_size, Ownership ownership)
+    : reader_(reader),
+      ownership_(ownership),
+      pool_(NULL),
+      buf_(NULL),
+      buf_size_(buffer_size),
+      initial_buf_size_(buffer_size),
+      max_buf_size_(std::max(buffer_size, max_buffer_size)),
+      buf_read_pos_(0),
+      buf_write_pos_(0) {}
+
+BufferedReader::BufferedReader(IReader *reader, std::size_t buffer_size, std::size_t max_buffer_size, BufferPool *pool, Ownership ownership)
+    : reader_(reader),
+      ownership_(ownership),
+      pool_(pool),
+      buf_(NULL),
+      buf_size_(buffer_size),
+      initial_buf_size_(buffer_size),
+      max_buf_size_(std::max(buffer_size, max_buffer_size)),
+      buf_read_pos_(0),
+      buf_write_pos_(0) {}
 
 BufferedReader::~BufferedReader() {
-    delete[] buf_;
+    releaseBuffer();
     if (ownership_ == kOwnMove) {
         delete reader_;
     }
@@ -67,16 +116,37 @@ Result<std::size_t, std::string> BufferedReader::read(char *buf, const std::size
 }
 
 Result<std::string, std::string> BufferedReader::readLine(const std::string &delimiter) {
-    std::string line;
+    return Ok(TRY(readLineView(delimiter)).toString());
+}
+
+Result<StringView, std::string> BufferedReader::readLineView(const std::string &delimiter) {
+    if (buf_read_pos_ == buf_write_pos_ && TRY(fillBuffer()) == 0) {
+        return Ok(StringView());
+    }
+
+    std::size_t search_pos = buf_read_pos_;
     while (true) {
-        line += TRY(readLineFromBuffer(delimiter));
-        if (utils::endsWith(line, delimiter) || eof()) {
+        const char *line_end = utils::searchBytes(buf_ + search_pos, buf_write_pos_ - search_pos, delimiter.data(), delimiter.size());
+        if (line_end != NULL) {
+            const StringView line(buf_ + buf_read_pos_, line_end - (buf_ + buf_read_pos_) + delimiter.size());
+            buf_read_pos_ += line.size();
+            return Ok(line);
+        }
+        // ノンブロッキングな fd で今読めるデータがない場合は, 区切り文字までたどり着いていない行を返す
+        if (reader_->eof() || !makeRoom()) {
+            break;
+        }
+        // 区切り文字が読み込みをまたぐ場合に備え, 探し終えた末尾の数バイトから探し直す
+        const std::size_t searched = buf_write_pos_ - buf_read_pos_;
+        const std::size_t overlap = std::min(searched, delimiter.empty() ? 0 : delimiter.size() - 1);
+        search_pos = buf_write_pos_ - overlap;
+        if (TRY(fillBuffer()) == 0) {
             break;
         }
-
-        TRY(fillBuffer());
     }
 
+    const StringView line(buf_ + buf_read_pos_, buf_write_pos_ - buf_read_pos_);
+    buf_read_pos_ = buf_write_pos_;
     return Ok(line);
 }
 
@@ -84,31 +154,99 @@ bool BufferedReader::eof() const {
     return reader_->eof() && buf_read_pos_ == buf_write_pos_;
 }
 
+std::size_t BufferedReader::buffered() const {
+    return buf_write_pos_ - buf_read_pos_;
+}
+
+void BufferedReader::reset() {
+    buf_read_pos_ = 0;
+    buf_write_pos_ = 0;
+    if (pool_ != NULL || buf_size_ != initial_buf_size_) {
+        releaseBuffer();
+    }
+}
+
+void BufferedReader::releaseIdleBuffer() {
+    if (pool_ != NULL && buf_read_pos_ == buf_write_pos_) {
+        releaseBuffer();
+    }
+}
+
+// バッファの末尾の空きに読み込む. 空なら先頭から使う
 Result<std::size_t, std::string> BufferedReader::fillBuffer() {
-    buf_write_pos_ = TRY(reader_->read(buf_, buf_size_));
+    if (buf_read_pos_ == buf_write_pos_) {
+        buf_read_pos_ = 0;
+        buf_write_pos_ = 0;
+    }
+    if (buf_ == NULL) {
+        buf_ = allocateBuffer(buf_size_);
+    }
+    const Result<std::size_t, std::string> bytes_read = reader_->read(buf_ + buf_write_pos_, buf_size_ - buf_write_pos_);
+    if (bytes_read.isOk()) {
+        buf_write_pos_ += bytes_read.unwrap();
+    }
+    // 空のまま次の readiness を待つ間はバッファを持たない
+    if (pool_ != NULL && buf_write_pos_ == 0) {
+        releaseBuffer();
+    }
+    return bytes_read;
+}
+
+// 読み込み途中の行の後ろに空きを作る. バッファが上限まで埋まっていれば false
+// 行を先頭に詰めるのは, 読み終えた領域の方が末尾の空きより大きいときだけにして, コピーを抑える
+bool BufferedReader::makeRoom() {
+    const std::size_t free_space = buf_size_ - buf_write_pos_;
+    if (buf_read_pos_ > 0 && buf_read_pos_ >= free_space) {
+        std::memmove(buf_, buf_ + buf_read_pos_, buf_write_pos_ - buf_read_pos_);
+        buf_write_pos_ -= buf_read_pos_;
+        buf_read_pos_ = 0;
+        return true;
+    }
+    if (free_space > 0) {
+        return true;
+    }
+    if (buf_size_ >= max_buf_size_) {
+        return false;
+    }
+    resize(std::min(buf_size_ * 2, max_buf_size_));
+    return true;
+}
+
+// バッファされているバイトは先頭に詰めて引き継ぐ
+void BufferedReader::resize(std::size_t size) {
+    const std::size_t buffered_bytes = buf_write_pos_ - buf_read_pos_;
+    char *buf = allocateBuffer(size);
+    std::memcpy(buf, buf_ + buf_read_pos_, buffered_bytes);
+    freeBuffer(buf_, buf_size_);
+    buf_ = buf;
+    buf_size_ = size;
     buf_read_pos_ = 0;
-    return Ok(buf_write_pos_);
+    buf_write_pos_ = buffered_bytes;
 }
 
-Result<std::string, std::string> BufferedReader::readLineFromBuffer(const std::string &delimiter) {
-    if (buf_read_pos_ >= buf_write_pos_) {
-        return Ok<std::string>("");
+// プールのバッファと同じ大きさのものだけをプールから借りる. 大きくしたバッファは個別に確保する
+char *BufferedReader::allocateBuffer(std::size_t size) {
+    if (pool_ != NULL && size == pool_->bufferSize()) {
+        return pool_->acquire();
     }
+    return new char[size];
+}
 
-    const char *line_start = buf_ + buf_read_pos_;
-    const std::size_t buf_bytes_left = buf_write_pos_ - buf_read_pos_;
-    const Option<char *> search_result = utils::strnstr(line_start, delimiter.c_str(), buf_bytes_left);
-    if (search_result.isNone()) {
-        // If the delimiter is not found, return the entire buffer
-        const std::string line(line_start, buf_bytes_left);
-        buf_read_pos_ = buf_write_pos_;
-        return Ok(line);
+void BufferedReader::freeBuffer(char *buf, std::size_t size) {
+    if (pool_ != NULL && size == pool_->bufferSize()) {
+        pool_->release(buf);
+    } else {
+        delete[] buf;
     }
+}
 
-    // If the delimiter is found, return the line up to the delimiter
-    const char *line_end = search_result.unwrap();
-    const std::size_t line_length = line_end - line_start + delimiter.size();
-    std::string line(line_start, line_length);
-    buf_read_pos_ += line_length;
-    return Ok(line);
+// バッファされているバイトは捨てる
+void BufferedReader::releaseBuffer() {
+    if (buf_ != NULL) {
+        freeBuffer(buf_, buf_size_);
+        buf_ = NULL;
+    }
+    buf_size_ = initial_buf_size_;
+    buf_read_pos_ = 0;
+    buf_write_pos_ = 0;
 }
@@ -1,8 +1,10 @@
 #ifndef INTERNAL_IO_READER_HPP
 #define INTERNAL_IO_READER_HPP
 
+#include "buffer_pool.hpp"
 #include "utils/ownership.hpp"
 #include "utils/result.hpp"
+#include "utils/string_view.hpp"
 #include "utils/utils.hpp"
 #include <cerrno>
 #include <string>
@@ -12,6 +14,7 @@ public:
     virtual ~IReader();
     // Read up to n bytes into buf
     // Return the number of bytes read, or an error if one occurred
+    // 0 without eof() means no data is available right now (non-blocking fd)
     virtual Result<std::size_t, std::string> read(char *buf, std::size_t n) = 0;
     virtual bool eof() const = 0;
 };
@@ -24,6 +27,8 @@ public:
 
     virtual Result<std::size_t, std::string> read(char *buf, std::size_t n);
     virtual bool eof() const;
+    // Read from another fd, which is owned the same way as the previous one
+    void reset(int fd);
 
 private:
     int fd_;
@@ -33,31 +38,64 @@ private:
 
 class IBufferedReader : public IReader {
 public:
+    // Read up to and including the delimiter
+    // The line is returned without the delimiter if eof is reached or no more data is available right now
     virtual Result<std::string, std::string> readLine(const std::string &delimiter) = 0;
+    // Same as readLine, but returns a view instead of a copy
+    // The view is valid until the next call to any method of the reader
+    virtual Result<StringView, std::string> readLineView(const std::string &delimiter) = 0;
 };
 
+// Keeps unconsumed bytes in place and reads into the free space after them
+// A line that does not fit is moved to the front of the buffer, or the buffer grows up to max_buffer_size
+// The buffer is allocated on the first read
 class BufferedReader : public IBufferedReader {
 public:
     explicit BufferedReader(IReader *reader, Ownership ownership = kOwnBorrow);
     explicit BufferedReader(IReader *reader, std::size_t buffer_size, Ownership ownership = kOwnBorrow);
+    BufferedReader(IReader *reader, std::size_t buffer_size, std::size_t max_buffer_size, Ownership ownership = kOwnBorrow);
+    // If pool is not NULL, a buffer of pool->bufferSize() bytes is borrowed from pool,
+    // and returned whenever it is drained and the underlying reader has no more data right now
+    BufferedReader(IReader *reader, std::size_t buffer_size, std::size_t max_buffer_size, BufferPool *pool, Ownership ownership = kOwnBorrow);
     // Delete the reader if ownership is kOwn
     virtual ~BufferedReader();
 
     virtual Result<std::size_t, std::string> read(char *buf, std::size_t n);
     virtual Result<std::string, std::string> readLine(const std::string &delimiter);
+    // Always points into the read buffer
+    // A line longer than max_buffer_size is returned in pieces as if no more data were available
+    virtual Result<StringView, std::string> readLineView(const std::string &delimiter);
     bool eof() const;
+    // Number of bytes that can be read without reading from the underlying reader
+    std::size_t buffered() const;
+    // Discard the buffered bytes, e.g. after the underlying reader has been reset
+    // The buffer is returned to the pool, or kept for reuse and shrunk back to buffer_size if it has grown
+    void reset();
+    // Return the buffer to the pool if nothing is buffered, e.g. before waiting for the next request
+    // Views returned earlier become invalid
+    void releaseIdleBuffer();
 
 private:
     static const std::size_t kDefaultBufferSize = 4 * utils::kKiB;
     IReader *reader_;
     Ownership ownership_;
+    // NULL if buffers are not pooled
+    BufferPool *pool_;
+    // NULL until the first read, and while returned to pool_
     char *buf_;
     std::size_t buf_size_;
+    std::size_t initial_buf_size_;
+    std::size_t max_buf_size_;
+    // Bytes in [buf_read_pos_, buf_write_pos_) are buffered
     std::size_t buf_read_pos_;
     std::size_t buf_write_pos_;
 
     Result<std::size_t, std::string> fillBuffer();
-    Result<std::string, std::string> readLineFromBuffer(const std::string &delimiter);
+    bool makeRoom();
+    void resize(std::size_t size);
+    char *allocateBuffer(std::size_t size);
+    void freeBuffer(char *buf, std::size_t size);
+    void releaseBuffer();
 };
 
 #endif //INTERNAL_IO_READER_HPP
@@ -0,0 +1,192 @@
+#include "connection.hpp"
+#include "connection_pool.hpp"
+#include <unistd.h>
+
+namespace {
+    const unsigned int kMillisPerSecond = 1000;
+    // 1xx の中間レスポンスにはヘッダーもボディも付けない
+    // refs: https://datatracker.ietf.org/doc/html/rfc9110#section-15.2.1
+    const char kContinueResponse[] = "HTTP/1.1 100 Continue\r\n\r\n";
+} // namespace
+
+Connection::Connection(IOTaskManager &manager, int fd, IHandler *handler, const Config &config, ConnectionPool *pool)
+    : manager_(manager),
+      fd_(fd),
+      handler_(handler),
+      config_(config),
+      pool_(pool),
+      fd_reader_(fd),
+      reader_(&fd_reader_,
+              config.getClientHeaderBufferSize(),
+              config.getLargeClientHeaderBufferSize(),
+              pool != NULL ? &pool->buffers() : NULL),
+      ctx_(manager, fd, this),
+      reading_(NULL),
+      requests_(0),
+      keep_alive_(false) {
+    ctx_.setSendTimeout(config_.getSendTimeout() * kMillisPerSecond);
+    ctx_.setRequestBodyBuffer(config_.getClientBodyBufferSize(), config_.getClientBodyTempPath());
+}
+
+// fd は閉じたときに close されている
+Connection::~Connection() {}
+
+void Connection::start() {
+    readNextRequest();
+}
+
+Result<types::Unit, std::string> Connection::trigger(IContext *ctx) {
+    reading_ = NULL; // 読み終えたタスクはこの後マネージャーが削除する
+    requests_++;
+    const Request &request = ctx->getRequest();
+    keep_alive_ = request.isKeepAlive()
+            && config_.getKeepaliveTimeout() > 0
+            && requests_ < config_.getKeepaliveRequests();
+
+    // HTTP/1.1 は持続がデフォルトなので, 持続しない場合のみ明示する
+    // HTTP/1.0 はその逆
+    // refs: https://datatracker.ietf.org/doc/html/rfc9112#section-9.6
+    if (!keep_alive_) {
+        ctx->setHeader("Connection", "close");
+    } else if (request.httpVersion() == "HTTP/1.0") {
+        ctx->setHeader("Connection", "keep-alive");
+    }
+    // ハンドラーはレスポンスをキューに積んでから戻るので, 次のリクエストを読み始めても順序は保たれる
+    const Result<types::Unit, std::string> result = handler_->trigger(ctx);
+
+    ResponseQueue &responses = ctx_.getResponseQueue();
+    if (keep_alive_ && responses.size() < config_.getPipelineDepth()) {
+        ctx_.reset();
+        readNextRequest();
+    } else {
+        // 書き終えたら trigger() で閉じるか, 次のリクエストを読む
+        responses.flush();
+    }
+    return result;
+}
+
+// 先に読んだリクエストのレスポンスが残っていれば, 書き終えてから閉じる
+Result<types::Unit, std::string> Connection::triggerError(IContext *ctx, const std::string &error) {
+    (void) ctx;
+    (void) error;
+    reading_ = NULL;
+    ResponseQueue &responses = ctx_.getResponseQueue();
+    if (responses.size() > 0) {
+        keep_alive_ = false;
+        responses.flush();
+        return Ok(unit);
+    }
+    closeConnection();
+    return Ok(unit);
+}
+
+// 届いているリクエストを読み切ったので, それまでのレスポンスをまとめて書く
+Result<types::Unit, std::string> Connection::triggerSuspend(IContext *ctx) {
+    (void) ctx;
+    ctx_.getResponseQueue().flush();
+    return Ok(unit);
+}
+
+std::size_t Connection::maxBodySize(IContext *ctx, std::size_t max_body_size) {
+    (void) max_body_size;
+    const Request &request = ctx->getRequest();
+    const StringView target(request.path());
+    return config_.resolveClientMaxBodySize(request.header(kHeaderHost).unwrapOr(StringView()), target.substr(0, target.find('?')));
+}
+
+// 先に読んだリクエストのレスポンスより後に書かれるよう, キューに積む
+// クライアントは返事を待っているので, この後の読み込みが中断したときに書き出される
+Result<types::Unit, std::string> Connection::triggerContinue(IContext *ctx) {
+    (void) ctx;
+    ctx_.getResponseQueue().push(kContinueResponse);
+    return Ok(unit);
+}
+
+// 残りの message-body を読まないので, 接続は再利用できない
+Result<types::Unit, std::string> Connection::triggerBodyTooLarge(IContext *ctx) {
+    return triggerReject(ctx, kStatusPayloadTooLarge, "request body is larger than client_max_body_size");
+}
+
+// リクエストの続きがどこまでか分からないので, 接続は再利用できない
+Result<types::Unit, std::string> Connection::triggerReject(IContext *ctx, HttpStatusCode status, const std::string &error) {
+    (void) error;
+    reading_ = NULL;
+    requests_++;
+    keep_alive_ = false;
+    ctx->setHeader("Connection", "close");
+    ctx->text(status, "");
+    // 書き終えたら trigger() で閉じる
+    ctx_.getResponseQueue().flush();
+    return Ok(unit);
+}
+
+Result<types::Unit, std::string> Connection::triggerError(const std::string &error) {
+    (void) error;
+    closeConnection();
+    return Ok(unit);
+}
+
+Result<types::Unit, std::string> Connection::trigger() {
+    // 100 Continue を書き終えた場合など, 読み込み中のリクエストがあれば応答してから決める
+    if (reading_ != NULL) {
+        return Ok(unit);
+    }
+    if (!keep_alive_) {
+        closeConnection();
+        return Ok(unit);
+    }
+    // キューが一杯で読むのを止めていた場合は再開する
+    ctx_.reset();
+    readNextRequest();
+    return Ok(unit);
+}
+
+// 前の接続のリクエストと読み残しを捨てる
+void Connection::reopen(int fd) {
+    fd_ = fd;
+    fd_reader_.reset(fd);
+    reader_.reset();
+    ctx_.reset();
+    ctx_.setClientFd(fd);
+    requests_ = 0;
+    keep_alive_ = false;
+}
+
+void Connection::readNextRequest() {
+    // 最初のリクエストは接続直後から header のタイムアウトで待ち, 2 つ目以降は keepalive_timeout で待つ
+    ReadRequestTimeouts timeouts = {};
+    timeouts.header = config_.getClientHeaderTimeout() * kMillisPerSecond;
+    timeouts.idle = requests_ == 0 ? timeouts.header : config_.getKeepaliveTimeout() * kMillisPerSecond;
+    timeouts.body = config_.getClientBodyTimeout() * kMillisPerSecond;
+    // 次のリクエストを待つ間は読み込みバッファをプールに返しておく
+    reader_.releaseIdleBuffer();
+    // message-body の上限は, header section を読んだ後に maxBodySize() で経路ごとに決める
+    // request-line とヘッダーは ctx_ のアリーナに読み込まれ, リクエストを終えた ctx_.reset() で解放される
+    reading_ = new ReadRequest(&ctx_, this, &reader_, timeouts, kOwnBorrow, &ctx_.getArena()); // タスクの登録はコンストラクタがやる
+    // リクエストの 1 行も header section 全体も, 読み込みバッファの上限に収まるものだけ受け付ける
+    reading_->setMaxHeaderSize(config_.getLargeClientHeaderBufferSize());
+
+    // 前のリクエストと一緒に読み込まれたバイトはソケットの readiness では通知されない
+    // そのリクエストのレスポンスと一緒に書くため, キューはまだ書き出さない
+    if (reader_.buffered() > 0) {
+        manager_.markReady(fd_, kEventRead);
+    } else {
+        ctx_.getResponseQueue().flush();
+    }
+}
+
+// 呼び出し後はメンバにアクセスしてはいけない
+// 実行中のタスクは呼び出し前に reading_ やキューから外れているので, ここで削除されるのは待機中のものだけ
+void Connection::closeConnection() {
+    delete reading_;
+    reading_ = NULL;
+    ctx_.getResponseQueue().clear();
+    close(fd_);
+    fd_ = -1;
+    if (pool_ != NULL) {
+        reader_.reset();
+        pool_->release(this);
+    } else {
+        delete this;
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef INTERNAL_SERVER_CONNECTION_HPP
+#define INTERNAL_SERVER_CONNECTION_HPP
+
+#include "config/config.hpp"
+#include "handler/handler.hpp"
+#include "http/context.hpp"
+#include "io/reader.hpp"
+#include "task/io_task_manager.hpp"
+#include "task/read_request.hpp"
+#include "task/write_file.hpp"
+
+class ConnectionPool;
+
+// State of one client connection, shared by the requests served through it
+// Reads a request, lets the handler respond, and either reads the next request (keep-alive)
+// or closes the connection after the response is written
+// Pipelined requests are read while the previous responses are being written, until
+// config.getPipelineDepth() responses are queued. Responses are written in request order,
+// and those of requests that arrived together are written at once
+// Closes the connection when the client is idle, slow to send or slow to receive for longer than configured
+// A request whose message-body is larger than the client_max_body_size of its route is answered
+// with 413 without reading the body, and the connection is closed
+// So is a request rejected before the handler, e.g. with 400 for ambiguous framing, or with 414 or 431
+// for a request-line or header section longer than large_client_header_buffer_size
+// When the connection is closed, returns itself to pool, or deletes itself if pool is NULL
+// If pooled, the read buffer is borrowed from the pool only while a request is being received
+class Connection : public IReadRequestCallback, public IWriteFileCallback {
+public:
+    // Takes ownership of fd
+    Connection(IOTaskManager &manager, int fd, IHandler *handler, const Config &config, ConnectionPool *pool = NULL);
+    virtual ~Connection();
+    // Start reading the first request
+    void start();
+
+    // A request has been read
+    virtual Result<types::Unit, std::string> trigger(IContext *ctx);
+    virtual Result<types::Unit, std::string> triggerError(IContext *ctx, const std::string &error);
+    // No more request bytes are available now
+    virtual Result<types::Unit, std::string> triggerSuspend(IContext *ctx);
+    // client_max_body_size of the virtual server and route of the request
+    virtual std::size_t maxBodySize(IContext *ctx, std::size_t max_body_size);
+    virtual Result<types::Unit, std::string> triggerContinue(IContext *ctx);
+    virtual Result<types::Unit, std::string> triggerBodyTooLarge(IContext *ctx);
+    virtual Result<types::Unit, std::string> triggerReject(IContext *ctx, HttpStatusCode status, const std::string &error);
+    // The queued responses have all been written
+    virtual Result<types::Unit, std::string> trigger();
+    virtual Result<types::Unit, std::string> triggerError(const std::string &error);
+
+private:
+    friend class ConnectionPool;
+
+    IOTaskManager &manager_; // NOLINT(*-avoid-const-or-ref-data-members)
+    int fd_;
+    IHandler *handler_;
+    const Config &config_; // NOLINT(*-avoid-const-or-ref-data-members)
+    ConnectionPool *pool_;
+    FdReader fd_reader_;
+    // Kept across requests so that bytes the client sent ahead are not lost
+    BufferedReader reader_;
+    Context ctx_;
+    // The task reading the next request, NULL while not reading
+    ReadRequest *reading_;
+    // Number of requests read on this connection
+    unsigned int requests_;
+    bool keep_alive_;
+
+    // Serve another client, keeping the buffers allocated for the previous one
+    void reopen(int fd);
+    void readNextRequest();
+    void closeConnection();
+
+    Connection(const Connection &other);
+    Connection &operator=(const Connection &other);
+};
+
+#endif //INTERNAL_SERVER_CONNECTION_HPP
@@ -0,0 +1,39 @@
+#include "connection_pool.hpp"
+
+ConnectionPool::ConnectionPool(IOTaskManager &manager, IHandler *handler, const Config &config, std::size_t max_idle)
+    : manager_(manager), handler_(handler), config_(config), max_idle_(max_idle),
+      buffers_(config.getClientHeaderBufferSize(), max_idle) {
+    idle_.reserve(max_idle_);
+}
+
+ConnectionPool::~ConnectionPool() {
+    for (std::size_t i = 0; i < idle_.size(); i++) {
+        delete idle_[i];
+    }
+}
+
+Connection *ConnectionPool::acquire(int fd) {
+    if (idle_.empty()) {
+        return new Connection(manager_, fd, handler_, config_, this);
+    }
+    Connection *connection = idle_.back();
+    idle_.pop_back();
+    connection->reopen(fd);
+    return connection;
+}
+
+void ConnectionPool::release(Connection *connection) {
+    if (idle_.size() >= max_idle_) {
+        delete connection;
+        return;
+    }
+    idle_.push_back(connection);
+}
+
+std::size_t ConnectionPool::idle() const {
+    return idle_.size();
+}
+
+BufferPool &ConnectionPool::buffers() {
+    return buffers_;
+}
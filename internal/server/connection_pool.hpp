@@ -0,0 +1,44 @@
+#ifndef INTERNAL_SERVER_CONNECTION_POOL_HPP
+#define INTERNAL_SERVER_CONNECTION_POOL_HPP
+
+#include "config/config.hpp"
+#include "connection.hpp"
+#include "handler/handler.hpp"
+#include "io/buffer_pool.hpp"
+#include "task/io_task_manager.hpp"
+#include <vector>
+
+// Recycles closed Connections so that accepting a client allocates nothing once the pool is warm
+// At most max_idle closed Connections are kept, and the rest are deleted,
+// so the memory held after a burst of connections stays bounded
+// Must outlive the Connections acquired from it
+class ConnectionPool {
+public:
+    static const std::size_t kDefaultMaxIdle = 256;
+
+    ConnectionPool(IOTaskManager &manager, IHandler *handler, const Config &config, std::size_t max_idle = kDefaultMaxIdle);
+    // Delete the idle Connections
+    ~ConnectionPool();
+    // Return a Connection serving fd, which is not started yet. Takes ownership of fd
+    Connection *acquire(int fd);
+    // Called by a Connection when it has been closed
+    void release(Connection *connection);
+    // Number of closed Connections waiting for reuse
+    std::size_t idle() const;
+    // Read buffers of config.getClientHeaderBufferSize() bytes shared by the Connections
+    BufferPool &buffers();
+
+private:
+    IOTaskManager &manager_; // NOLINT(*-avoid-const-or-ref-data-members)
+    IHandler *handler_;
+    const Config &config_; // NOLINT(*-avoid-const-or-ref-data-members)
+    std::size_t max_idle_;
+    BufferPool buffers_;
+    // Free list. Its capacity is reserved up front so that release() does not allocate
+    std::vector<Connection *> idle_;
+
+    ConnectionPool(const ConnectionPool &other);
+    ConnectionPool &operator=(const ConnectionPool &other);
+};
+
+#endif //INTERNAL_SERVER_CONNECTION_POOL_HPP
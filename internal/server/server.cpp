@@ -1,11 +1,54 @@
 #include "server.hpp"
+#include "connection_pool.hpp"
 #include "task/accept.hpp"
 #include "task/io_task_manager.hpp"
 #include "utils/unit.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <ctime>
 #include <iostream>
+#include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/wait.h>
 #include <unistd.h>
+#include <vector>
+
+namespace {
+    // マスターが受け取ってワーカーに転送するシグナル
+    const int kForwardedSignals[] = {SIGTERM, SIGINT, SIGQUIT, SIGHUP, SIGUSR1, SIGUSR2};
+    const std::size_t kForwardedSignalCount = sizeof(kForwardedSignals) / sizeof(kForwardedSignals[0]);
+    // これより短い時間で終了したワーカーや fork に失敗したワーカーは, 同じ時間待ってから起動し直す
+    const unsigned int kMinWorkerLifetimeSeconds = 1;
+    const char *const kAnyAddress = "0.0.0.0";
+
+    volatile sig_atomic_t pending_signals[kForwardedSignalCount] = {};
+
+    // 他のワーカースレッドが終了したら, このスレッドのイベントループも止める
+    // パイプは読み出さないので, 1 度書かれれば全てのスレッドで読み込み可能であり続ける
+    class StopWorker : public IOTask {
+    public:
+        StopWorker(IOTaskManager &m, int fd) : IOTask(m, fd, kEventRead) {}
+
+        virtual Result<IOTaskResult, std::string> execute() {
+            manager_.stop();
+            return Ok(kTaskComplete);
+        }
+    };
+
+    // SIGCHLD は待機から戻るためだけに受け取る
+    void recordSignal(int sig) {
+        for (std::size_t i = 0; i < kForwardedSignalCount; i++) {
+            if (kForwardedSignals[i] == sig) {
+                pending_signals[i] = 1;
+            }
+        }
+    }
+} // namespace
 
 Server::Server() {
     std::cout << "Server constructor called" << std::endl;
@@ -24,42 +67,387 @@ Server &Server::operator=(const Server &other) {
     return *this;
 }
 
-Result<int, std::string> Server::createServerSocket() {
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
+// 同じ host:port の仮想サーバーは 1 つのソケットを共有し, リクエストの振り分けは Host ヘッダーで行う
+// 0.0.0.0 で待ち受けるポートに特定のアドレスを bind すると失敗するので, そのポートの他のアドレスは省く
+std::vector<VirtualServerConfig> Server::collectListenAddresses(const Config &config) {
+    const std::vector<VirtualServerConfig> &servers = config.getVirtualServers();
+    std::vector<VirtualServerConfig> listens;
+    for (std::size_t i = 0; i < servers.size(); i++) {
+        bool duplicated = false;
+        for (std::size_t j = 0; j < servers.size() && !duplicated; j++) {
+            if (servers[j].getPort() != servers[i].getPort()) {
+                continue;
+            }
+            const bool same_address = servers[j].getHost() == servers[i].getHost();
+            const bool covered = servers[j].getHost() == kAnyAddress && servers[i].getHost() != kAnyAddress;
+            // 同じアドレスは最初の仮想サーバーだけを残す
+            duplicated = covered || (same_address && j < i);
+        }
+        if (!duplicated) {
+            listens.push_back(servers[i]);
+        }
+    }
+    return listens;
+}
+
+Result<int, std::string> Server::createServerSocket(const VirtualServerConfig &listen, bool reuse_port) {
+    const std::string address = listen.getHost() + ":" + listen.getPort();
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    struct addrinfo *info = NULL;
+    const int gai_error = getaddrinfo(listen.getHost().c_str(), listen.getPort().c_str(), &hints, &info);
+    if (gai_error != 0) {
+        return Err("Error: Failed to resolve " + address + ": " + gai_strerror(gai_error) + "\n");
+    }
+    // 複数のアドレスに解決された場合は最初のものを使う
+    const int server_fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
     if (server_fd < 0) {
-        return Err<std::string>("Error: Failed to create socket\n");
+        freeaddrinfo(info);
+        return Err("Error: Failed to create socket for " + address + "\n");
+    }
+
+    const int enable = 1;
+    // 再起動時に TIME_WAIT の接続が残っていても bind できるようにする
+    if (listen.isReuseAddress() && setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0) {
+        freeaddrinfo(info);
+        close(server_fd);
+        return Err("Error: Failed to set SO_REUSEADDR on " + address + "\n");
+    }
+
+    // ワーカーごとに同じアドレスのソケットを作り, カーネルに接続を振り分けさせる
+    // NOTE: Linux 以外では振り分けられず, 最後に bind したソケットに偏ることがある
+    if (reuse_port && setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+        freeaddrinfo(info);
+        close(server_fd);
+        return Err("Error: Failed to set SO_REUSEPORT on " + address + "\n");
+    }
+
+    // 複数のワーカーで共有されるため, 他のワーカーに先に受け入れられても accept でブロックしない
+    if (fcntl(server_fd, F_SETFL, O_NONBLOCK) == -1) {
+        freeaddrinfo(info);
+        close(server_fd);
+        return Err("Error: Failed to set O_NONBLOCK on " + address + "\n");
     }
 
-    // サーバーソケットの設定
-    struct sockaddr_in addr = {};
-    const int port_num = 8080;
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port_num);
-    addr.sin_addr.s_addr = INADDR_ANY; // 0.0.0.0
+    // 以下は最適化なので, 対応していない環境では設定できなくても続ける
+#ifdef TCP_DEFER_ACCEPT
+    // リクエストが届くまで accept を遅らせ, 空の接続でワーカーを起こさない
+    const int defer_accept = static_cast<int>(listen.getDeferAccept());
+    if (defer_accept > 0) {
+        setsockopt(server_fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, &defer_accept, sizeof(defer_accept));
+    }
+#endif
+#ifdef TCP_FASTOPEN
+    // SYN に載ったリクエストを受け付け, 再接続するクライアントの 1 RTT を省く
+    const int fastopen = listen.getFastopen();
+    if (fastopen > 0) {
+        setsockopt(server_fd, IPPROTO_TCP, TCP_FASTOPEN, &fastopen, sizeof(fastopen));
+    }
+#endif
 
     // ソケットをアドレスにバインド
-    // NOLINTNEXTLINE(*-pro-type-reinterpret-cast)
-    if (bind(server_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) < 0) {
+    const int bind_result = bind(server_fd, info->ai_addr, info->ai_addrlen);
+    freeaddrinfo(info);
+    if (bind_result < 0) {
         close(server_fd);
-        return Err<std::string>("Error: Bind failed\n");
+        return Err("Error: Bind failed on " + address + "\n");
     }
 
     // 接続を待ち受ける
-    if (listen(server_fd, SOMAXCONN) < 0) {
+    if (::listen(server_fd, listen.getBacklog()) < 0) {
         close(server_fd);
-        return Err<std::string>("Error: Listen failed\n");
+        return Err("Error: Listen failed on " + address + "\n");
     }
     return Ok(server_fd);
 }
 
-Result<types::Unit, std::string> Server::start() {
+Result<std::vector<int>, std::string> Server::createServerSockets(const std::vector<VirtualServerConfig> &listens, bool reuse_port) {
+    std::vector<int> listen_fds;
+    for (std::size_t i = 0; i < listens.size(); i++) {
+        const Result<int, std::string> fd = createServerSocket(listens[i], reuse_port);
+        if (fd.isErr()) {
+            closeServerSockets(listen_fds);
+            return Err(fd.unwrapErr());
+        }
+        listen_fds.push_back(fd.unwrap());
+    }
+    return Ok(listen_fds);
+}
+
+void Server::closeServerSockets(const std::vector<int> &listen_fds) {
+    for (std::size_t i = 0; i < listen_fds.size(); i++) {
+        close(listen_fds[i]);
+    }
+}
+
+Result<types::Unit, std::string> Server::start(const Config &config) {
     std::cout << "start called ! " << std::endl;
-    int fd = createServerSocket().unwrap();
+    // 切断されたクライアントへの書き込みはシグナルで終了させず, EPIPE として扱う
+    signal(SIGPIPE, SIG_IGN);
+    const std::vector<VirtualServerConfig> listens = collectListenAddresses(config);
+    if (listens.empty()) {
+        return Err<std::string>("Error: No virtual server to listen on\n");
+    }
+    const unsigned int thread_count = std::max(config.getWorkerThreads(), 1U);
+    if (config.getWorkerProcesses() > 0) {
+        const std::vector<int> fds = TRY(createServerSockets(listens, false));
+        return runMaster(config, fds);
+    }
+    if (thread_count == 1) {
+        const std::vector<int> fds = TRY(createServerSockets(listens, false));
+        return runWorker(config, fds, -1);
+    }
+
+    // bind の失敗をスレッドの起動前に検出するため, ソケットは先に作る
+    std::vector<std::vector<int> > listen_fds;
+    for (unsigned int i = 0; i < thread_count; i++) {
+        const Result<std::vector<int>, std::string> fds = createServerSockets(listens, true);
+        if (fds.isErr()) {
+            for (std::size_t j = 0; j < listen_fds.size(); j++) {
+                closeServerSockets(listen_fds[j]);
+            }
+            return Err(fds.unwrapErr());
+        }
+        listen_fds.push_back(fds.unwrap());
+    }
+    return runWorkerThreads(config, listen_fds);
+}
+
+// listen_fds[i] を i 番目のスレッドが受け入れる
+Result<types::Unit, std::string> Server::runWorkerThreads(const Config &config, const std::vector<std::vector<int> > &listen_fds) {
+    if (listen_fds.size() == 1) {
+        return runWorker(config, listen_fds[0], -1);
+    }
+    // ワーカーはエラーでしか終了しないので, 1 つでも失敗すれば全体の失敗とする
+    // 残りのワーカーは停止用のパイプで止めてから join する
+    int stop_pipe[2];
+    if (pipe(stop_pipe) == -1) {
+        return Err<std::string>("Error: Failed to create pipe\n");
+    }
+    std::vector<Worker> workers(listen_fds.size());
+    for (std::size_t i = 0; i < workers.size(); i++) {
+        workers[i].config = &config;
+        workers[i].listen_fds = listen_fds[i];
+        workers[i].stop_read_fd = stop_pipe[0];
+        workers[i].stop_write_fd = stop_pipe[1];
+    }
 
+    Result<types::Unit, std::string> result = Ok(unit);
+    std::size_t started = 0;
+    for (; started < workers.size(); started++) {
+        if (pthread_create(&workers[started].thread, NULL, runWorkerThread, &workers[started]) != 0) {
+            result = Err<std::string>("Error: Failed to create worker thread\n");
+            notifyStop(stop_pipe[1]);
+            break;
+        }
+    }
+    for (std::size_t i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (workers[i].result.isErr()) {
+            result = workers[i].result;
+        }
+    }
+    close(stop_pipe[0]);
+    close(stop_pipe[1]);
+    return result;
+}
+
+// マスターは接続を扱わず, ワーカーの監視とシグナルの転送だけを行う
+// シグナルはハンドラでフラグを立てるだけにし, 待つ間以外はブロックしておく
+// ワーカーの再起動は待たずに予定だけ立て, その時刻まで待機の時間を区切る
+Result<types::Unit, std::string> Server::runMaster(const Config &config, const std::vector<int> &listen_fds) {
+    sigset_t handled;
+    sigemptyset(&handled);
+    sigaddset(&handled, SIGCHLD);
+    for (std::size_t i = 0; i < kForwardedSignalCount; i++) {
+        sigaddset(&handled, kForwardedSignals[i]);
+    }
+    sigset_t original_mask;
+    if (sigprocmask(SIG_BLOCK, &handled, &original_mask) == -1) {
+        closeServerSockets(listen_fds);
+        return Err<std::string>("Error: Failed to block signals\n");
+    }
+    struct sigaction action = {};
+    action.sa_handler = recordSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGCHLD, &action, NULL);
+    for (std::size_t i = 0; i < kForwardedSignalCount; i++) {
+        sigaction(kForwardedSignals[i], &action, NULL);
+    }
+
+    std::vector<WorkerProcess> workers(config.getWorkerProcesses());
+    for (std::size_t i = 0; i < workers.size(); i++) {
+        spawnWorkerProcess(config, listen_fds, original_mask, workers[i]);
+    }
+
+    bool shutting_down = false;
+    while (true) {
+        reapWorkerProcesses(workers, shutting_down);
+        for (std::size_t i = 0; i < kForwardedSignalCount; i++) {
+            if (!pending_signals[i]) {
+                continue;
+            }
+            pending_signals[i] = 0;
+            for (std::size_t j = 0; j < workers.size(); j++) {
+                if (workers[j].pid > 0) {
+                    kill(workers[j].pid, kForwardedSignals[i]);
+                }
+            }
+            // SIGHUP などはワーカーに任せ, 終了を求めるシグナルならマスターも終わる
+            if (kForwardedSignals[i] != SIGHUP && kForwardedSignals[i] != SIGUSR1 && kForwardedSignals[i] != SIGUSR2) {
+                shutting_down = true;
+            }
+        }
+        if (shutting_down) {
+            if (countAlive(workers) == 0) {
+                break;
+            }
+            waitForSignal(original_mask, -1);
+            continue;
+        }
+        restartWorkerProcesses(config, listen_fds, original_mask, workers);
+        waitForSignal(original_mask, secondsUntilRestart(workers));
+    }
+
+    closeServerSockets(listen_fds);
+    sigprocmask(SIG_SETMASK, &original_mask, NULL);
+    return Ok(unit);
+}
+
+void Server::spawnWorkerProcess(const Config &config, const std::vector<int> &listen_fds, const sigset_t &original_mask, WorkerProcess &worker) {
+    worker.started_at = std::time(NULL);
+    // 書き出していない出力をワーカーに複製させない
+    std::cout.flush();
+    std::cerr.flush();
+    worker.pid = fork();
+    if (worker.pid == -1) {
+        // EAGAIN などは一時的なことがあるので, ワーカーを諦めずに後で再試行する
+        std::cerr << "Error: Failed to fork worker process" << std::endl;
+        worker.restart_at = worker.started_at + kMinWorkerLifetimeSeconds;
+        return;
+    }
+    if (worker.pid == 0) {
+        // ワーカーはシグナルの既定の動作で終了する
+        signal(SIGCHLD, SIG_DFL);
+        for (std::size_t i = 0; i < kForwardedSignalCount; i++) {
+            signal(kForwardedSignals[i], SIG_DFL);
+        }
+        sigprocmask(SIG_SETMASK, &original_mask, NULL);
+        const Result<types::Unit, std::string> result =
+                runWorkerThreads(config, std::vector<std::vector<int> >(std::max(config.getWorkerThreads(), 1U), listen_fds));
+        if (result.isErr()) {
+            std::cerr << result.unwrapErr();
+        }
+        // イベントループはエラーでしか終了しない
+        // マスターから引き継いだ atexit ハンドラや静的オブジェクトのデストラクタは実行しない
+        std::cout.flush();
+        std::cerr.flush();
+        _exit(1);
+    }
+}
+
+// 終了したワーカーを回収し, 終了処理中でなければ起動し直す予定を立てる
+void Server::reapWorkerProcesses(std::vector<WorkerProcess> &workers, bool shutting_down) {
+    int status = 0;
+    pid_t pid = 0;
+    const std::time_t now = std::time(NULL);
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (std::size_t i = 0; i < workers.size(); i++) {
+            if (workers[i].pid != pid) {
+                continue;
+            }
+            workers[i].pid = -1;
+            workers[i].restart_at = now;
+            if (shutting_down) {
+                break;
+            }
+            std::cerr << "Worker process " << pid << " exited, restarting" << std::endl;
+            // 起動直後に終了し続けるワーカーで fork を繰り返さない
+            if (now - workers[i].started_at < kMinWorkerLifetimeSeconds) {
+                workers[i].restart_at = now + kMinWorkerLifetimeSeconds;
+            }
+            break;
+        }
+    }
+}
+
+// 予定の時刻を過ぎたワーカーを起動する. fork に失敗したものもここで再試行される
+void Server::restartWorkerProcesses(const Config &config, const std::vector<int> &listen_fds, const sigset_t &original_mask, std::vector<WorkerProcess> &workers) {
+    const std::time_t now = std::time(NULL);
+    for (std::size_t i = 0; i < workers.size(); i++) {
+        if (workers[i].pid == -1 && workers[i].restart_at <= now) {
+            spawnWorkerProcess(config, listen_fds, original_mask, workers[i]);
+        }
+    }
+}
+
+long Server::secondsUntilRestart(const std::vector<WorkerProcess> &workers) {
+    const std::time_t now = std::time(NULL);
+    long timeout_sec = -1;
+    for (std::size_t i = 0; i < workers.size(); i++) {
+        if (workers[i].pid != -1) {
+            continue;
+        }
+        const long remaining = workers[i].restart_at > now ? static_cast<long>(workers[i].restart_at - now) : 0;
+        if (timeout_sec == -1 || remaining < timeout_sec) {
+            timeout_sec = remaining;
+        }
+    }
+    return timeout_sec;
+}
+
+// sigsuspend と同じくシグナルのブロックを解くのと待つのを不可分に行い, 時間の上限も付けられる
+void Server::waitForSignal(const sigset_t &original_mask, long timeout_sec) {
+    if (timeout_sec < 0) {
+        sigsuspend(&original_mask);
+        return;
+    }
+    struct timespec timeout = {};
+    timeout.tv_sec = timeout_sec;
+    pselect(0, NULL, NULL, NULL, &timeout, &original_mask);
+}
+
+std::size_t Server::countAlive(const std::vector<WorkerProcess> &workers) {
+    std::size_t alive = 0;
+    for (std::size_t i = 0; i < workers.size(); i++) {
+        if (workers[i].pid > 0) {
+            alive++;
+        }
+    }
+    return alive;
+}
+
+Result<types::Unit, std::string> Server::runWorker(const Config &config, const std::vector<int> &listen_fds, int stop_fd) {
     IOTaskManager m;
     Handler *handler = new Handler();
-    new Accept(m, fd, new AcceptCallback(m, handler)); // タスクの登録はコンストラクタがやる
-    m.executeTasks();
+    ConnectionPool *pool = new ConnectionPool(m, handler, config);
+    for (std::size_t i = 0; i < listen_fds.size(); i++) {
+        new Accept(m, listen_fds[i], new AcceptCallback(*pool), config.getAcceptBudget()); // タスクの登録はコンストラクタがやる
+    }
+    if (stop_fd != -1) {
+        new StopWorker(m, stop_fd);
+    }
+    const Result<types::Unit, std::string> result = m.executeTasks();
+    delete pool;
     delete handler;
-    return Ok(unit);
+    return result;
+}
+
+void *Server::runWorkerThread(void *worker) {
+    Worker *w = static_cast<Worker *>(worker);
+    w->result = runWorker(*w->config, w->listen_fds, w->stop_read_fd);
+    // 止められたのでなくても, 自分が終了したことを他のワーカーに伝える
+    notifyStop(w->stop_write_fd);
+    return NULL;
+}
+
+void Server::notifyStop(int stop_fd) {
+    const char byte = 0;
+    ssize_t written = 0;
+    do {
+        written = write(stop_fd, &byte, 1);
+    } while (written == -1 && errno == EINTR);
 }
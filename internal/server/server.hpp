@@ -1,20 +1,72 @@
 #ifndef INTERNAL_SERVER_SERVER_HPP
 #define INTERNAL_SERVER_SERVER_HPP
 
+#include "config/config.hpp"
 #include "utils/result.hpp"
 #include "utils/unit.hpp"
+#include <csignal>
+#include <ctime>
+#include <pthread.h>
 #include <string>
+#include <sys/types.h>
+#include <vector>
 
+// Listens on every distinct host:port of the virtual servers and runs config.getWorkerThreads() event loops
+// Each worker owns its IOTaskManager, listening sockets and connections, so nothing is shared on the hot path
+// The kernel distributes incoming connections among the sockets bound with SO_REUSEPORT
+// If config.getWorkerProcesses() > 0, a master process binds the listeners and forks workers sharing them
+// The master restarts workers that die and forwards signals to them
 class Server {
 public:
     Server();
     Server(const Server &other);
     ~Server();
     Server &operator=(const Server &other);
-    static Result<types::Unit, std::string> start();
+    static Result<types::Unit, std::string> start(const Config &config);
 
 private:
-    static Result<int, std::string> createServerSocket();
+    struct Worker {
+        const Config *config;
+        std::vector<int> listen_fds;
+        pthread_t thread;
+        Result<types::Unit, std::string> result;
+        // Shared by the threads. Written once any of them exits, which stops the others
+        int stop_read_fd;
+        int stop_write_fd;
+    };
+
+    struct WorkerProcess {
+        // -1 if not running
+        pid_t pid;
+        std::time_t started_at;
+        // When to start the worker again if it is not running
+        std::time_t restart_at;
+    };
+
+    // One entry per distinct host:port. The listen options are taken from the first virtual server
+    static std::vector<VirtualServerConfig> collectListenAddresses(const Config &config);
+    static Result<int, std::string> createServerSocket(const VirtualServerConfig &listen, bool reuse_port);
+    // One socket per address. Closes the already created ones on failure
+    static Result<std::vector<int>, std::string> createServerSockets(const std::vector<VirtualServerConfig> &listens, bool reuse_port);
+    static void closeServerSockets(const std::vector<int> &listen_fds);
+    // listen_fds[i] is the set of sockets accepted by the i-th thread
+    static Result<types::Unit, std::string> runWorkerThreads(const Config &config, const std::vector<std::vector<int> > &listen_fds);
+    static Result<types::Unit, std::string> runMaster(const Config &config, const std::vector<int> &listen_fds);
+    // If fork fails, the worker is retried after the back-off
+    static void spawnWorkerProcess(const Config &config, const std::vector<int> &listen_fds, const sigset_t &original_mask, WorkerProcess &worker);
+    // Mark the workers that exited and schedule their restart
+    static void reapWorkerProcesses(std::vector<WorkerProcess> &workers, bool shutting_down);
+    static void restartWorkerProcesses(const Config &config, const std::vector<int> &listen_fds, const sigset_t &original_mask, std::vector<WorkerProcess> &workers);
+    // Seconds until the next scheduled restart, -1 if every worker is running
+    static long secondsUntilRestart(const std::vector<WorkerProcess> &workers);
+    // Wait for a signal, at most timeout_sec seconds unless it is -1
+    static void waitForSignal(const sigset_t &original_mask, long timeout_sec);
+    static std::size_t countAlive(const std::vector<WorkerProcess> &workers);
+    // Run the event loop of one worker on the calling thread
+    // The loop also returns once stop_fd becomes readable, unless it is -1
+    static Result<types::Unit, std::string> runWorker(const Config &config, const std::vector<int> &listen_fds, int stop_fd);
+    static void *runWorkerThread(void *worker);
+    static void notifyStop(int stop_fd);
 };
 
 #endif
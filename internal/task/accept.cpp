@@ -1,36 +1,132 @@
 #include "accept.hpp"
-#include "http/context.hpp"
-#include "read_request.hpp"
+#include "server/connection_pool.hpp"
 #include "utils/result.hpp"
-#include <iostream>
+#include <cerrno>
+#include <fcntl.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
-Accept::Accept(IOTaskManager &m, int fd, IAcceptCallback *cb) : IOTask(m, fd), cb_(cb) {}
+const unsigned int Accept::kOutOfFdsBackoffMs;
+
+namespace {
+    // fd を使い切ったときに 1 つ空けるための予備
+    int openReserveFd() {
+        return open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+
+    // ノンブロッキングかつ close-on-exec なクライアントのソケットを受け入れる
+    int acceptNonBlocking(int listen_fd) {
+#if defined(__linux__)
+        return accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        const int client_fd = accept(listen_fd, NULL, NULL);
+        if (client_fd == -1) {
+            return -1;
+        }
+        if (fcntl(client_fd, F_SETFL, O_NONBLOCK) == -1 || fcntl(client_fd, F_SETFD, FD_CLOEXEC) == -1) {
+            close(client_fd);
+            errno = ECONNABORTED; // このクライアントだけを諦める
+            return -1;
+        }
+        return client_fd;
+#endif
+    }
+} // namespace
+
+// 複数のワーカープロセスが同じソケットを待つので, 1 つだけを起こす
+Accept::Accept(IOTaskManager &m, int fd, IAcceptCallback *cb, unsigned int budget)
+    : IOTask(m, fd, kEventRead | kEventExclusive), cb_(cb), budget_(budget == 0 ? 1 : budget), reserve_fd_(openReserveFd()), paused_(false) {}
 
 Accept::~Accept() {
     delete cb_;
+    if (reserve_fd_ != -1) {
+        close(reserve_fd_);
+    }
 }
 
+// バックログにある接続を budget_ 個まで受け入れる
+// 残りがあればソケットは readable のままなので, 次の iteration で続きを受け入れる
 Result<IOTaskResult, std::string> Accept::execute() {
-    // クライアントからの接続を受け入れる
-    int client_fd = accept(fd_, NULL, NULL);
-    if (client_fd < 0) {
-        return Err<std::string>("Error: Accept failed\n");
-    }
-    std::cout << "Client connected\n";
-    if (cb_ != NULL)
-        cb_->trigger(client_fd);
+    for (unsigned int i = 0; i < budget_; i++) {
+        const int client_fd = acceptNonBlocking(fd_);
+        if (client_fd == -1) {
+            switch (errno) {
+                // バックログが空になった, または他のワーカーが先に受け入れた
+                case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+                case EWOULDBLOCK:
+#endif
+                    return Ok(kTaskSuspend);
+                // 受け入れる前にクライアントが切断した
+                case ECONNABORTED:
+                case EINTR:
+                case EPROTO:
+                    continue;
+                case EMFILE:
+                case ENFILE:
+                    rejectConnection();
+                    return Ok(kTaskSuspend);
+                // 待ち受けソケットが壊れている
+                case EBADF:
+                case EINVAL:
+                case ENOTSOCK:
+                case EOPNOTSUPP:
+                    return Err<std::string>("Error: Accept failed\n");
+                // ENOBUFS, ENOMEM など一時的な資源不足は次の iteration で再試行する
+                default:
+                    return Ok(kTaskSuspend);
+            }
+        }
+        if (cb_ != NULL)
+            cb_->trigger(client_fd);
+    }
+    return Ok(kTaskSuspend);
+}
+
+// fd が足りずに受け入れられない接続をバックログに残すと, readable のままでイベントループが空回りする
+// 予備の fd を閉じて 1 つ受け入れ, すぐに切断する
+// 予備の fd もなければ, fd が空くまで待ち受けソケットの監視をやめる
+void Accept::rejectConnection() {
+    if (reserve_fd_ == -1) {
+        reserve_fd_ = openReserveFd();
+    }
+    if (reserve_fd_ == -1) {
+        pause();
+        return;
+    }
+    close(reserve_fd_);
+    const int client_fd = accept(fd_, NULL, NULL);
+    if (client_fd != -1) {
+        close(client_fd);
+    }
+    reserve_fd_ = openReserveFd();
+}
+
+// readable のままのソケットで空回りしないよう, マネージャーから外してタイマーだけで起きる
+void Accept::pause() {
+    if (paused_) {
+        return;
+    }
+    manager_.removeTask(this);
+    paused_ = true;
+    setTimeout(kOutOfFdsBackoffMs);
+}
+
+Result<IOTaskResult, std::string> Accept::onTimeout() {
+    if (paused_) {
+        paused_ = false;
+        manager_.addTask(this);
+    }
     return Ok(kTaskSuspend);
 }
 
 IAcceptCallback::~IAcceptCallback() {}
 
-AcceptCallback::AcceptCallback(IOTaskManager &manager, IHandler *handler) : manager_(manager), handler_(handler) {}
+AcceptCallback::AcceptCallback(ConnectionPool &pool) : pool_(pool) {}
 
 Result<types::Unit, std::string> AcceptCallback::trigger(int client_fd) {
-    new ReadRequest(
-            new Context(manager_, client_fd),
-            new ReadRequestCallback(handler_),
-            new BufferedReader(new FdReader(client_fd), kOwnMove));
+    // 接続が閉じられるときにプールに戻る
+    Connection *connection = pool_.acquire(client_fd);
+    connection->start();
     return Ok(unit);
 }
@@ -1,12 +1,13 @@
 #ifndef INTERNAL_TASK_ACCEPT_HPP
 #define INTERNAL_TASK_ACCEPT_HPP
 
-#include "handler/handler.hpp"
 #include "io_task.hpp"
 #include "io_task_manager.hpp"
 #include "utils/result.hpp"
 #include "utils/unit.hpp"
 
+class ConnectionPool;
+
 // NOLINTNEXTLINE(cppcoreguidelines-special-member-functions)
 class IAcceptCallback {
 public:
@@ -14,24 +15,40 @@ public:
     virtual Result<types::Unit, std::string> trigger(int client_fd) = 0;
 };
 
+// Serves each accepted client with a Connection from pool
 class AcceptCallback : public IAcceptCallback {
 public:
-    AcceptCallback(IOTaskManager &manager, IHandler *handler);
+    explicit AcceptCallback(ConnectionPool &pool);
     virtual Result<types::Unit, std::string> trigger(int client_fd);
 
 private:
-    IOTaskManager &manager_; // NOLINT(*-avoid-const-or-ref-data-members)
-    IHandler *handler_;
+    ConnectionPool &pool_; // NOLINT(*-avoid-const-or-ref-data-members)
 };
 
+// Accepts connections from a non-blocking listening socket
+// Each execute() accepts at most budget connections so that a burst does not starve the other tasks
 class Accept : public IOTask {
 public:
-    Accept(IOTaskManager &m, int fd, IAcceptCallback *cb);
+    static const unsigned int kDefaultBudget = 64;
+    // Milliseconds to stop accepting when out of fds and no reserve fd is left to reject with
+    static const unsigned int kOutOfFdsBackoffMs = 100;
+
+    Accept(IOTaskManager &m, int fd, IAcceptCallback *cb, unsigned int budget = kDefaultBudget);
     ~Accept();
     virtual Result<IOTaskResult, std::string> execute();
+    // Resume accepting after the back-off
+    virtual Result<IOTaskResult, std::string> onTimeout();
 
 private:
     IAcceptCallback *cb_;
+    unsigned int budget_;
+    // Kept open to be released when the process runs out of fds
+    int reserve_fd_;
+    // Whether the task is unregistered from the manager during the back-off
+    bool paused_;
+
+    void rejectConnection();
+    void pause();
 };
 
 #endif
@@ -1,10 +1,36 @@
 #include "io_task.hpp"
 #include "io_task_manager.hpp"
 
-IOTask::IOTask(IOTaskManager &m, int fd) : fd_(fd), manager_(m) {
+IOTask::IOTask(IOTaskManager &m, int fd, unsigned int events) : fd_(fd), events_(events), manager_(m), timer_(this), slot_(0) {
     m.addTask(this);
 }
 
 IOTask::~IOTask() {
     manager_.removeTask(this);
 }
+
+int IOTask::getFd() const {
+    return fd_;
+}
+
+unsigned int IOTask::getEvents() const {
+    return events_;
+}
+
+Result<IOTaskResult, std::string> IOTask::onTimeout() {
+    return Err<std::string>("timeout");
+}
+
+void IOTask::setTimeout(unsigned int timeout_ms) {
+    if (timeout_ms == 0) {
+        clearTimeout();
+        return;
+    }
+    manager_.armTimer(timer_, timeout_ms);
+}
+
+void IOTask::clearTimeout() {
+    if (timer_.isArmed()) {
+        manager_.cancelTimer(timer_);
+    }
+}
@@ -1,6 +1,8 @@
 #ifndef INTERNAL_TASK_IO_TASK_HPP
 #define INTERNAL_TASK_IO_TASK_HPP
 
+#include "io/poller.hpp"
+#include "timer_wheel.hpp"
 #include "utils/result.hpp"
 #include <string>
 
@@ -13,13 +15,32 @@ class IOTaskManager;
 
 class IOTask {
 public:
-    IOTask(IOTaskManager &m, int fd);
+    // events: the readiness (IOEvent) the task waits for before execute() is called
+    IOTask(IOTaskManager &m, int fd, unsigned int events);
     virtual ~IOTask();
     virtual Result<IOTaskResult, std::string> execute() = 0;
+    // Called when the timeout set by setTimeout() expires
+    // The task is deleted unless kTaskSuspend is returned, same as execute()
+    virtual Result<IOTaskResult, std::string> onTimeout();
+    int getFd() const;
+    unsigned int getEvents() const;
 
 protected:
     int const fd_;
+    unsigned int const events_;
     IOTaskManager &manager_; // NOLINT(*-avoid-const-or-ref-data-members)
+
+    // Call onTimeout() unless the task completes or is rearmed within timeout_ms
+    // 0 cancels the timeout
+    void setTimeout(unsigned int timeout_ms);
+    void clearTimeout();
+
+private:
+    friend class IOTaskManager;
+
+    Timer timer_;
+    // Index in the tasks of the fd, maintained by IOTaskManager
+    std::size_t slot_;
 };
 
 #endif //INTERNAL_TASK_IO_TASK_HPP
@@ -1,40 +1,237 @@
 #include "io_task_manager.hpp"
 #include <algorithm>
+#include <ctime>
+#include <time.h>
 
-IOTaskManager::IOTaskManager() {
+IOTaskManager::IOTaskManager() : timers_(monotonicMillis()), now_(monotonicMillis()), current_time_(std::time(NULL)), stopped_(false) {
 }
 
 IOTaskManager::~IOTaskManager() {
 }
 
-void IOTaskManager::executeTasks() {
-    while (true) {
-        for (unsigned long i = 0; i < tasks_.size(); i++) {
-            IOTask *task = tasks_.at(i);
-            if (task == NULL) {
-                continue;
-            }
-            Result<IOTaskResult, std::string> r = task->execute();
-            if (r.isErr()) {
-                // TODO: 適切なエラーハンドリング
-                // ログを書く, 再試行する, など
-                delete task;
-                continue;
-            }
-            if (r.unwrap() == kTaskComplete) {
-                delete task;
-            }
+Result<types::Unit, std::string> IOTaskManager::executeTasks() {
+    if (!poller_.isValid()) {
+        return Err<std::string>("Error: Failed to create poller\n");
+    }
+    stopped_ = false;
+    while (!stopped_) {
+        TRY(executeReadyTasks(kWaitForever));
+    }
+    return Ok(unit);
+}
+
+// 実行中のタスクから呼ばれるので, ループは今の iteration を終えてから抜ける
+void IOTaskManager::stop() {
+    stopped_ = true;
+}
+
+Result<types::Unit, std::string> IOTaskManager::executeReadyTasks(int timeout_ms) {
+    TRY(poller_.wait(ready_, waitTimeout(timeout_ms)));
+    now_ = monotonicMillis();
+    current_time_ = std::time(NULL);
+    timers_.advance(now_);
+    collectUnpollableWatches();
+    ready_.insert(ready_.end(), marked_ready_.begin(), marked_ready_.end());
+    marked_ready_.clear();
+
+    for (std::size_t i = 0; i < ready_.size(); i++) {
+        executeFdTasks(ready_[i].fd, ready_[i].events);
+    }
+    // 同じ iteration で読み書きが進んだタスクはタイマーを再設定・解除しているので, その後に実行する
+    executeExpiredTimers();
+    return Ok(unit);
+}
+
+// ポーリングできない fd や markReady された fd は既に ready なので待たない
+// それ以外は最も近いタイマーの期限まで待つ
+int IOTaskManager::waitTimeout(int timeout_ms) const {
+    if (hasUnpollableWatch() || !marked_ready_.empty()) {
+        return 0;
+    }
+    const int timer_timeout = timers_.timeUntilNextExpiry(monotonicMillis());
+    if (timer_timeout == TimerWheel::kNoTimer) {
+        return timeout_ms;
+    }
+    if (timeout_ms == kWaitForever || timer_timeout < timeout_ms) {
+        return timer_timeout;
+    }
+    return timeout_ms;
+}
+
+void IOTaskManager::executeExpiredTimers() {
+    // 実行中のタスクが他のタスクを削除した場合, そのタイマーはリストから外れる
+    for (Timer *timer = timers_.popExpired(); timer != NULL; timer = timers_.popExpired()) {
+        IOTask *task = timer->getTask();
+        handleTaskResult(task, task->onTimeout());
+    }
+}
+
+void IOTaskManager::executeFdTasks(int fd, unsigned int events) {
+    const Watch *watch = findWatch(fd);
+    if (watch == NULL) {
+        return;
+    }
+
+    // 実行中のタスクが同じ fd のタスクを追加・削除することがあるのでコピーする
+    running_.assign(watch->tasks.begin(), watch->tasks.end());
+    for (std::size_t i = 0; i < running_.size(); i++) {
+        IOTask *task = running_[i];
+        if (!isRegistered(fd, task)) {
+            continue; // 先に実行したタスクによって削除された
+        }
+        // エラー・切断はどのタスクにも通知し, execute() の中で検出させる
+        if ((task->getEvents() & events) || (events & kEventError)) {
+            executeTask(task);
+        }
+    }
+}
+
+void IOTaskManager::executeTask(IOTask *task) {
+    handleTaskResult(task, task->execute());
+}
+
+void IOTaskManager::handleTaskResult(IOTask *task, const Result<IOTaskResult, std::string> &r) {
+    if (r.isErr()) {
+        // TODO: 適切なエラーハンドリング
+        // ログを書く, 再試行する, など
+        delete task;
+        return;
+    }
+    if (r.unwrap() == kTaskComplete) {
+        delete task;
+    }
+}
+
+IOTaskManager::Watch *IOTaskManager::findWatch(int fd) {
+    if (fd < 0 || static_cast<std::size_t>(fd) >= watches_.size() || watches_[fd].tasks.empty()) {
+        return NULL;
+    }
+    return &watches_[fd];
+}
+
+// task は削除済みのことがあるので参照せず, アドレスだけを比較する
+// 1 つの fd のタスクは高々数個
+bool IOTaskManager::isRegistered(int fd, const IOTask *task) {
+    const Watch *watch = findWatch(fd);
+    return watch != NULL && std::find(watch->tasks.begin(), watch->tasks.end(), task) != watch->tasks.end();
+}
+
+bool IOTaskManager::hasUnpollableWatch() const {
+    return !unpollable_fds_.empty();
+}
+
+void IOTaskManager::collectUnpollableWatches() {
+    for (std::size_t i = 0; i < unpollable_fds_.size(); i++) {
+        const int fd = unpollable_fds_[i];
+        const Poller::Event ev = {fd, watches_[fd].registered_events};
+        ready_.push_back(ev);
+    }
+}
+
+void IOTaskManager::setUnpollable(int fd, Watch &watch) {
+    watch.pollable = false;
+    watch.unpollable_index = unpollable_fds_.size();
+    unpollable_fds_.push_back(fd);
+}
+
+// 末尾の fd と入れ替えて削除する
+void IOTaskManager::clearUnpollable(Watch &watch) {
+    if (watch.pollable) {
+        return;
+    }
+    const int last_fd = unpollable_fds_.back();
+    unpollable_fds_[watch.unpollable_index] = last_fd;
+    watches_[last_fd].unpollable_index = watch.unpollable_index;
+    unpollable_fds_.pop_back();
+    watch.pollable = true;
+}
+
+// fd に登録されたタスクの関心の和をポーラーに反映する
+void IOTaskManager::updateWatch(int fd) {
+    Watch &watch = watches_[fd];
+
+    if (watch.tasks.empty()) {
+        // fd が既に close されている場合は失敗するが, close 時にカーネル側で登録は解除されている
+        if (watch.pollable) {
+            poller_.remove(fd);
         }
+        // 同じ番号で開かれる次の fd のために初期状態に戻す
+        clearUnpollable(watch);
+        watch.registered_events = kEventNone;
+        return;
+    }
+
+    unsigned int events = kEventNone;
+    for (std::size_t i = 0; i < watch.tasks.size(); i++) {
+        events |= watch.tasks[i]->getEvents();
+    }
+    if (events == watch.registered_events) {
+        return;
+    }
+
+    const unsigned int registered_events = watch.registered_events;
+    watch.registered_events = events;
+    if (!watch.pollable) {
+        return;
+    }
+    // close と同じ番号での再 open により, カーネル側の登録が消えていることがあるので add を試す
+    if (registered_events != kEventNone && poller_.modify(fd, events).isOk()) {
+        return;
+    }
+    if (poller_.add(fd, events).isErr()) {
+        setUnpollable(fd, watch);
     }
 }
 
+void IOTaskManager::markReady(int fd, unsigned int events) {
+    const Poller::Event ev = {fd, events};
+    marked_ready_.push_back(ev);
+}
+
+// 末尾のタスクと入れ替えて削除する
 void IOTaskManager::removeTask(IOTask *task) {
-    std::vector<IOTask *>::iterator it = std::find(tasks_.begin(), tasks_.end(), task);
-    if (it != tasks_.end()) {
-        *it = NULL;
+    const int fd = task->getFd();
+    Watch *watch = findWatch(fd);
+    if (watch == NULL || task->slot_ >= watch->tasks.size() || watch->tasks[task->slot_] != task) {
+        return;
     }
+    std::vector<IOTask *> &tasks = watch->tasks;
+    IOTask *last = tasks.back();
+    tasks[task->slot_] = last;
+    last->slot_ = task->slot_;
+    tasks.pop_back();
+    updateWatch(fd);
 }
 
 void IOTaskManager::addTask(IOTask *task) {
-    tasks_.push_back(task);
+    const int fd = task->getFd();
+    if (fd < 0) {
+        return;
+    }
+    if (static_cast<std::size_t>(fd) >= watches_.size()) {
+        const Watch watch = {std::vector<IOTask *>(), kEventNone, true, 0};
+        watches_.resize(fd + 1, watch);
+    }
+    std::vector<IOTask *> &tasks = watches_[fd].tasks;
+    task->slot_ = tasks.size();
+    tasks.push_back(task);
+    updateWatch(fd);
+}
+
+void IOTaskManager::armTimer(Timer &timer, unsigned int timeout_ms) {
+    timers_.arm(timer, now_ + timeout_ms);
+}
+
+void IOTaskManager::cancelTimer(Timer &timer) {
+    timers_.cancel(timer);
+}
+
+std::time_t IOTaskManager::getCurrentTime() const {
+    return current_time_;
+}
+
+uint64_t IOTaskManager::monotonicMillis() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + static_cast<uint64_t>(ts.tv_nsec) / (1000 * 1000);
 }
@@ -1,20 +1,84 @@
 #ifndef IOTASKMANAGER_HPP
 #define IOTASKMANAGER_HPP
 
+#include "io/poller.hpp"
 #include "io_task.hpp"
-#include <map>
+#include "timer_wheel.hpp"
+#include "utils/result.hpp"
+#include "utils/unit.hpp"
+#include <ctime>
 #include <vector>
 
+// Event loop
+// Sleeps until a registered fd becomes ready or a timer expires,
+// and executes only the tasks waiting for that readiness or timeout
+// Adding and removing a task are O(1), and an iteration only visits the ready fds
 class IOTaskManager {
 public:
+    static const int kWaitForever = -1;
+
     IOTaskManager();
     virtual ~IOTaskManager();
-    void executeTasks();
+    // Run the event loop. Returns when waiting for readiness fails or a task calls stop()
+    Result<types::Unit, std::string> executeTasks();
+    // Make executeTasks() return after the current iteration
+    void stop();
+    // Wait at most timeout_ms (kWaitForever to block) and execute the ready tasks once
+    Result<types::Unit, std::string> executeReadyTasks(int timeout_ms);
     virtual void addTask(IOTask *task);
     virtual void removeTask(IOTask *task);
+    // Execute the tasks on fd in the next iteration as if the poller reported events
+    // For data that is already buffered in user space and will never wake the poller
+    virtual void markReady(int fd, unsigned int events);
+    // Arm timer to expire timeout_ms after the current iteration started
+    void armTimer(Timer &timer, unsigned int timeout_ms);
+    void cancelTimer(Timer &timer);
+    // Wall clock time in seconds, updated once per iteration
+    // For values that only change every second, e.g. the Date header, so tasks need no clock call of their own
+    std::time_t getCurrentTime() const;
 
 private:
-    std::vector<IOTask *> tasks_;
+    // Tasks sharing one fd, e.g. ReadRequest and the WriteFile it spawned
+    // Unused while tasks is empty. The vector keeps its capacity for the next fd with the same number
+    struct Watch {
+        // Each task knows its index here (IOTask::slot_) and is removed by swapping with the last one
+        std::vector<IOTask *> tasks;
+        // Union of the task interests currently registered in the poller
+        unsigned int registered_events;
+        // False if the poller rejected the fd (e.g. regular files on epoll)
+        // Such fds are treated as always ready
+        bool pollable;
+        // Index in unpollable_fds_ if not pollable
+        std::size_t unpollable_index;
+    };
+
+    Poller poller_;
+    // Indexed by fd. fds are small integers reused by the kernel, so the table stays as large as the max fd
+    std::vector<Watch> watches_;
+    std::vector<int> unpollable_fds_;
+    std::vector<Poller::Event> ready_;
+    std::vector<Poller::Event> marked_ready_;
+    // Tasks of the fd being executed, reused to avoid allocating for every ready fd
+    std::vector<IOTask *> running_;
+    TimerWheel timers_;
+    // Monotonic time in milliseconds, updated once per iteration
+    uint64_t now_;
+    std::time_t current_time_;
+    bool stopped_;
+
+    Watch *findWatch(int fd);
+    void updateWatch(int fd);
+    void setUnpollable(int fd, Watch &watch);
+    void clearUnpollable(Watch &watch);
+    bool hasUnpollableWatch() const;
+    void collectUnpollableWatches();
+    void executeFdTasks(int fd, unsigned int events);
+    void executeExpiredTimers();
+    int waitTimeout(int timeout_ms) const;
+    bool isRegistered(int fd, const IOTask *task);
+    static void executeTask(IOTask *task);
+    static void handleTaskResult(IOTask *task, const Result<IOTaskResult, std::string> &result);
+    static uint64_t monotonicMillis();
 };
 
 #endif
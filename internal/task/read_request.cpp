@@ -1,71 +1,382 @@
 #include "read_request.hpp"
-#include "http/request_parser.hpp"
-#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <strings.h>
 
-ReadRequest::ReadRequest(IContext *ctx, IReadRequestCallback *cb, IBufferedReader *reader)
-    : IOTask(ctx->getManager(), ctx->getClientFd()), ctx_(ctx), cb_(cb), reader_(reader) {}
+namespace {
+    const ReadRequestTimeouts kNoTimeouts = {0, 0, 0};
+    // message-body をリーダーから RequestBody に移すときの単位
+    const std::size_t kBodyChunkSize = 8 * 1024;
+    // 名前の分からないフィールドは線形に探すので, 数を抑えて探す手間が二乗で増えないようにする
+    const std::size_t kMaxHeaderFields = 100;
+
+    // 最後の transfer-coding が chunked か
+    // refs: https://datatracker.ietf.org/doc/html/rfc9112#section-6.3
+    bool isChunked(const StringView &transfer_encoding) {
+        const std::size_t comma_pos = transfer_encoding.rfind(',');
+        StringView coding(transfer_encoding);
+        if (comma_pos != StringView::npos) {
+            coding = coding.substr(comma_pos + 1);
+        }
+        const std::size_t begin = coding.findFirstNotOf(" \t");
+        if (begin == StringView::npos) {
+            return false;
+        }
+        coding = coding.substr(begin, coding.findLastNotOf(" \t") + 1 - begin);
+        // transfer-coding は大文字小文字を区別しない
+        const char kChunked[] = "chunked";
+        if (coding.size() != sizeof(kChunked) - 1) {
+            return false;
+        }
+        for (std::size_t i = 0; i < coding.size(); i++) {
+            if (std::tolower(static_cast<unsigned char>(coding[i])) != kChunked[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // expectation は大文字小文字を区別しない
+    // refs: https://datatracker.ietf.org/doc/html/rfc9110#section-10.1.1
+    bool isContinueExpected(const Option<StringView> &expect) {
+        const char k100Continue[] = "100-continue";
+        return expect.isSome()
+                && expect.unwrap().size() == sizeof(k100Continue) - 1
+                && strncasecmp(expect.unwrap().data(), k100Continue, sizeof(k100Continue) - 1) == 0;
+    }
+} // namespace
+
+ReadRequest::ReadRequest(IContext *ctx, IReadRequestCallback *cb, IBufferedReader *reader, Ownership ownership)
+    : IOTask(ctx->getManager(), ctx->getClientFd(), kEventRead),
+      ctx_(ctx),
+      cb_(cb),
+      reader_(reader),
+      ownership_(ownership),
+      timeouts_(kNoTimeouts),
+      arena_(&own_arena_),
+      state_(kStateRequestLine),
+      header_started_(false),
+      request_line_(),
+      headers_(arena_),
+      max_header_size_(0),
+      header_bytes_(0),
+      header_fields_(0),
+      content_length_(0),
+      body_bytes_read_(0),
+      max_body_size_(0),
+      body_too_large_(false),
+      reject_status_(kStatusUnknown) {}
+
+ReadRequest::ReadRequest(IContext *ctx,
+                         IReadRequestCallback *cb,
+                         IBufferedReader *reader,
+                         const ReadRequestTimeouts &timeouts,
+                         Ownership ownership,
+                         Arena *arena)
+    : IOTask(ctx->getManager(), ctx->getClientFd(), kEventRead),
+      ctx_(ctx),
+      cb_(cb),
+      reader_(reader),
+      ownership_(ownership),
+      timeouts_(timeouts),
+      arena_(arena != NULL ? arena : &own_arena_),
+      state_(kStateRequestLine),
+      header_started_(false),
+      request_line_(),
+      headers_(arena_),
+      max_header_size_(0),
+      header_bytes_(0),
+      header_fields_(0),
+      content_length_(0),
+      body_bytes_read_(0),
+      max_body_size_(0),
+      body_too_large_(false),
+      reject_status_(kStatusUnknown) {
+    setTimeout(timeouts_.idle);
+}
 
 ReadRequest::~ReadRequest() {
-    delete cb_;
+    if (ownership_ == kOwnMove) {
+        delete cb_;
+    }
+}
+
+// リクエストごとに作られるので, 同じスレッドで解放されたメモリを使い回す
+void *ReadRequest::operator new(std::size_t size) {
+    return FreeList<ReadRequest>::allocate(size);
+}
+
+void ReadRequest::operator delete(void *ptr, std::size_t size) {
+    FreeList<ReadRequest>::deallocate(ptr, size);
+}
+
+Result<IOTaskResult, std::string> ReadRequest::execute() {
+    const Result<IOTaskResult, std::string> result = readRequest();
+    if (result.isErr() && cb_ != NULL) {
+        if (body_too_large_) {
+            cb_->triggerBodyTooLarge(ctx_);
+        } else if (reject_status_ != kStatusUnknown) {
+            cb_->triggerReject(ctx_, reject_status_, result.unwrapErr());
+        } else {
+            cb_->triggerError(ctx_, result.unwrapErr());
+        }
+    }
+    return result;
+}
+
+void ReadRequest::setMaxBodySize(std::size_t max_body_size) {
+    max_body_size_ = max_body_size;
+}
+
+void ReadRequest::setMaxHeaderSize(std::size_t max_header_size) {
+    max_header_size_ = max_header_size;
+    line_reader_.setMaxSize(max_header_size);
+}
+
+Result<IOTaskResult, std::string> ReadRequest::onTimeout() {
+    const std::string error = header_started_ ? "timed out reading request" : "timed out waiting for request";
+    if (cb_ != NULL) {
+        cb_->triggerError(ctx_, error);
+    }
+    return Err(error);
 }
 
-// TODO: ノンブロッキング対応
 // TODO: 400 Bad Request を返す
 // HTTP-request = request-line CRLF *( field-line CRLF ) CRLF [ message-body ]
-Result<IOTaskResult, std::string> ReadRequest::execute() {
-    // request-line CRLF
-    std::string request_line = TRY(reader_->readLine("\r\n"));
-    if (!utils::endsWith(request_line, "\r\n")) {
-        return Err<std::string>("start-line does not end with CRLF");
+Result<IOTaskResult, std::string> ReadRequest::readRequest() {
+    while (state_ != kStateDone) {
+        bool progressed = false;
+        switch (state_) {
+            case kStateRequestLine: progressed = TRY(readRequestLine()); break;
+            case kStateHeaders: progressed = TRY(readHeader()); break;
+            case kStateBody: progressed = TRY(readBody()); break;
+            case kStateChunkedBody: progressed = TRY(readChunkedBody()); break;
+            case kStateDone: break;
+        }
+        // request-line 前の空行も含め, 最初のバイトを受け取ったら header のタイムアウトに切り替える
+        if (!header_started_ && (state_ != kStateRequestLine || line_reader_.hasPartialLine() || progressed)) {
+            header_started_ = true;
+            setTimeout(timeouts_.header);
+        }
+        // 今読めるバイトを読み切ったので, 次に読み込み可能になるまで中断する
+        if (!progressed) {
+            if (cb_ != NULL) {
+                cb_->triggerSuspend(ctx_);
+            }
+            return Ok(kTaskSuspend);
+        }
+    }
+
+    if (cb_ != NULL)
+        cb_->trigger(ctx_);
+    return Ok(kTaskComplete);
+}
+
+// 上限を超える行は, 行の終わりを待たずに too_long_status で拒否する
+Result<Option<StringView>, std::string> ReadRequest::readLine(HttpStatusCode too_long_status) {
+    const Result<Option<StringView>, std::string> line = line_reader_.readLine(*reader_);
+    if (line.isErr() && line_reader_.isTooLong()) {
+        return reject(too_long_status, line.unwrapErr());
     }
+    return line;
+}
 
-    request_line.erase(request_line.size() - 2); // remove CRLF
+// request-line CRLF
+Result<bool, std::string> ReadRequest::readRequestLine() {
+    const Option<StringView> line = TRY(readLine(kStatusUriTooLong));
+    if (line.isNone()) {
+        return Ok(false);
+    }
+    // request-line の前の空行は無視する (SHOULD)
+    // refs: https://datatracker.ietf.org/doc/html/rfc9112#section-2.2
+    if (line.unwrap().empty()) {
+        return Ok(true);
+    }
+
+    // 行はバッファを指しているので, アリーナにコピーしてから各部分を参照する
+    request_line_ = TRY(RequestParser::scanRequestLine(arena_->copy(line.unwrap())));
+    state_ = kStateHeaders;
+    return Ok(true);
+}
 
-    // *( field-line CRLF ) CRLF
-    Option<size_t> content_length = None;
-    while (true) {
-        std::string header = TRY(reader_->readLine("\r\n"));
-        if (!utils::endsWith(header, "\r\n")) {
-            return Err<std::string>("field-line does not end with CRLF");
+// *( field-line CRLF ) CRLF
+Result<bool, std::string> ReadRequest::readHeader() {
+    const Option<StringView> line = TRY(readLine(kStatusRequestHeaderFieldsTooLarge));
+    if (line.isNone()) {
+        return Ok(false);
+    }
+
+    const StringView &header = line.unwrap();
+    if (header.empty()) {
+        TRY(startBody());
+        return Ok(true);
+    }
+    // 1 行ずつの上限に加え, header section 全体の大きさとフィールドの数も抑える
+    header_bytes_ += header.size() + 2;
+    header_fields_++;
+    if (max_header_size_ > 0 && header_bytes_ > max_header_size_) {
+        return reject(kStatusRequestHeaderFieldsTooLarge, "header section is larger than the limit");
+    }
+    if (header_fields_ > kMaxHeaderFields) {
+        return reject(kStatusRequestHeaderFieldsTooLarge, "too many header fields");
+    }
+    // 行はバッファを指しているので, ここで名前と値だけをアリーナにコピーする
+    // 同じ名前のフィールドは最初のものを使い, 後のものはコピーしない
+    // ただし message-body の区切りを決めるフィールドは, 中継するサーバーと解釈が食い違わないよう全て見る
+    // refs: https://datatracker.ietf.org/doc/html/rfc9112#section-11.2
+    const RequestParser::HeaderFieldView field = TRY(RequestParser::scanHeaderFieldLine(header));
+    switch (httpHeaderFromName(field.name)) {
+        case kHeaderContentLength: TRY(addContentLength(field.value)); break;
+        // 繰り返された Transfer-Encoding はつないで 1 つのリストとして扱い, 最後の transfer-coding を見る
+        case kHeaderTransferEncoding: headers_.combine(field.name, field.value); break;
+        default: headers_.add(field.name, field.value); break;
+    }
+    return Ok(true);
+}
+
+// Content-Length ヘッダーの値を取得. 上限との比較は経路が決まる header section の終わりで行う
+// 数値として読めない値や, 値の異なる Content-Length が複数あれば, どれを使うかで解釈が分かれるので拒否する (MUST)
+// refs: https://datatracker.ietf.org/doc/html/rfc9112#section-6.3
+Result<types::Unit, std::string> ReadRequest::addContentLength(const StringView &value) {
+    const Option<unsigned long> parsed = utils::parseDecimal(value);
+    if (parsed.isNone()) {
+        return reject(kStatusBadRequest, "invalid Content-Length");
+    }
+    const std::size_t content_length = parsed.unwrap();
+    if (headers_.add(httpHeaderName(kHeaderContentLength), value).isNone() && content_length != content_length_) {
+        return reject(kStatusBadRequest, "conflicting Content-Length");
+    }
+    content_length_ = content_length;
+    return Ok(unit);
+}
+
+// Transfer-Encoding と Content-Length の両方があるリクエストは, 中継するサーバーとの間で
+// message-body の区切りが食い違うリクエストスマグリングに使われるので, 接続ごと拒否する
+// refs: https://datatracker.ietf.org/doc/html/rfc9112#section-6.3
+Result<types::Unit, std::string> ReadRequest::startBody() {
+    const Option<StringView> transfer_encoding = headers_.get(kHeaderTransferEncoding);
+    if (transfer_encoding.isSome() && headers_.get(kHeaderContentLength).isSome()) {
+        return reject(kStatusBadRequest, "both Transfer-Encoding and Content-Length are present");
+    }
+
+    // message-body を読む前にリクエストを渡し, 経路ごとの上限を決めてもらう
+    // request-line もヘッダーもアリーナにあるので, コピーせずに組み立てて ctx_ に引き渡す
+    Request request(request_line_.method, request_line_.request_target, request_line_.http_version, headers_, *arena_);
+    ctx_->setRequest(request);
+    if (cb_ != NULL) {
+        max_body_size_ = cb_->maxBodySize(ctx_, max_body_size_);
+    }
+
+    if (transfer_encoding.isSome()) {
+        if (!isChunked(transfer_encoding.unwrap())) {
+            return reject(kStatusBadRequest, "unsupported transfer coding");
         }
+        chunked_decoder_.reset(max_body_size_);
+        state_ = kStateChunkedBody;
+    } else if (content_length_ > 0) {
+        // 宣言された大きさの時点で拒否し, message-body は 1 バイトも読まない
+        if (max_body_size_ > 0 && content_length_ > max_body_size_) {
+            body_too_large_ = true;
+            return Err<std::string>("request body is larger than client_max_body_size");
+        }
+        state_ = kStateBody;
+    } else {
+        state_ = kStateDone;
+        return Ok(unit);
+    }
 
-        if (header == "\r\n") {
+    // 受け付ける message-body の送信を待っているクライアントに 100 Continue を返す
+    // HTTP/1.0 のクライアントは 100 Continue を理解しないので無視する (MUST)
+    // refs: https://datatracker.ietf.org/doc/html/rfc9110#section-10.1.1
+    if (cb_ != NULL && request_line_.http_version != "HTTP/1.0" && isContinueExpected(headers_.get(kHeaderExpect))) {
+        TRY(cb_->triggerContinue(ctx_));
+    }
+    setTimeout(timeouts_.body);
+    return Ok(unit);
+}
+
+// message-body
+// 全体を一度に確保せず, 読めた分ずつ RequestBody に追記する
+Result<bool, std::string> ReadRequest::readBody() {
+    RequestBody &body = ctx_->getRequestBody();
+    char chunk[kBodyChunkSize];
+    std::size_t bytes_read = 0;
+    while (body_bytes_read_ < content_length_) {
+        const std::size_t bytes_to_read = std::min(content_length_ - body_bytes_read_, sizeof(chunk));
+        const std::size_t n = TRY(reader_->read(chunk, bytes_to_read));
+        TRY(body.append(chunk, n));
+        body_bytes_read_ += n;
+        bytes_read += n;
+        // 要求より少なければ, 今読めるバイトは読み切った
+        if (n < bytes_to_read) {
             break;
         }
+    }
+    // client_body_timeout は連続する 2 回の読み込みの間の時間
+    if (bytes_read > 0) {
+        setTimeout(timeouts_.body);
+    }
+    if (body_bytes_read_ < content_length_) {
+        if (reader_->eof()) {
+            return Err<std::string>("connection closed before message-body is fully received");
+        }
+        return Ok(false);
+    }
 
-        header.erase(header.size() - 2); // remove CRLF
-        headers_.push_back(header);
+    state_ = kStateDone;
+    return Ok(true);
+}
 
-        // Content-Length ヘッダーの値を取得
-        const std::pair<std::string, std::string> &field = TRY(RequestParser::parseHeaderFieldLine(header));
-        if (field.first == "Content-Length") {
-            // TODO: client_max_body_size より大きい値の場合はエラー
-            content_length = Some(TRY(utils::stoul(field.second)));
+// chunked-body
+Result<bool, std::string> ReadRequest::readChunkedBody() {
+    const Result<std::size_t, std::string> decoded = chunked_decoder_.decode(*reader_, ctx_->getRequestBody());
+    if (decoded.isErr()) {
+        body_too_large_ = chunked_decoder_.isTooLarge();
+        return Err(decoded.unwrapErr());
+    }
+    const std::size_t bytes_read = decoded.unwrap();
+    // client_body_timeout は連続する 2 回の読み込みの間の時間
+    if (bytes_read > 0) {
+        setTimeout(timeouts_.body);
+    }
+    if (!chunked_decoder_.isDone()) {
+        if (reader_->eof()) {
+            return Err<std::string>("connection closed before chunked message-body is fully received");
         }
+        return Ok(false);
     }
 
-    Option<std::string> maybe_body = None;
-    if (content_length.isSome()) {
-        // message-body
-        const size_t &body_size = content_length.unwrap();
-        char *buf = new char[body_size];
-        TRY(reader_->read(buf, body_size));
-        maybe_body = Some(std::string(buf, body_size));
-        delete[] buf;
-    }
+    state_ = kStateDone;
+    return Ok(true);
+}
 
-    Request parsed_request = TRY(RequestParser::parseRequest(request_line, headers_, maybe_body.unwrapOr("")));
-    ctx_->setRequest(parsed_request);
-    if (cb_ != NULL)
-        cb_->trigger(ctx_);
-    return Ok(kTaskComplete);
+types::Err<std::string> ReadRequest::reject(HttpStatusCode status, const std::string &error) {
+    reject_status_ = status;
+    return Err(error);
 }
 
 IReadRequestCallback::~IReadRequestCallback() {}
 
-ReadRequestCallback::ReadRequestCallback(IHandler *handler) : handler_(handler) {}
+Result<types::Unit, std::string> IReadRequestCallback::triggerSuspend(IContext *ctx) {
+    (void) ctx;
+    return Ok(unit);
+}
+
+std::size_t IReadRequestCallback::maxBodySize(IContext *ctx, std::size_t max_body_size) {
+    (void) ctx;
+    return max_body_size;
+}
 
-Result<types::Unit, std::string> ReadRequestCallback::trigger(IContext *ctx) {
-    handler_->trigger(ctx);
+Result<types::Unit, std::string> IReadRequestCallback::triggerContinue(IContext *ctx) {
+    (void) ctx;
     return Ok(unit);
 }
+
+Result<types::Unit, std::string> IReadRequestCallback::triggerBodyTooLarge(IContext *ctx) {
+    return triggerError(ctx, "request body is larger than client_max_body_size");
+}
+
+Result<types::Unit, std::string> IReadRequestCallback::triggerReject(IContext *ctx, HttpStatusCode status, const std::string &error) {
+    (void) status;
+    return triggerError(ctx, error);
+}
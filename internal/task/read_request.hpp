@@ -1,10 +1,16 @@
 #ifndef READREQUEST_HPP
 #define READREQUEST_HPP
 
-#include "handler/handler.hpp"
+#include "http/chunked_decoder.hpp"
+#include "http/header_table.hpp"
 #include "http/interface/context.hpp"
+#include "http/request_parser.hpp"
+#include "io/line_reader.hpp"
 #include "io/reader.hpp"
 #include "io_task.hpp"
+#include "utils/arena.hpp"
+#include "utils/free_list.hpp"
+#include "utils/ownership.hpp"
 #include "utils/result.hpp"
 #include "utils/unit.hpp"
 #include "utils/utils.hpp"
@@ -13,29 +19,123 @@
 class IReadRequestCallback {
 public:
     virtual ~IReadRequestCallback();
+    // Called with the request set to ctx
     virtual Result<types::Unit, std::string> trigger(IContext *ctx) = 0;
+    // Called when the request cannot be read, e.g. malformed or the connection is closed
+    virtual Result<types::Unit, std::string> triggerError(IContext *ctx, const std::string &error) = 0;
+    // Called when the bytes available now have been consumed before the request is complete
+    // Does nothing by default
+    virtual Result<types::Unit, std::string> triggerSuspend(IContext *ctx);
+    // Called when the header section has been read, with the request set to ctx
+    // Returns the max size of its message-body in bytes (0 for no limit), e.g. resolved from the route
+    // Returns max_body_size, the one given by ReadRequest::setMaxBodySize, by default
+    virtual std::size_t maxBodySize(IContext *ctx, std::size_t max_body_size);
+    // Called when the client waits for 100 Continue before sending the message-body (Expect: 100-continue)
+    // Not called if the message-body is rejected. Does nothing by default
+    virtual Result<types::Unit, std::string> triggerContinue(IContext *ctx);
+    // Called instead of triggerError when the message-body is larger than the max size
+    // The rest of the message-body is not read, so the connection cannot be reused
+    // Calls triggerError by default
+    virtual Result<types::Unit, std::string> triggerBodyTooLarge(IContext *ctx);
+    // Called instead of triggerError when the request is answered with status without reaching the handler,
+    // e.g. 400 for conflicting framing fields. The connection cannot be reused
+    // Calls triggerError by default
+    virtual Result<types::Unit, std::string> triggerReject(IContext *ctx, HttpStatusCode status, const std::string &error);
 };
 
-class ReadRequestCallback : public IReadRequestCallback {
-public:
-    explicit ReadRequestCallback(IHandler *handler);
-    virtual Result<types::Unit, std::string> trigger(IContext *ctx);
-
-private:
-    IHandler *handler_;
+// Timeouts in milliseconds while reading a request, 0 disables
+struct ReadRequestTimeouts {
+    // Until the first byte of the request arrives, e.g. keepalive_timeout
+    unsigned int idle;
+    // Until the whole request-line and header section are received
+    unsigned int header;
+    // Between two successive reads of the message-body
+    unsigned int body;
 };
 
+// Reads a request incrementally from a non-blocking fd
+// execute() consumes the bytes available now, returns kTaskSuspend when more are needed
+// and resumes from the same state on the next readiness
+// The message-body is appended to ctx->getRequestBody() in chunks as it arrives
+// Both Content-Length and the chunked transfer coding are supported
+// The header section may have at most 100 fields, so that looking them up stays cheap
+// A request whose framing is ambiguous, i.e. with conflicting Content-Length fields or with both
+// Transfer-Encoding and Content-Length, is rejected with 400 so that it cannot be read differently by a proxy
+// So is one whose framing cannot be read: an invalid Content-Length or a transfer coding other than chunked
+// A message-body larger than the max size is rejected without being read: as soon as the header
+// section is parsed for Content-Length, and at the first chunk exceeding it for chunked
+// The request-line and header fields are copied into an arena, and the request given to ctx is built there
+// The memory of finished tasks is reused for the next ones created on the same thread
 class ReadRequest : public IOTask {
 public:
-    ReadRequest(IContext *ctx, IReadRequestCallback *cb, IBufferedReader *reader);
+    // Delete cb after the task if ownership is kOwnMove
+    ReadRequest(IContext *ctx, IReadRequestCallback *cb, IBufferedReader *reader, Ownership ownership = kOwnMove);
+    // arena must outlive the task and the request given to ctx, e.g. the per-request arena of the connection
+    // If NULL, the task uses its own and the request must be copied before the task is deleted
+    ReadRequest(IContext *ctx,
+                IReadRequestCallback *cb,
+                IBufferedReader *reader,
+                const ReadRequestTimeouts &timeouts,
+                Ownership ownership = kOwnMove,
+                Arena *arena = NULL);
     ~ReadRequest();
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, std::size_t size);
     virtual Result<IOTaskResult, std::string> execute();
+    // Notifies cb of the error, the connection is expected to be closed
+    virtual Result<IOTaskResult, std::string> onTimeout();
+    // Fail if the message-body exceeds max_body_size bytes, 0 disables
+    // cb->maxBodySize() may override it for each request
+    void setMaxBodySize(std::size_t max_body_size);
+    // Reject with 414 a request-line longer than max_header_size bytes including CRLF,
+    // and with 431 a header section longer than that, 0 disables
+    void setMaxHeaderSize(std::size_t max_header_size);
 
 private:
+    enum State {
+        kStateRequestLine,
+        kStateHeaders,
+        kStateBody,
+        kStateChunkedBody,
+        kStateDone,
+    };
+
     IContext *ctx_;
     IReadRequestCallback *cb_;
     IBufferedReader *reader_;
-    std::vector<std::string> headers_;
+    Ownership ownership_;
+    ReadRequestTimeouts timeouts_;
+    Arena own_arena_;
+    Arena *arena_;
+    State state_;
+    // Whether a byte of the request has been received and the header timeout is running
+    bool header_started_;
+    CrlfLineReader line_reader_;
+    // Views into arena_
+    RequestParser::RequestLineView request_line_;
+    HeaderTable headers_;
+    std::size_t max_header_size_;
+    // Bytes and number of the field lines read so far, including those of repeated names
+    std::size_t header_bytes_;
+    std::size_t header_fields_;
+    std::size_t content_length_;
+    std::size_t body_bytes_read_;
+    std::size_t max_body_size_;
+    ChunkedDecoder chunked_decoder_;
+    // Whether reading failed because the message-body is larger than max_body_size_
+    bool body_too_large_;
+    // Status to answer with if reading failed because the request is rejected, kStatusUnknown otherwise
+    HttpStatusCode reject_status_;
+
+    Result<IOTaskResult, std::string> readRequest();
+    Result<Option<StringView>, std::string> readLine(HttpStatusCode too_long_status);
+    Result<bool, std::string> readRequestLine();
+    Result<bool, std::string> readHeader();
+    Result<types::Unit, std::string> addContentLength(const StringView &value);
+    Result<types::Unit, std::string> startBody();
+    Result<bool, std::string> readBody();
+    Result<bool, std::string> readChunkedBody();
+    types::Err<std::string> reject(HttpStatusCode status, const std::string &error);
 };
 
 #endif
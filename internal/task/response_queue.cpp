@@ -0,0 +1,134 @@
+#include "response_queue.hpp"
+
+const std::size_t ResponseQueue::kMaxRetainedBodySize;
+
+ResponseQueue::ResponseQueue(IOTaskManager &manager, int fd, IWriteFileCallback *cb)
+    : manager_(manager), fd_(fd), cb_(cb), send_timeout_(0), pending_count_(0), writing_count_(0), writing_(NULL) {}
+
+ResponseQueue::~ResponseQueue() {
+    clear();
+}
+
+void ResponseQueue::push(const StringView &head) {
+    Response &response = nextEntry();
+    response.head.assign(head.data(), head.size());
+}
+
+void ResponseQueue::push(const StringView &head, std::string &body) {
+    Response &response = nextEntry();
+    response.head.assign(head.data(), head.size());
+    response.body.swap(body);
+}
+
+// 書き終えたレスポンスの領域と入れ替え, 書き込むレスポンスはコピーせずにセグメントとして渡す
+void ResponseQueue::flush() {
+    if (writing_ != NULL || pending_count_ == 0) {
+        return;
+    }
+    writing_responses_.swap(pending_);
+    writing_count_ = pending_count_;
+    pending_count_ = 0;
+
+    segments_.clear();
+    for (std::size_t i = 0; i < writing_count_; i++) {
+        const Response &response = writing_responses_[i];
+        const std::string *parts[] = {&response.head, &response.body};
+        for (std::size_t j = 0; j < sizeof(parts) / sizeof(parts[0]); j++) {
+            if (parts[j]->empty()) {
+                continue;
+            }
+            struct iovec segment = {};
+            segment.iov_base = const_cast<char *>(parts[j]->data());
+            segment.iov_len = parts[j]->size();
+            segments_.push_back(segment);
+        }
+    }
+    writing_ = new WriteFile(manager_, fd_, segments_.empty() ? NULL : &segments_[0], segments_.size(), this, kOwnBorrow, send_timeout_);
+}
+
+std::size_t ResponseQueue::size() const {
+    return writing_count_ + pending_count_;
+}
+
+// 実行中の書き込みタスクは trigger() で writing_ から外れているので, ここで削除されることはない
+void ResponseQueue::clear() {
+    delete writing_;
+    writing_ = NULL;
+    writing_count_ = 0;
+    pending_count_ = 0;
+    releaseBodies(0);
+}
+
+std::size_t ResponseQueue::bodyCapacity() const {
+    std::size_t capacity = 0;
+    for (std::size_t i = 0; i < pending_.size(); i++) {
+        capacity += pending_[i].body.capacity();
+    }
+    for (std::size_t i = 0; i < writing_responses_.size(); i++) {
+        capacity += writing_responses_[i].body.capacity();
+    }
+    return capacity;
+}
+
+void ResponseQueue::setOutput(int fd) {
+    fd_ = fd;
+}
+
+void ResponseQueue::setSendTimeout(unsigned int timeout_ms) {
+    send_timeout_ = timeout_ms;
+}
+
+// 書き込み中に溜まったレスポンスがあれば続けて書き, 全て書き終えたときだけ通知する
+// 書き終えたタスクはこの後マネージャーが削除する
+Result<types::Unit, std::string> ResponseQueue::trigger() {
+    writing_ = NULL;
+    writing_count_ = 0;
+    releaseBodies(kMaxRetainedBodySize);
+    if (pending_count_ > 0) {
+        flush();
+        return Ok(unit);
+    }
+    if (cb_ != NULL) {
+        return cb_->trigger();
+    }
+    return Ok(unit);
+}
+
+Result<types::Unit, std::string> ResponseQueue::triggerError(const std::string &error) {
+    writing_ = NULL;
+    writing_count_ = 0;
+    pending_count_ = 0;
+    releaseBodies(kMaxRetainedBodySize);
+    if (cb_ != NULL) {
+        return cb_->triggerError(error);
+    }
+    return Ok(unit);
+}
+
+// 使い終えたエントリがあれば, その文字列の領域を再利用する
+// 使い終えたエントリの body は releaseBodies() で空になっている
+ResponseQueue::Response &ResponseQueue::nextEntry() {
+    if (pending_count_ == pending_.size()) {
+        pending_.push_back(Response());
+    }
+    return pending_[pending_count_++];
+}
+
+// 書き終えた body は空にし, 接続が続く間持ち続ける領域は合計で max_retained までにする
+void ResponseQueue::releaseBodies(std::size_t max_retained) {
+    std::size_t retained = 0;
+    releaseBodies(pending_, pending_count_, retained, max_retained);
+    releaseBodies(writing_responses_, writing_count_, retained, max_retained);
+}
+
+void ResponseQueue::releaseBodies(std::vector<Response> &responses, std::size_t first, std::size_t &retained, std::size_t max_retained) {
+    for (std::size_t i = first; i < responses.size(); i++) {
+        std::string &body = responses[i].body;
+        if (retained + body.capacity() > max_retained) {
+            std::string().swap(body);
+        } else {
+            body.clear();
+            retained += body.capacity();
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef INTERNAL_TASK_RESPONSE_QUEUE_HPP
+#define INTERNAL_TASK_RESPONSE_QUEUE_HPP
+
+#include "io_task_manager.hpp"
+#include "utils/string_view.hpp"
+#include "write_file.hpp"
+#include <string>
+#include <sys/uio.h>
+#include <vector>
+
+// Responses of one connection, written in the order they are pushed
+// Responses pushed before flush() are written together, so pipelined requests
+// are answered with one write instead of one per response
+// At most one write is in flight. Responses pushed meanwhile are written after it
+// Each response is a head and a body written as separate segments with one writev, and the body is
+// taken over without copying. The entries are reused for later responses, and once written their bodies
+// keep at most kMaxRetainedBodySize bytes in total, so an idle connection holds little memory
+class ResponseQueue : public IWriteFileCallback {
+public:
+    static const std::size_t kMaxRetainedBodySize = 64 * 1024;
+
+    // cb is borrowed and is called every time all the pushed responses have been written
+    ResponseQueue(IOTaskManager &manager, int fd, IWriteFileCallback *cb);
+    // Cancel the write in flight
+    virtual ~ResponseQueue();
+    // The response is written by the next flush(). head is copied
+    void push(const StringView &head);
+    // body is swapped with an empty string, which may keep the memory of an earlier body
+    void push(const StringView &head, std::string &body);
+    // Start writing the pushed responses unless a write is in flight
+    void flush();
+    // Number of responses pushed and not written yet
+    std::size_t size() const;
+    // Discard the responses not written yet and cancel the write in flight, e.g. when the connection is closed
+    // The memory of all the bodies is released
+    void clear();
+    // Bytes allocated by the bodies of all the entries
+    std::size_t bodyCapacity() const;
+    void setOutput(int fd);
+    // Milliseconds a write may go without progress, 0 disables
+    void setSendTimeout(unsigned int timeout_ms);
+
+    // The write in flight has finished
+    virtual Result<types::Unit, std::string> trigger();
+    virtual Result<types::Unit, std::string> triggerError(const std::string &error);
+
+private:
+    IOTaskManager &manager_; // NOLINT(*-avoid-const-or-ref-data-members)
+    int fd_;
+    IWriteFileCallback *cb_;
+    unsigned int send_timeout_;
+
+    struct Response {
+        std::string head;
+        std::string body;
+    };
+
+    // Responses pushed after the write in flight started are the first pending_count_ entries
+    // The vectors are swapped when a write starts, so the strings being written never move
+    std::vector<Response> pending_;
+    std::size_t pending_count_;
+    // Responses being written are the first writing_count_ entries
+    std::vector<Response> writing_responses_;
+    std::size_t writing_count_;
+    // Segments of the write in flight, pointing into writing_responses_
+    // WriteFile advances them in place as they are written
+    std::vector<struct iovec> segments_;
+    // Deleted by the manager when it finishes, NULL if no write is in flight
+    WriteFile *writing_;
+
+    Response &nextEntry();
+    void releaseBodies(std::size_t max_retained);
+    static void releaseBodies(std::vector<Response> &responses, std::size_t first, std::size_t &retained, std::size_t max_retained);
+
+    ResponseQueue(const ResponseQueue &other);
+    ResponseQueue &operator=(const ResponseQueue &other);
+};
+
+#endif //INTERNAL_TASK_RESPONSE_QUEUE_HPP
@@ -0,0 +1,229 @@
+#include "timer_wheel.hpp"
+#include <climits>
+
+Timer::Timer(IOTask *task)
+    : task_(task), wheel_(NULL), prev_(NULL), next_(NULL), deadline_(0), level_(0), slot_(0) {}
+
+Timer::~Timer() {
+    if (wheel_ != NULL) {
+        wheel_->cancel(*this);
+    }
+}
+
+bool Timer::isArmed() const {
+    return wheel_ != NULL;
+}
+
+IOTask *Timer::getTask() const {
+    return task_;
+}
+
+const int TimerWheel::kNoTimer;
+
+TimerWheel::TimerWheel(uint64_t now) : expired_(NULL), current_(now), size_(0) {
+    for (unsigned int level = 0; level < kLevels; level++) {
+        occupied_[level] = 0;
+        for (unsigned int slot = 0; slot < kSlots; slot++) {
+            slots_[level][slot] = NULL;
+        }
+    }
+}
+
+// 残っているタイマーが破棄済みのホイールを参照しないようにする
+TimerWheel::~TimerWheel() {
+    for (unsigned int level = 0; level < kLevels; level++) {
+        for (unsigned int slot = 0; slot < kSlots; slot++) {
+            while (slots_[level][slot] != NULL) {
+                cancel(*slots_[level][slot]);
+            }
+        }
+    }
+    while (expired_ != NULL) {
+        cancel(*expired_);
+    }
+}
+
+void TimerWheel::arm(Timer &timer, uint64_t deadline) {
+    if (timer.wheel_ != NULL) {
+        timer.wheel_->cancel(timer);
+    }
+    timer.wheel_ = this;
+    timer.deadline_ = deadline;
+    size_++;
+    place(timer);
+}
+
+void TimerWheel::cancel(Timer &timer) {
+    if (timer.wheel_ != this) {
+        return;
+    }
+    unlink(timer);
+    timer.wheel_ = NULL;
+    size_--;
+}
+
+// 処理済みでない tick から期限までの距離で段を決める
+// 段 L のスロットは 64^L tick ごとに 1 つ下の段へ振り分け直される (cascade)
+void TimerWheel::place(Timer &timer) {
+    // 処理済みの tick に期限があるタイマーは, 既に切れている
+    if (timer.deadline_ < current_) {
+        link(timer, kLevels, 0);
+        return;
+    }
+    uint64_t expires = timer.deadline_;
+    if (expires - current_ >= kMaxDelta) {
+        expires = current_ + kMaxDelta - 1;
+    }
+    const uint64_t delta = expires - current_;
+
+    unsigned int level = 0;
+    while (level + 1 < kLevels && delta >= (static_cast<uint64_t>(1) << (kSlotBits * (level + 1)))) {
+        level++;
+    }
+    link(timer, level, static_cast<unsigned int>(expires >> (kSlotBits * level)) & kSlotMask);
+}
+
+void TimerWheel::link(Timer &timer, unsigned int level, unsigned int slot) {
+    Timer *&head = level < kLevels ? slots_[level][slot] : expired_;
+    timer.level_ = level;
+    timer.slot_ = slot;
+    timer.prev_ = NULL;
+    timer.next_ = head;
+    if (head != NULL) {
+        head->prev_ = &timer;
+    }
+    head = &timer;
+    if (level < kLevels) {
+        occupied_[level] |= static_cast<uint64_t>(1) << slot;
+    }
+}
+
+void TimerWheel::unlink(Timer &timer) {
+    Timer *&head = timer.level_ < kLevels ? slots_[timer.level_][timer.slot_] : expired_;
+    if (timer.prev_ != NULL) {
+        timer.prev_->next_ = timer.next_;
+    } else {
+        head = timer.next_;
+    }
+    if (timer.next_ != NULL) {
+        timer.next_->prev_ = timer.prev_;
+    }
+    timer.prev_ = NULL;
+    timer.next_ = NULL;
+    if (timer.level_ < kLevels && head == NULL) {
+        occupied_[timer.level_] &= ~(static_cast<uint64_t>(1) << timer.slot_);
+    }
+}
+
+void TimerWheel::cascade(unsigned int level, unsigned int slot) {
+    while (slots_[level][slot] != NULL) {
+        Timer &timer = *slots_[level][slot];
+        unlink(timer);
+        place(timer);
+    }
+}
+
+void TimerWheel::expireSlot(unsigned int slot) {
+    while (slots_[0][slot] != NULL) {
+        Timer &timer = *slots_[0][slot];
+        unlink(timer);
+        // 上限を超えて最上段に置かれていたタイマーは, まだ期限が来ていない
+        if (timer.deadline_ > current_) {
+            place(timer);
+        } else {
+            link(timer, kLevels, 0);
+        }
+    }
+}
+
+void TimerWheel::advance(uint64_t now) {
+    while (current_ <= now) {
+        if ((current_ & kSlotMask) == 0) {
+            // 下の段の 1 周が終わったら, 上の段の次のスロットを振り分け直す
+            for (unsigned int level = 1; level < kLevels; level++) {
+                const unsigned int slot = static_cast<unsigned int>(current_ >> (kSlotBits * level)) & kSlotMask;
+                cascade(level, slot);
+                if (slot != 0) {
+                    break;
+                }
+            }
+        }
+        expireSlot(static_cast<unsigned int>(current_) & kSlotMask);
+        current_ = nextTickToProcess(now);
+    }
+}
+
+// 空の段の tick は飛ばす. 下から L 段が空なら, 次に cascade が起こる 64^L の倍数まで進めてよい
+uint64_t TimerWheel::nextTickToProcess(uint64_t now) const {
+    unsigned int empty_levels = 0;
+    while (empty_levels < kLevels && occupied_[empty_levels] == 0) {
+        empty_levels++;
+    }
+    if (empty_levels == 0) {
+        return current_ + 1;
+    }
+    if (empty_levels == kLevels) {
+        return now + 1;
+    }
+    const uint64_t step = static_cast<uint64_t>(1) << (kSlotBits * empty_levels);
+    const uint64_t next_boundary = (current_ | (step - 1)) + 1;
+    return next_boundary < now + 1 ? next_boundary : now + 1;
+}
+
+Timer *TimerWheel::popExpired() {
+    Timer *timer = expired_;
+    if (timer != NULL) {
+        cancel(*timer);
+    }
+    return timer;
+}
+
+int TimerWheel::timeUntilNextExpiry(uint64_t now) const {
+    if (expired_ != NULL) {
+        return 0;
+    }
+
+    bool found = false;
+    uint64_t next = 0;
+    // 最下段は期限ちょうど
+    const int offset = findOccupiedFrom(occupied_[0], static_cast<unsigned int>(current_) & kSlotMask);
+    if (offset >= 0) {
+        next = current_ + offset;
+        found = true;
+    }
+    // 上の段は cascade される tick (期限以前) を返す
+    for (unsigned int level = 1; level < kLevels; level++) {
+        if (occupied_[level] == 0) {
+            continue;
+        }
+        const unsigned int shift = kSlotBits * level;
+        const uint64_t first_block = (current_ + (static_cast<uint64_t>(1) << shift) - 1) >> shift;
+        const int block_offset = findOccupiedFrom(occupied_[level], static_cast<unsigned int>(first_block) & kSlotMask);
+        const uint64_t tick = (first_block + block_offset) << shift;
+        if (!found || tick < next) {
+            next = tick;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return kNoTimer;
+    }
+    if (next <= now) {
+        return 0;
+    }
+    return next - now > static_cast<uint64_t>(INT_MAX) ? INT_MAX : static_cast<int>(next - now);
+}
+
+std::size_t TimerWheel::size() const {
+    return size_;
+}
+
+// start から巡回して最初に使われているスロットまでの距離. 空なら -1
+int TimerWheel::findOccupiedFrom(uint64_t occupied, unsigned int start) {
+    if (occupied == 0) {
+        return -1;
+    }
+    const uint64_t rotated = start == 0 ? occupied : (occupied >> start) | (occupied << (kSlots - start));
+    return __builtin_ctzll(rotated);
+}
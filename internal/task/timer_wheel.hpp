@@ -0,0 +1,93 @@
+#ifndef INTERNAL_TASK_TIMER_WHEEL_HPP
+#define INTERNAL_TASK_TIMER_WHEEL_HPP
+
+#include <cstddef>
+#include <stdint.h>
+
+class IOTask;
+class TimerWheel;
+
+// Intrusive node of TimerWheel, embedded in the task that owns the deadline
+// Arming and cancelling only relink the node, so no allocation happens
+class Timer {
+public:
+    explicit Timer(IOTask *task);
+    // Cancel the timer if armed
+    ~Timer();
+
+    bool isArmed() const;
+    IOTask *getTask() const;
+
+private:
+    friend class TimerWheel;
+
+    IOTask *task_;
+    TimerWheel *wheel_;
+    Timer *prev_;
+    Timer *next_;
+    // Absolute deadline in ticks (milliseconds)
+    uint64_t deadline_;
+    // Position in the wheel, kLevels means the expired list
+    unsigned int level_;
+    unsigned int slot_;
+
+    // Linked into a wheel, so copying is not allowed
+    Timer(const Timer &other);
+    Timer &operator=(const Timer &other);
+};
+
+// Hierarchical timer wheel with 1 ms ticks
+// Arm / cancel are O(1) and advancing only visits slots that hold timers,
+// so the cost does not grow with the number of armed timers
+class TimerWheel {
+public:
+    static const int kNoTimer = -1;
+
+    explicit TimerWheel(uint64_t now);
+    // Unlink all timers left in the wheel
+    ~TimerWheel();
+
+    // Re-arming an armed timer replaces its deadline
+    void arm(Timer &timer, uint64_t deadline);
+    // Do nothing if the timer is not armed
+    void cancel(Timer &timer);
+    // Move the timers whose deadline is <= now to the expired list
+    void advance(uint64_t now);
+    // Unlink one timer from the expired list. NULL if the list is empty
+    Timer *popExpired();
+    // Milliseconds until advance() may expire a timer, kNoTimer if nothing is armed
+    // Timers in upper levels are reported at the time they cascade, which can be earlier than their deadline
+    int timeUntilNextExpiry(uint64_t now) const;
+    // Number of armed timers, including the expired ones that have not been popped
+    std::size_t size() const;
+
+private:
+    static const unsigned int kSlotBits = 6;
+    static const unsigned int kSlots = 1 << kSlotBits;
+    static const unsigned int kSlotMask = kSlots - 1;
+    static const unsigned int kLevels = 4;
+    // Timers further than this are parked in the top level and placed again when they cascade
+    static const uint64_t kMaxDelta = static_cast<uint64_t>(1) << (kSlotBits * kLevels);
+
+    Timer *slots_[kLevels][kSlots];
+    // Bit i is set if slots_[level][i] is not empty
+    uint64_t occupied_[kLevels];
+    Timer *expired_;
+    // Next tick to process
+    uint64_t current_;
+    std::size_t size_;
+
+    void place(Timer &timer);
+    void link(Timer &timer, unsigned int level, unsigned int slot);
+    void unlink(Timer &timer);
+    void cascade(unsigned int level, unsigned int slot);
+    void expireSlot(unsigned int slot);
+    uint64_t nextTickToProcess(uint64_t now) const;
+    static int findOccupiedFrom(uint64_t occupied, unsigned int start);
+
+    // Timers point at the wheel, so copying is not allowed
+    TimerWheel(const TimerWheel &other);
+    TimerWheel &operator=(const TimerWheel &other);
+};
+
+#endif //INTERNAL_TASK_TIMER_WHEEL_HPP
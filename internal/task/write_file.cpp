@@ -1,26 +1,97 @@
 #include "write_file.hpp"
+#include <cerrno>
+#include <climits>
+#include <cstring>
 #include <unistd.h>
 
 IWriteFileCallback::~IWriteFileCallback() {}
 
-WriteFile::WriteFile(IOTaskManager &manager, int fd, const std::string &data_to_write, IWriteFileCallback *cb)
-    : IOTask(manager, fd), data_to_write_(data_to_write), cb_(cb) {
+WriteFile::WriteFile(IOTaskManager &manager, int fd, const std::string &data_to_write, IWriteFileCallback *cb, Ownership ownership, unsigned int timeout_ms)
+    : IOTask(manager, fd, kEventWrite),
+      data_to_write_(data_to_write),
+      own_segment_(),
+      segments_(&own_segment_),
+      segment_count_(1),
+      cb_(cb),
+      ownership_(ownership),
+      timeout_ms_(timeout_ms) {
+    own_segment_.iov_base = const_cast<char *>(data_to_write_.data());
+    own_segment_.iov_len = data_to_write_.size();
+    setTimeout(timeout_ms);
 }
 
+WriteFile::WriteFile(IOTaskManager &manager, int fd, struct iovec *segments, std::size_t segment_count, IWriteFileCallback *cb, Ownership ownership, unsigned int timeout_ms)
+    : IOTask(manager, fd, kEventWrite),
+      own_segment_(),
+      segments_(segments),
+      segment_count_(segment_count),
+      cb_(cb),
+      ownership_(ownership),
+      timeout_ms_(timeout_ms) {
+    setTimeout(timeout_ms);
+}
+
+// レスポンスごとに作られるので, 同じスレッドで解放されたメモリを使い回す
+void *WriteFile::operator new(std::size_t size) {
+    return FreeList<WriteFile>::allocate(size);
+}
+
+void WriteFile::operator delete(void *ptr, std::size_t size) {
+    FreeList<WriteFile>::deallocate(ptr, size);
+}
+
+// 書けるだけ書き, ソケットのバッファが埋まったら書き込み可能になるまで中断する
 Result<IOTaskResult, std::string> WriteFile::execute() {
-    write(fd_, data_to_write_.c_str(), data_to_write_.size());
+    advance(0);
+    while (segment_count_ > 0) {
+        // 1 回の writev に渡せる数には上限がある
+        const std::size_t count = segment_count_ < static_cast<std::size_t>(IOV_MAX) ? segment_count_ : IOV_MAX;
+        const ssize_t written = writev(fd_, segments_, static_cast<int>(count));
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return Ok(kTaskSuspend);
+            }
+            return fail(std::string("failed to write response: ") + std::strerror(errno));
+        }
+        advance(static_cast<std::size_t>(written));
+        // 進んでいる間は遅いクライアントとみなさない
+        setTimeout(timeout_ms_);
+    }
     if (cb_ != NULL)
         cb_->trigger();
     return Ok(kTaskComplete);
 }
 
-WriteFile::~WriteFile() {
-    delete cb_;
+// 書き終えたセグメントを飛ばし, 途中まで書いたセグメントは残りを指すように詰める
+// 空のセグメントも飛ばすので, segment_count_ が 0 でなければ先頭は 1 byte 以上残っている
+void WriteFile::advance(std::size_t written) {
+    while (segment_count_ > 0 && written >= segments_->iov_len) {
+        written -= segments_->iov_len;
+        segments_++;
+        segment_count_--;
+    }
+    if (segment_count_ > 0) {
+        segments_->iov_base = static_cast<char *>(segments_->iov_base) + written;
+        segments_->iov_len -= written;
+    }
 }
 
-CloseConnectionCallback::CloseConnectionCallback(IContext *ctx) : ctx_(ctx) {}
+Result<IOTaskResult, std::string> WriteFile::fail(const std::string &error) {
+    if (cb_ != NULL) {
+        cb_->triggerError(error);
+    }
+    return Err(error);
+}
 
-Result<types::Unit, std::string> CloseConnectionCallback::trigger() {
-    close(ctx_->getClientFd());
-    return Ok(unit);
+Result<IOTaskResult, std::string> WriteFile::onTimeout() {
+    return fail("timed out writing response");
+}
+
+WriteFile::~WriteFile() {
+    if (ownership_ == kOwnMove) {
+        delete cb_;
+    }
 }
@@ -4,32 +4,51 @@
 #include "callback_interface.hpp"
 #include "http/interface/context.hpp"
 #include "io_task_manager.hpp"
+#include "utils/free_list.hpp"
+#include "utils/ownership.hpp"
+#include <sys/uio.h>
 
 // NOLINTNEXTLINE(cppcoreguidelines-special-member-functions)
 class IWriteFileCallback {
 public:
     virtual ~IWriteFileCallback();
     virtual Result<types::Unit, std::string> trigger() = 0;
+    // Called when the data cannot be written, e.g. timed out
+    virtual Result<types::Unit, std::string> triggerError(const std::string &error) = 0;
 };
 
-class CloseConnectionCallback : public IWriteFileCallback {
-public:
-    explicit CloseConnectionCallback(IContext *ctx);
-    Result<types::Unit, std::string> trigger();
-
-private:
-    IContext *ctx_;
-};
-
+// Writes everything without blocking, suspending on EAGAIN until fd becomes writable again
+// cb is triggered only after the last byte has been written
+// The memory of finished tasks is reused for the next ones created on the same thread
 class WriteFile : public IOTask {
 public:
-    WriteFile(IOTaskManager &manager, int fd, const std::string &data_to_write, IWriteFileCallback *cb);
+    // Delete cb after the task if ownership is kOwnMove
+    // Fail if no progress is made for timeout_ms (0 disables)
+    WriteFile(IOTaskManager &manager, int fd, const std::string &data_to_write, IWriteFileCallback *cb, Ownership ownership = kOwnMove, unsigned int timeout_ms = 0);
+    // Write the segments in order with writev without copying them
+    // segments and the memory they point to must be valid until the task is deleted
+    // segments are advanced in place as they are written
+    WriteFile(IOTaskManager &manager, int fd, struct iovec *segments, std::size_t segment_count, IWriteFileCallback *cb, Ownership ownership = kOwnMove, unsigned int timeout_ms = 0);
     ~WriteFile();
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, std::size_t size);
     virtual Result<IOTaskResult, std::string> execute();
+    virtual Result<IOTaskResult, std::string> onTimeout();
 
 private:
+    // Empty if the segments are borrowed
     const std::string data_to_write_;
+    // Points to data_to_write_ unless the segments are borrowed
+    struct iovec own_segment_;
+    // The segments not yet written. The first one starts at the resume offset
+    struct iovec *segments_;
+    std::size_t segment_count_;
     IWriteFileCallback *cb_;
+    Ownership ownership_;
+    unsigned int timeout_ms_;
+
+    void advance(std::size_t written);
+    Result<IOTaskResult, std::string> fail(const std::string &error);
 };
 
 #endif
@@ -0,0 +1,28 @@
+#ifndef INTERNAL_UTILS_ALIGNED_STORAGE_HPP
+#define INTERNAL_UTILS_ALIGNED_STORAGE_HPP
+
+#include <cstddef>
+
+namespace types {
+    // Uninitialized storage of Size bytes, aligned for any scalar type
+    // C++98 has neither alignas nor std::aligned_storage, so the alignment comes from the union members
+    // Objects are constructed with placement new and destroyed explicitly by the owner
+    template<std::size_t Size>
+    union AlignedStorage {
+        char data[Size];
+        long double align_long_double;
+        long long align_long_long;
+        void *align_pointer;
+        void (*align_function_pointer)();
+
+        void *get() {
+            return data;
+        }
+
+        const void *get() const {
+            return data;
+        }
+    };
+} // namespace types
+
+#endif //INTERNAL_UTILS_ALIGNED_STORAGE_HPP
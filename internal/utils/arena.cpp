@@ -0,0 +1,104 @@
+#include "arena.hpp"
+#include "utils/aligned_storage.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace {
+    // どの型のオブジェクトも置けるよう, 最も厳しいアラインメントに揃える
+    const std::size_t kAlignment = sizeof(types::AlignedStorage<1>);
+
+    std::size_t alignUp(std::size_t size) {
+        return (size + kAlignment - 1) / kAlignment * kAlignment;
+    }
+} // namespace
+
+const std::size_t Arena::kDefaultChunkSize;
+const std::size_t Arena::kMaxRetainedCapacity;
+
+Arena::Arena(std::size_t chunk_size)
+    : chunk_size_(chunk_size), chunks_(NULL), pos_(NULL), end_(NULL), capacity_(0) {}
+
+Arena::~Arena() {
+    freeChunks();
+}
+
+void *Arena::allocate(std::size_t size) {
+    size = alignUp(size);
+    if (static_cast<std::size_t>(end_ - pos_) < size) {
+        // 使い切ったチャンクの残りは捨て, 全体の大きさを倍にする
+        addChunk(capacity_ > size ? capacity_ : size);
+    }
+    char *ptr = pos_;
+    pos_ += size;
+    return ptr;
+}
+
+StringView Arena::copy(const StringView &str) {
+    if (str.empty()) {
+        return StringView();
+    }
+    char *ptr = static_cast<char *>(allocate(str.size()));
+    std::memcpy(ptr, str.data(), str.size());
+    return StringView(ptr, str.size());
+}
+
+// 複数のチャンクを使った場合は 1 つにまとめ, 次のリクエストでは途中で確保しないようにする
+// 大きすぎる場合は 1 つの大きなリクエストのためにメモリを持ち続けないよう, 最初の大きさのチャンクに戻す
+void Arena::reset() {
+    if (capacity_ > kMaxRetainedCapacity) {
+        freeChunks();
+        addChunk(chunk_size_);
+    } else if (chunks_ != NULL && chunks_->next != NULL) {
+        const std::size_t capacity = capacity_;
+        freeChunks();
+        addChunk(capacity);
+    }
+    if (chunks_ != NULL) {
+        pos_ = chunkData(chunks_);
+        end_ = pos_ + chunks_->size;
+    }
+}
+
+std::size_t Arena::capacity() const {
+    return capacity_;
+}
+
+// チャンクのポインタを入れ替えるだけで, メモリは動かない
+void Arena::swap(Arena &other) {
+    std::swap(chunk_size_, other.chunk_size_);
+    std::swap(chunks_, other.chunks_);
+    std::swap(pos_, other.pos_);
+    std::swap(end_, other.end_);
+    std::swap(capacity_, other.capacity_);
+}
+
+void Arena::addChunk(std::size_t size) {
+    if (size < chunk_size_) {
+        size = chunk_size_;
+    }
+    size = alignUp(size);
+    Chunk *chunk = static_cast<Chunk *>(::operator new(alignUp(sizeof(Chunk)) + size));
+    chunk->next = chunks_;
+    chunk->size = size;
+    chunks_ = chunk;
+    pos_ = chunkData(chunk);
+    end_ = pos_ + size;
+    capacity_ += size;
+}
+
+void Arena::freeChunks() {
+    while (chunks_ != NULL) {
+        Chunk *next = chunks_->next;
+        ::operator delete(chunks_);
+        chunks_ = next;
+    }
+    pos_ = NULL;
+    end_ = NULL;
+    capacity_ = 0;
+}
+
+// チャンクの先頭の管理領域の後ろから使う
+char *Arena::chunkData(Chunk *chunk) {
+    return reinterpret_cast<char *>(chunk) + alignUp(sizeof(Chunk));
+}
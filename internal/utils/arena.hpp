@@ -0,0 +1,53 @@
+#ifndef INTERNAL_UTILS_ARENA_HPP
+#define INTERNAL_UTILS_ARENA_HPP
+
+#include "utils/string_view.hpp"
+#include <cstddef>
+
+// Bump-pointer allocator for memory that lives as long as one request
+// allocate() hands out consecutive pieces of a chunk, nothing is freed individually,
+// and reset() releases everything at once
+// The chunks are kept across reset(). If the last use needed more than one, they are merged into
+// one as large as all of them, so once the arena has grown to the largest request, allocating never calls malloc
+// Past kMaxRetainedCapacity only one chunk of the initial size is kept, so one large request does not pin its memory
+class Arena {
+public:
+    static const std::size_t kDefaultChunkSize = 4096;
+    static const std::size_t kMaxRetainedCapacity = 64 * 1024;
+
+    explicit Arena(std::size_t chunk_size = kDefaultChunkSize);
+    ~Arena();
+    // Aligned for any scalar type
+    void *allocate(std::size_t size);
+    // The copy is valid until reset(). Empty strings are not copied
+    StringView copy(const StringView &str);
+    // Invalidate everything allocated, keeping the chunks up to kMaxRetainedCapacity
+    void reset();
+    // Total size of the chunks in bytes
+    std::size_t capacity() const;
+    // Exchange the chunks. What was allocated stays valid and now belongs to the other arena
+    void swap(Arena &other);
+
+private:
+    // Followed by size bytes of memory to hand out
+    struct Chunk {
+        Chunk *next;
+        std::size_t size;
+    };
+
+    std::size_t chunk_size_;
+    // The chunk being used first, then the older ones
+    Chunk *chunks_;
+    char *pos_;
+    char *end_;
+    std::size_t capacity_;
+
+    void addChunk(std::size_t size);
+    void freeChunks();
+    static char *chunkData(Chunk *chunk);
+
+    Arena(const Arena &other);
+    Arena &operator=(const Arena &other);
+};
+
+#endif //INTERNAL_UTILS_ARENA_HPP
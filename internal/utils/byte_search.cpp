@@ -0,0 +1,25 @@
+#include "byte_search.hpp"
+#include <cstring>
+
+// memchr で先頭のバイトを探してから残りを比べる
+const char *utils::searchBytes(const char *haystack, std::size_t len, const char *needle, std::size_t needle_len) {
+    if (needle_len == 0) {
+        return haystack;
+    }
+    if (len < needle_len) {
+        return NULL;
+    }
+    const char *end = haystack + len - needle_len + 1;
+    for (const char *p = haystack; p < end;) {
+        const void *found = std::memchr(p, needle[0], end - p);
+        if (found == NULL) {
+            return NULL;
+        }
+        const char *candidate = static_cast<const char *>(found);
+        if (std::memcmp(candidate + 1, needle + 1, needle_len - 1) == 0) {
+            return candidate;
+        }
+        p = candidate + 1;
+    }
+    return NULL;
+}
@@ -0,0 +1,14 @@
+#ifndef INTERNAL_UTILS_BYTE_SEARCH_HPP
+#define INTERNAL_UTILS_BYTE_SEARCH_HPP
+
+#include <cstddef>
+
+namespace utils {
+    // Returns the first occurrence of needle[0, needle_len) in haystack[0, len), or NULL
+    // An empty needle matches at haystack. Never allocates and never reads outside the ranges
+    // Finds the candidates for the first byte with memchr, which libc already vectorizes,
+    // so a single-byte needle such as the "\n" BufferedReader looks for is a plain memchr
+    const char *searchBytes(const char *haystack, std::size_t len, const char *needle, std::size_t needle_len);
+} // namespace utils
+
+#endif //INTERNAL_UTILS_BYTE_SEARCH_HPP
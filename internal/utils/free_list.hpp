@@ -0,0 +1,50 @@
+#ifndef INTERNAL_UTILS_FREE_LIST_HPP
+#define INTERNAL_UTILS_FREE_LIST_HPP
+
+#include <cstddef>
+#include <new>
+
+// Keeps the memory of deleted objects of T for the next ones created on the same thread
+// For objects created and deleted for every request, e.g. tasks, used from the class-specific operator new / delete
+// Each worker thread keeps as many blocks as it once had alive at the same time. They are never returned to the system
+// Derived classes of a different size are allocated with the global operator new
+template<class T>
+class FreeList {
+public:
+    static void *allocate(std::size_t size) {
+        if (size != sizeof(T) || head_ == NULL) {
+            return ::operator new(size < sizeof(Node) ? sizeof(Node) : size);
+        }
+        Node *node = head_;
+        head_ = node->next;
+        return node;
+    }
+
+    static void deallocate(void *ptr, std::size_t size) {
+        if (ptr == NULL) {
+            return;
+        }
+        if (size != sizeof(T)) {
+            ::operator delete(ptr);
+            return;
+        }
+        Node *node = static_cast<Node *>(ptr);
+        node->next = head_;
+        head_ = node;
+    }
+
+private:
+    struct Node {
+        Node *next;
+    };
+
+    // Worker threads never share objects, so each has its own list
+    static __thread Node *head_;
+
+    FreeList();
+};
+
+template<class T>
+__thread typename FreeList<T>::Node *FreeList<T>::head_ = NULL;
+
+#endif //INTERNAL_UTILS_FREE_LIST_HPP
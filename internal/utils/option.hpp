@@ -1,7 +1,9 @@
 #ifndef INTERNAL_UTILS_OPTION_HPP
 #define INTERNAL_UTILS_OPTION_HPP
 
+#include "utils/aligned_storage.hpp"
 #include <cstddef>
+#include <new>
 #include <stdexcept>
 
 template<class T>
@@ -11,26 +13,24 @@ namespace types {
     template<class T>
     class Some {
     public:
-        explicit Some(T val) : val_(val) {}
+        explicit Some(const T &val) : val_(val) {}
 
-        Some(const Some &other) {
-            *this = other;
-        }
+        Some(const Some &other) : val_(other.val_) {}
 
         ~Some() {}
 
         Some &operator=(const Some &other) {
-            if (*this != other) {
+            if (this != &other) {
                 val_ = other.val_;
             }
             return *this;
         }
 
         operator Option<T>() const { // NOLINT(google-explicit-constructor)
-            return Option<T>(new Some<T>(val_));
+            return Option<T>(*this);
         }
 
-        T val() const {
+        const T &val() const {
             return val_;
         }
 
@@ -60,7 +60,7 @@ namespace types {
 
         template<class T>
         operator Option<T>() const { // NOLINT(google-explicit-constructor)
-            return Option<T>(NULL);
+            return Option<T>(*this);
         }
     };
 } // namespace types
@@ -73,31 +73,38 @@ types::Some<T> Some(T val) { // NOLINT(readability-identifier-naming)
 // NOLINTNEXTLINE(readability-identifier-naming)
 const types::None None = types::None();
 
+// The value lives in inline storage, so constructing or copying an Option never allocates by itself
 template<class T>
 class Option {
 public:
-    explicit Option(types::Some<T> *some) : some_(some) {}
+    explicit Option(const types::Some<T> &some) : is_some_(false) {
+        construct(some.val());
+    }
 
-    explicit Option(types::None none) : some_(NULL) {
+    explicit Option(types::None none) : is_some_(false) {
         (void) none;
     }
 
-    Option(const Option &other) : some_(other.some_) {}
+    Option(const Option &other) : is_some_(false) {
+        if (other.isSome()) {
+            construct(other.ref());
+        }
+    }
 
     ~Option() {
-        delete some_;
+        destroy();
     }
 
     Option &operator=(const Option &other) {
-        if (this != &other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (isSome() && other.isSome()) {
+            ref() = other.ref();
+        } else {
+            destroy();
             if (other.isSome()) {
-                if (some_ != NULL) {
-                    *some_ = *other.some_;
-                } else {
-                    some_ = new types::Some<T>(*other.some_);
-                }
-            } else {
-                some_ = NULL;
+                construct(other.ref());
             }
         }
         return *this;
@@ -110,7 +117,7 @@ public:
         if (isNone()) {
             return true;
         }
-        return *some_ == *other.some_;
+        return ref() == other.ref();
     }
 
     bool operator!=(const Option &other) const {
@@ -120,27 +127,34 @@ public:
         if (isNone()) {
             return false;
         }
-        return *some_ != *other.some_;
+        return ref() != other.ref();
     }
 
     bool isSome() const {
-        return some_ != NULL;
+        return is_some_;
     }
 
     bool isNone() const {
-        return some_ == NULL;
+        return !is_some_;
+    }
+
+    const T &unwrap() const {
+        if (isNone()) {
+            throw std::runtime_error("called `Option::unwrap()` on `None`");
+        }
+        return ref();
     }
 
-    T unwrap() const {
+    T &unwrap() {
         if (isNone()) {
             throw std::runtime_error("called `Option::unwrap()` on `None`");
         }
-        return some_->val();
+        return ref();
     }
 
-    T unwrapOr(T val) const {
+    T unwrapOr(const T &val) const {
         if (isSome())
-            return some_->val();
+            return ref();
         return val;
     }
 
@@ -149,7 +163,28 @@ public:
     }
 
 private:
-    types::Some<T> *some_;
+    types::AlignedStorage<sizeof(T)> storage_;
+    bool is_some_;
+
+    void construct(const T &val) {
+        new (storage_.get()) T(val);
+        is_some_ = true;
+    }
+
+    void destroy() {
+        if (isSome()) {
+            ref().~T();
+        }
+        is_some_ = false;
+    }
+
+    T &ref() {
+        return *static_cast<T *>(storage_.get());
+    }
+
+    const T &ref() const {
+        return *static_cast<const T *>(storage_.get());
+    }
 };
 
 #endif
@@ -1,7 +1,9 @@
 #ifndef INTERNAL_UTILS_RESULT_HPP
 #define INTERNAL_UTILS_RESULT_HPP
 
+#include "utils/aligned_storage.hpp"
 #include <cstddef>
+#include <new>
 #include <stdexcept>
 
 template<class T, class E>
@@ -11,7 +13,7 @@ namespace types {
     template<class T>
     class Ok {
     public:
-        explicit Ok(T val) : val_(val) {}
+        explicit Ok(const T &val) : val_(val) {}
 
         Ok(const Ok &other) : val_(other.val_) {}
 
@@ -24,7 +26,7 @@ namespace types {
             return *this;
         }
 
-        T val() {
+        const T &val() const {
             return val_;
         }
 
@@ -43,7 +45,7 @@ namespace types {
     template<class E>
     class Err {
     public:
-        explicit Err(E error) : error_(error) {}
+        explicit Err(const E &error) : error_(error) {}
 
         Err(const Err &other) : error_(other.error_) {}
 
@@ -56,7 +58,7 @@ namespace types {
             return *this;
         }
 
-        E error() {
+        const E &error() const {
             return error_;
         }
 
@@ -83,49 +85,52 @@ types::Err<E> Err(E val) { // NOLINT(readability-identifier-naming)
     return types::Err<E>(val);
 }
 
+// Tagged union of T and E
+// The value lives in inline storage, so constructing or copying a Result never allocates by itself
 template<class T, class E>
 class Result {
 public:
-    Result() : ok_(NULL), err_(NULL) {}
-
-    explicit Result(types::Ok<T> *ok) : ok_(ok), err_(NULL) {}
-
-    explicit Result(types::Err<E> *err) : ok_(NULL), err_(err) {}
+    Result() : state_(kStateEmpty) {}
 
     // Result<int, std::string> target = Ok(0); みたいなことができるようにexplicitをつけない
     // NOLINTNEXTLINE(google-explicit-constructor)
-    Result(types::Ok<T> ok) : ok_(new types::Ok<T>(ok)), err_(NULL) {}
+    Result(const types::Ok<T> &ok) : state_(kStateEmpty) {
+        constructOk(ok.val());
+    }
 
     // Result<int, std::string> target = Err<std::string>("error"); みたいなことができるようにexplicitをつけない
     // NOLINTNEXTLINE(google-explicit-constructor)
-    Result(types::Err<E> err) : ok_(NULL), err_(new types::Err<E>(err)) {}
+    Result(const types::Err<E> &err) : state_(kStateEmpty) {
+        constructErr(err.error());
+    }
 
-    Result(const Result &other) {
-        this->ok_ = other.isOk() ? new types::Ok<T>(*other.ok_) : NULL;
-        this->err_ = other.isErr() ? new types::Err<E>(*other.err_) : NULL;
+    Result(const Result &other) : state_(kStateEmpty) {
+        if (other.isOk()) {
+            constructOk(other.okRef());
+        } else if (other.isErr()) {
+            constructErr(other.errRef());
+        }
     }
 
     ~Result() {
-        delete ok_;
-        delete err_;
+        destroy();
     }
 
     Result &operator=(const Result &other) {
-        if (this != &other) {
+        if (this == &other) {
+            return *this;
+        }
+        // 同じ状態なら代入で済ませ, 異なる場合のみ作り直す
+        if (isOk() && other.isOk()) {
+            okRef() = other.okRef();
+        } else if (isErr() && other.isErr()) {
+            errRef() = other.errRef();
+        } else {
+            destroy();
             if (other.isOk()) {
-                if (ok_ == NULL) {
-                    ok_ = new types::Ok<T>(*other.ok_);
-                } else {
-                    *ok_ = *other.ok_;
-                }
-                err_ = NULL;
+                constructOk(other.okRef());
             } else if (other.isErr()) {
-                if (err_ == NULL) {
-                    err_ = new types::Err<E>(*other.err_);
-                } else {
-                    *err_ = *other.err_;
-                }
-                ok_ = NULL;
+                constructErr(other.errRef());
             }
         }
         return *this;
@@ -133,50 +138,57 @@ public:
 
     bool operator==(const Result &other) const {
         if (isOk() && other.isOk()) {
-            return *ok_ == *other.ok_;
+            return okRef() == other.okRef();
         }
         if (isErr() && other.isErr()) {
-            return *err_ == *other.err_;
+            return errRef() == other.errRef();
         }
         return false;
     }
 
     bool operator!=(const Result &other) const {
         if (isOk() && other.isOk()) {
-            return *ok_ != *other.ok_;
+            return okRef() != other.okRef();
         }
         if (isErr() && other.isErr()) {
-            return *err_ != *other.err_;
+            return errRef() != other.errRef();
         }
         return true;
     }
 
     bool isOk() const {
-        return ok_ != NULL;
+        return state_ == kStateOk;
     }
 
     bool isErr() const {
-        return err_ != NULL;
+        return state_ == kStateErr;
     }
 
-    T unwrap() const {
-        if (isErr()) {
+    const T &unwrap() const {
+        if (!isOk()) {
             throw std::runtime_error("called `Result::unwrap()` on an `Err` value");
         }
-        return ok_->val();
+        return okRef();
     }
 
-    T unwrapOr(T val) const {
+    T &unwrap() {
+        if (!isOk()) {
+            throw std::runtime_error("called `Result::unwrap()` on an `Err` value");
+        }
+        return okRef();
+    }
+
+    T unwrapOr(const T &val) const {
         if (isOk())
-            return ok_->val();
+            return okRef();
         return val;
     }
 
-    E unwrapErr() const {
-        if (isOk()) {
+    const E &unwrapErr() const {
+        if (!isErr()) {
             throw std::runtime_error("called `Result::unwrapErr()` on an `Ok` value");
         }
-        return err_->error();
+        return errRef();
     }
 
     bool canUnwrap() const {
@@ -184,13 +196,57 @@ public:
     }
 
 private:
-    types::Ok<T> *ok_;
-    types::Err<E> *err_;
+    enum State {
+        kStateEmpty,
+        kStateOk,
+        kStateErr,
+    };
+
+    static const std::size_t kStorageSize = sizeof(T) > sizeof(E) ? sizeof(T) : sizeof(E);
+
+    types::AlignedStorage<kStorageSize> storage_;
+    State state_;
+
+    void constructOk(const T &val) {
+        new (storage_.get()) T(val);
+        state_ = kStateOk;
+    }
+
+    void constructErr(const E &error) {
+        new (storage_.get()) E(error);
+        state_ = kStateErr;
+    }
+
+    void destroy() {
+        if (isOk()) {
+            okRef().~T();
+        } else if (isErr()) {
+            errRef().~E();
+        }
+        state_ = kStateEmpty;
+    }
+
+    T &okRef() {
+        return *static_cast<T *>(storage_.get());
+    }
+
+    const T &okRef() const {
+        return *static_cast<const T *>(storage_.get());
+    }
+
+    E &errRef() {
+        return *static_cast<E *>(storage_.get());
+    }
+
+    const E &errRef() const {
+        return *static_cast<const E *>(storage_.get());
+    }
 };
 
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
 #define TRY(expr) TRY_OR(expr, Err((e).unwrapErr()))
 
+// 値は statement expression の結果としてコピーされるので, e の寿命が尽きても問題ない
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
 #define TRY_OR(expr, defaultValue) ({          \
     typeof(expr) e = (expr);                   \
@@ -0,0 +1,99 @@
+#include "string_view.hpp"
+#include <algorithm>
+#include <cstring>
+
+const std::size_t StringView::npos;
+
+StringView::StringView() : data_(""), size_(0) {}
+
+StringView::StringView(const char *data, std::size_t size) : data_(data), size_(size) {}
+
+StringView::StringView(const char *str) : data_(str), size_(std::strlen(str)) {}
+
+StringView::StringView(const std::string &str) : data_(str.data()), size_(str.size()) {}
+
+const char *StringView::data() const {
+    return data_;
+}
+
+std::size_t StringView::size() const {
+    return size_;
+}
+
+bool StringView::empty() const {
+    return size_ == 0;
+}
+
+char StringView::operator[](std::size_t pos) const {
+    return data_[pos];
+}
+
+StringView StringView::substr(std::size_t pos, std::size_t n) const {
+    if (pos > size_) {
+        pos = size_;
+    }
+    return StringView(data_ + pos, std::min(n, size_ - pos));
+}
+
+std::size_t StringView::find(char c, std::size_t pos) const {
+    if (pos >= size_) {
+        return npos;
+    }
+    const void *found = std::memchr(data_ + pos, c, size_ - pos);
+    return found == NULL ? npos : static_cast<const char *>(found) - data_;
+}
+
+std::size_t StringView::rfind(char c) const {
+    for (std::size_t i = size_; i > 0; i--) {
+        if (data_[i - 1] == c) {
+            return i - 1;
+        }
+    }
+    return npos;
+}
+
+std::size_t StringView::findFirstNotOf(const StringView &chars) const {
+    for (std::size_t i = 0; i < size_; i++) {
+        if (chars.find(data_[i]) == npos) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+std::size_t StringView::findLastNotOf(const StringView &chars) const {
+    for (std::size_t i = size_; i > 0; i--) {
+        if (chars.find(data_[i - 1]) == npos) {
+            return i - 1;
+        }
+    }
+    return npos;
+}
+
+bool StringView::startsWith(const StringView &prefix) const {
+    return size_ >= prefix.size_ && std::memcmp(data_, prefix.data_, prefix.size_) == 0;
+}
+
+bool StringView::endsWith(const StringView &suffix) const {
+    return size_ >= suffix.size_ && std::memcmp(data_ + size_ - suffix.size_, suffix.data_, suffix.size_) == 0;
+}
+
+void StringView::removeSuffix(std::size_t n) {
+    size_ -= std::min(n, size_);
+}
+
+std::string StringView::toString() const {
+    return std::string(data_, size_);
+}
+
+bool operator==(const StringView &lhs, const StringView &rhs) {
+    return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+bool operator!=(const StringView &lhs, const StringView &rhs) {
+    return !(lhs == rhs);
+}
+
+std::ostream &operator<<(std::ostream &os, const StringView &view) {
+    return os.write(view.data(), static_cast<std::streamsize>(view.size()));
+}
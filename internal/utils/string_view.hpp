@@ -0,0 +1,44 @@
+#ifndef INTERNAL_UTILS_STRING_VIEW_HPP
+#define INTERNAL_UTILS_STRING_VIEW_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+// Non-owning reference to a sequence of chars, like std::string_view in C++17
+// The referenced chars must outlive the view
+class StringView {
+public:
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    StringView();
+    StringView(const char *data, std::size_t size);
+    StringView(const char *str);        // NOLINT(google-explicit-constructor)
+    StringView(const std::string &str); // NOLINT(google-explicit-constructor)
+
+    const char *data() const;
+    std::size_t size() const;
+    bool empty() const;
+    char operator[](std::size_t pos) const;
+    // Clamped to the end of the view like std::string::substr, but never throws
+    StringView substr(std::size_t pos, std::size_t n = npos) const;
+    std::size_t find(char c, std::size_t pos = 0) const;
+    std::size_t rfind(char c) const;
+    std::size_t findFirstNotOf(const StringView &chars) const;
+    std::size_t findLastNotOf(const StringView &chars) const;
+    bool startsWith(const StringView &prefix) const;
+    bool endsWith(const StringView &suffix) const;
+    // Drop n chars from the end
+    void removeSuffix(std::size_t n);
+    std::string toString() const;
+
+private:
+    const char *data_;
+    std::size_t size_;
+};
+
+bool operator==(const StringView &lhs, const StringView &rhs);
+bool operator!=(const StringView &lhs, const StringView &rhs);
+std::ostream &operator<<(std::ostream &os, const StringView &view);
+
+#endif //INTERNAL_UTILS_STRING_VIEW_HPP
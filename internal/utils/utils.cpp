@@ -1,6 +1,61 @@
 #include "utils.hpp"
+#include "byte_search.hpp"
 #include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
+
+// 下の桁から 2 桁ずつ表で引いて一時領域の後ろから埋め, 最後にまとめてコピーする
+std::size_t utils::formatDecimal(char *out, unsigned long value) {
+    static const char kDigitPairs[] = "00010203040506070809"
+                                      "10111213141516171819"
+                                      "20212223242526272829"
+                                      "30313233343536373839"
+                                      "40414243444546474849"
+                                      "50515253545556575859"
+                                      "60616263646566676869"
+                                      "70717273747576777879"
+                                      "80818283848586878889"
+                                      "90919293949596979899";
+    char digits[kMaxDecimalDigits];
+    std::size_t pos = kMaxDecimalDigits;
+    while (value >= 100) {
+        const std::size_t pair = static_cast<std::size_t>(value % 100) * 2;
+        value /= 100;
+        digits[--pos] = kDigitPairs[pair + 1];
+        digits[--pos] = kDigitPairs[pair];
+    }
+    if (value >= 10) {
+        const std::size_t pair = static_cast<std::size_t>(value) * 2;
+        digits[--pos] = kDigitPairs[pair + 1];
+        digits[--pos] = kDigitPairs[pair];
+    } else {
+        digits[--pos] = static_cast<char>('0' + value);
+    }
+    const std::size_t size = kMaxDecimalDigits - pos;
+    std::memcpy(out, digits + pos, size);
+    return size;
+}
+
+// 桁を足す前に溢れないかを確かめる
+Option<unsigned long> utils::parseDecimal(const StringView &str) {
+    if (str.empty()) {
+        return None;
+    }
+    const unsigned long max = std::numeric_limits<unsigned long>::max();
+    unsigned long value = 0;
+    for (std::size_t i = 0; i < str.size(); i++) {
+        if (str[i] < '0' || str[i] > '9') {
+            return None;
+        }
+        const unsigned long digit = static_cast<unsigned long>(str[i] - '0');
+        if (value > (max - digit) / 10) {
+            return None;
+        }
+        value = value * 10 + digit;
+    }
+    return Some(value);
+}
 
 bool utils::startsWith(const std::string &str, const std::string &prefix) {
     return str.find(prefix) == 0;
@@ -33,16 +88,14 @@ Result<unsigned long, std::string> utils::stoul(const std::string &str) {
     return Ok(result);
 }
 
-// TODO: コピーを避ける
 Option<char *> utils::strnstr(const char *haystack, const char *needle, std::size_t len) {
     if (haystack == NULL || needle == NULL) {
         return None;
     }
 
-    std::string haystack_str(haystack, len);
-    std::size_t pos = haystack_str.find(needle);
-    if (pos == std::string::npos) {
+    const char *found = searchBytes(haystack, len, needle, std::strlen(needle));
+    if (found == NULL) {
         return None;
     }
-    return Some(const_cast<char *>(haystack + pos));
+    return Some(const_cast<char *>(found));
 }
@@ -3,6 +3,7 @@
 
 #include "utils/option.hpp"
 #include "utils/result.hpp"
+#include "utils/string_view.hpp"
 #include <sstream>
 #include <string>
 
@@ -18,6 +19,15 @@ namespace utils {
         return ss.str();
     }
 
+    // Digits of the largest unsigned long (64 bit)
+    const std::size_t kMaxDecimalDigits = 20;
+
+    // Writes value in decimal to out without allocating and returns the number of digits
+    // out must have room for kMaxDecimalDigits characters. No terminating NUL is written
+    std::size_t formatDecimal(char *out, unsigned long value);
+    // Reads str as a decimal without allocating. None if it is empty, has a non-digit or overflows
+    Option<unsigned long> parseDecimal(const StringView &str);
+
     bool startsWith(const std::string &str, const std::string &prefix);
     bool endsWith(const std::string &str, const std::string &suffix);
 
@@ -0,0 +1,197 @@
+#include "task/accept.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+// 受け入れたクライアントを記録するコールバック
+class RecordingAcceptCallback : public IAcceptCallback {
+public:
+    explicit RecordingAcceptCallback(std::vector<int> &client_fds) : client_fds_(client_fds) {}
+
+    Result<types::Unit, std::string> trigger(int client_fd) override {
+        client_fds_.push_back(client_fd);
+        return Ok(unit);
+    }
+
+private:
+    std::vector<int> &client_fds_;
+};
+
+// 登録されているタスクを記録するマネージャー
+class RecordingIOTaskManager : public IOTaskManager {
+public:
+    void addTask(IOTask *task) override {
+        tasks_.insert(task);
+        IOTaskManager::addTask(task);
+    }
+
+    void removeTask(IOTask *task) override {
+        tasks_.erase(task);
+        IOTaskManager::removeTask(task);
+    }
+
+    bool isRegistered(IOTask *task) const {
+        return tasks_.count(task) > 0;
+    }
+
+private:
+    std::set<IOTask *> tasks_;
+};
+
+// 生きている間はプロセスの fd を使い切った状態にする
+// テストが途中で失敗しても, fd と上限はデストラクタで元に戻る
+class OutOfFds {
+public:
+    explicit OutOfFds(int fd) {
+        EXPECT_EQ(getrlimit(RLIMIT_NOFILE, &original_), 0);
+        // 既に開いている fd の数によらず, 空いている番号の少し先までに制限する
+        const int first_free = dup(fd);
+        EXPECT_NE(first_free, -1);
+        close(first_free);
+        struct rlimit limited = original_;
+        limited.rlim_cur = first_free + 16;
+        limited_ = setrlimit(RLIMIT_NOFILE, &limited) == 0;
+        EXPECT_TRUE(limited_);
+        for (int filler = dup(fd); filler != -1; filler = dup(fd)) {
+            fillers_.push_back(filler);
+        }
+    }
+
+    ~OutOfFds() {
+        for (std::size_t i = 0; i < fillers_.size(); i++) {
+            close(fillers_[i]);
+        }
+        if (limited_) {
+            setrlimit(RLIMIT_NOFILE, &original_);
+        }
+    }
+
+    OutOfFds(const OutOfFds &) = delete;
+    OutOfFds &operator=(const OutOfFds &) = delete;
+
+private:
+    struct rlimit original_ = {};
+    bool limited_ = false;
+    std::vector<int> fillers_;
+};
+
+class AcceptTest : public ::testing::Test {
+protected:
+    RecordingIOTaskManager manager_;
+    int listen_fd_ = -1;
+    struct sockaddr_in addr_ = {};
+    std::vector<int> connected_fds_;
+    std::vector<int> accepted_fds_;
+
+    void SetUp() override {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        ASSERT_NE(listen_fd_, -1);
+        ASSERT_NE(fcntl(listen_fd_, F_SETFL, O_NONBLOCK), -1);
+        addr_.sin_family = AF_INET;
+        addr_.sin_port = 0;
+        addr_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(bind(listen_fd_, reinterpret_cast<struct sockaddr *>(&addr_), sizeof(addr_)), 0);
+        socklen_t len = sizeof(addr_);
+        ASSERT_EQ(getsockname(listen_fd_, reinterpret_cast<struct sockaddr *>(&addr_), &len), 0);
+        ASSERT_EQ(listen(listen_fd_, SOMAXCONN), 0);
+    }
+
+    void TearDown() override {
+        for (std::size_t i = 0; i < connected_fds_.size(); i++) {
+            close(connected_fds_[i]);
+        }
+        for (std::size_t i = 0; i < accepted_fds_.size(); i++) {
+            close(accepted_fds_[i]);
+        }
+        close(listen_fd_);
+    }
+
+    void connectClients(int n) {
+        for (int i = 0; i < n; i++) {
+            const int fd = socket(AF_INET, SOCK_STREAM, 0);
+            ASSERT_NE(fd, -1);
+            ASSERT_EQ(connect(fd, reinterpret_cast<struct sockaddr *>(&addr_), sizeof(addr_)), 0);
+            connected_fds_.push_back(fd);
+        }
+    }
+};
+
+TEST_F(AcceptTest, acceptsUpToBudgetPerWakeup) {
+    Accept *accept = new Accept(manager_, listen_fd_, new RecordingAcceptCallback(accepted_fds_), 2);
+    connectClients(5);
+
+    ASSERT_TRUE(manager_.executeReadyTasks(1000).isOk());
+    EXPECT_EQ(accepted_fds_.size(), 2);
+    ASSERT_TRUE(manager_.executeReadyTasks(1000).isOk());
+    EXPECT_EQ(accepted_fds_.size(), 4);
+    ASSERT_TRUE(manager_.executeReadyTasks(1000).isOk());
+    EXPECT_EQ(accepted_fds_.size(), 5);
+
+    // バックログが空になっても待ち受けは続く
+    ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+    connectClients(1);
+    ASSERT_TRUE(manager_.executeReadyTasks(1000).isOk());
+    EXPECT_EQ(accepted_fds_.size(), 6);
+    delete accept;
+}
+
+TEST_F(AcceptTest, acceptedSocketIsNonBlocking) {
+    Accept *accept = new Accept(manager_, listen_fd_, new RecordingAcceptCallback(accepted_fds_));
+    connectClients(1);
+
+    ASSERT_TRUE(manager_.executeReadyTasks(1000).isOk());
+    ASSERT_EQ(accepted_fds_.size(), 1);
+    EXPECT_TRUE(fcntl(accepted_fds_[0], F_GETFL) & O_NONBLOCK);
+    EXPECT_TRUE(fcntl(accepted_fds_[0], F_GETFD) & FD_CLOEXEC);
+    delete accept;
+}
+
+// fd を使い切っていても, 受け入れられない接続を切断してバックログを空にする
+TEST_F(AcceptTest, rejectsConnectionWhenOutOfFds) {
+    Accept *accept = new Accept(manager_, listen_fd_, new RecordingAcceptCallback(accepted_fds_));
+    connectClients(1);
+
+    {
+        const OutOfFds out_of_fds(listen_fd_);
+        ASSERT_TRUE(manager_.executeReadyTasks(1000).isOk());
+        EXPECT_EQ(accepted_fds_.size(), 0);
+        EXPECT_TRUE(manager_.isRegistered(accept));
+    }
+
+    char c;
+    const ssize_t n = recv(connected_fds_[0], &c, 1, MSG_DONTWAIT);
+    EXPECT_TRUE(n == 0 || (n == -1 && errno == ECONNRESET));
+    delete accept;
+}
+
+// 予備の fd もなければ, 空回りしないよう fd が空くまで待ち受けソケットの監視をやめる
+TEST_F(AcceptTest, backsOffWhenOutOfFdsWithoutReserve) {
+    connectClients(1);
+
+    Accept *accept = NULL;
+    {
+        const OutOfFds out_of_fds(listen_fd_);
+        // 予備の fd を開けない状態で作る
+        accept = new Accept(manager_, listen_fd_, new RecordingAcceptCallback(accepted_fds_));
+        EXPECT_TRUE(manager_.isRegistered(accept));
+
+        ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+        EXPECT_EQ(accepted_fds_.size(), 0);
+        EXPECT_FALSE(manager_.isRegistered(accept));
+    }
+
+    // 待ち時間が過ぎると再び監視して受け入れる
+    for (int i = 0; i < 10 && accepted_fds_.empty(); i++) {
+        ASSERT_TRUE(manager_.executeReadyTasks(Accept::kOutOfFdsBackoffMs).isOk());
+    }
+    EXPECT_TRUE(manager_.isRegistered(accept));
+    EXPECT_EQ(accepted_fds_.size(), 1);
+    delete accept;
+}
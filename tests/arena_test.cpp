@@ -0,0 +1,70 @@
+#include "allocation_counter.hpp"
+#include "utils/arena.hpp"
+#include <cstdint>
+#include <gtest/gtest.h>
+
+TEST(Arena, allocateAligned) {
+    Arena arena(64);
+    for (std::size_t size = 1; size < 32; size++) {
+        void *ptr = arena.allocate(size);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % sizeof(long double), 0) << size;
+    }
+}
+
+TEST(Arena, allocateLargerThanChunk) {
+    Arena arena(64);
+    char *ptr = static_cast<char *>(arena.allocate(1000));
+    ptr[999] = 'a';
+    EXPECT_GE(arena.capacity(), 1000);
+}
+
+TEST(Arena, copy) {
+    Arena arena;
+    std::string str = "Content-Length";
+    const StringView copied = arena.copy(str);
+    str[0] = 'X';
+    EXPECT_EQ(copied, StringView("Content-Length"));
+    EXPECT_EQ(arena.copy(""), StringView(""));
+}
+
+TEST(Arena, resetReusesMemory) {
+    Arena arena(64);
+    void *first = arena.allocate(16);
+    arena.allocate(16);
+    arena.reset();
+    EXPECT_EQ(arena.allocate(16), first);
+}
+
+// 複数のチャンクを使った後は 1 つにまとめられ, 同じ使い方なら次からは確保しない
+TEST(Arena, resetMergesChunks) {
+    Arena arena(64);
+    for (int i = 0; i < 10; i++) {
+        arena.allocate(48);
+    }
+    const std::size_t capacity = arena.capacity();
+    arena.reset();
+    EXPECT_EQ(arena.capacity(), capacity);
+
+    const AllocationCounter counter;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 10; i++) {
+            arena.allocate(48);
+        }
+        arena.reset();
+    }
+    EXPECT_EQ(counter.count(), 0);
+    EXPECT_EQ(arena.capacity(), capacity);
+}
+
+// 大きなリクエストの後は上限を超えて持ち続けず, 最初の大きさのチャンクに戻る
+TEST(Arena, resetShrinksPastRetainedCapacity) {
+    Arena arena(64);
+    arena.allocate(Arena::kMaxRetainedCapacity);
+    arena.allocate(Arena::kMaxRetainedCapacity);
+    EXPECT_GT(arena.capacity(), Arena::kMaxRetainedCapacity);
+
+    arena.reset();
+    EXPECT_EQ(arena.capacity(), 64);
+    char *ptr = static_cast<char *>(arena.allocate(16));
+    ptr[15] = 'a';
+}
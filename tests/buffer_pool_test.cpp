@@ -0,0 +1,86 @@
+#include "io/buffer_pool.hpp"
+#include "io/reader.hpp"
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+TEST(BufferPoolTest, reusesReleasedBuffer) {
+    BufferPool pool(16);
+    char *buf = pool.acquire();
+    EXPECT_EQ(pool.available(), 0U);
+    pool.release(buf);
+    EXPECT_EQ(pool.available(), 1U);
+    EXPECT_EQ(pool.acquire(), buf);
+    EXPECT_EQ(pool.available(), 0U);
+    pool.release(buf);
+}
+
+TEST(BufferPoolTest, keepsAtMostMaxFree) {
+    BufferPool pool(16, 2);
+    char *bufs[3] = {pool.acquire(), pool.acquire(), pool.acquire()};
+    for (int i = 0; i < 3; i++) {
+        pool.release(bufs[i]);
+    }
+    EXPECT_EQ(pool.available(), 2U);
+}
+
+class PooledBufferedReaderTest : public ::testing::Test {
+protected:
+    int fds_[2];
+
+    virtual void SetUp() {
+        ASSERT_EQ(pipe(fds_), 0);
+        ASSERT_NE(fcntl(fds_[0], F_SETFL, O_NONBLOCK), -1);
+    }
+
+    virtual void TearDown() {
+        close(fds_[0]);
+        close(fds_[1]);
+    }
+
+    void send(const std::string &data) {
+        ASSERT_EQ(write(fds_[1], data.c_str(), data.size()), static_cast<ssize_t>(data.size()));
+    }
+};
+
+// 読めるデータがない間はバッファを借りない
+TEST_F(PooledBufferedReaderTest, borrowsOnlyWhileDataIsBuffered) {
+    BufferPool pool(32);
+    pool.release(pool.acquire());
+    FdReader fd_reader(fds_[0]);
+    BufferedReader reader(&fd_reader, 32, 64, &pool);
+
+    EXPECT_TRUE(reader.readLineView("\r\n").unwrap().empty());
+    EXPECT_EQ(pool.available(), 1U);
+
+    send("GET / HTTP/1.1\r\nHost");
+    EXPECT_EQ(reader.readLineView("\r\n").unwrap(), StringView("GET / HTTP/1.1\r\n"));
+    EXPECT_EQ(pool.available(), 0U);
+    // 読み残しがある間は返さない
+    reader.releaseIdleBuffer();
+    EXPECT_EQ(pool.available(), 0U);
+
+    send(": a\r\n");
+    EXPECT_EQ(reader.readLineView("\r\n").unwrap(), StringView("Host: a\r\n"));
+    reader.releaseIdleBuffer();
+    EXPECT_EQ(pool.available(), 1U);
+}
+
+// 大きくしたバッファはプールに混ぜずに解放し, 次は元の大きさで借りる
+TEST_F(PooledBufferedReaderTest, grownBufferIsNotPooled) {
+    BufferPool pool(8);
+    FdReader fd_reader(fds_[0]);
+    BufferedReader reader(&fd_reader, 8, 64, &pool);
+
+    send("0123456789abcdef\r\n");
+    EXPECT_EQ(reader.readLineView("\r\n").unwrap(), StringView("0123456789abcdef\r\n"));
+    EXPECT_EQ(pool.available(), 1U);
+    reader.releaseIdleBuffer();
+    EXPECT_EQ(pool.available(), 1U);
+
+    send("x\r\n");
+    EXPECT_EQ(reader.readLineView("\r\n").unwrap(), StringView("x\r\n"));
+    EXPECT_EQ(pool.available(), 0U);
+    reader.reset();
+    EXPECT_EQ(pool.available(), 1U);
+}
@@ -214,6 +214,169 @@ TEST(BufferedReaderReadLineOk, buffering) {
     Verify(Method(stub, read)).Exactly(1_Times);
 }
 
+// バッファ内の行はコピーせずにバッファを指す
+TEST(BufferedReaderReadLineViewOk, viewIntoBuffer) {
+    Mock<IReader> stub;
+    Fake(Method(stub, eof));
+    When(Method(stub, read)).Do([](auto buf, auto) {
+        std::memcpy(buf, "123\n456\n", 8);
+        return Ok(8ul);
+    });
+
+    BufferedReader reader(&stub.get(), kBufferSize);
+    auto first = reader.readLineView("\n");
+    ASSERT_TRUE(first.isOk());
+    EXPECT_EQ(first.unwrap(), "123\n");
+    auto second = reader.readLineView("\n");
+    ASSERT_TRUE(second.isOk());
+    EXPECT_EQ(second.unwrap(), "456\n");
+    EXPECT_EQ(second.unwrap().data(), first.unwrap().data() + 4);
+}
+
+// 読み込みをまたぐ行はつなげて返す
+TEST(BufferedReaderReadLineViewOk, lineSpanningRefill) {
+    Mock<IReader> stub;
+    Fake(Method(stub, eof));
+    When(Method(stub, read))
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "12", 2);
+                return Ok(2ul);
+            })
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "34", 2);
+                return Ok(2ul);
+            })
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "5\n6\n", 4);
+                return Ok(4ul);
+            })
+            .Return(Ok(0ul));
+
+    BufferedReader reader(&stub.get(), kBufferSize);
+    auto result = reader.readLineView("\n");
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), "12345\n");
+    result = reader.readLineView("\n");
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), "6\n");
+}
+
+// 区切り文字が読み込みをまたぐ
+TEST(BufferedReaderReadLineViewOk, delimiterSpanningRefill) {
+    Mock<IReader> stub;
+    Fake(Method(stub, eof));
+    When(Method(stub, read))
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "123\r", 4);
+                return Ok(4ul);
+            })
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "\n456\r\n", 6);
+                return Ok(6ul);
+            })
+            .Return(Ok(0ul));
+
+    BufferedReader reader(&stub.get(), kBufferSize);
+    auto result = reader.readLineView("\r\n");
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), "123\r\n");
+    result = reader.readLineView("\r\n");
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), "456\r\n");
+}
+
+// 今読めるデータがなければ, 区切り文字までたどり着いていない行を返す
+TEST(BufferedReaderReadLineViewOk, partialLine) {
+    Mock<IReader> stub;
+    Fake(Method(stub, eof));
+    When(Method(stub, read))
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "123", 3);
+                return Ok(3ul);
+            })
+            .Return(Ok(0ul));
+
+    BufferedReader reader(&stub.get(), kBufferSize);
+    auto result = reader.readLineView("\n");
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), "123");
+    result = reader.readLineView("\n");
+    ASSERT_TRUE(result.isOk());
+    EXPECT_TRUE(result.unwrap().empty());
+}
+
+// 行の続きを読むために, 読み終えた領域へ行を詰める
+TEST(BufferedReaderReadLineViewOk, compactsPartialLine) {
+    Mock<IReader> stub;
+    Fake(Method(stub, eof));
+    When(Method(stub, read))
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "ab\ncd", 5);
+                return Ok(5ul);
+            })
+            .Do([](auto buf, auto n) {
+                EXPECT_EQ(n, 6);
+                std::memcpy(buf, "ef\n", 3);
+                return Ok(3ul);
+            });
+
+    BufferedReader reader(&stub.get(), 8);
+    auto first = reader.readLineView("\n");
+    ASSERT_TRUE(first.isOk());
+    EXPECT_EQ(first.unwrap(), "ab\n");
+    auto second = reader.readLineView("\n");
+    ASSERT_TRUE(second.isOk());
+    EXPECT_EQ(second.unwrap(), "cdef\n");
+    EXPECT_EQ(second.unwrap().data(), first.unwrap().data());
+}
+
+// バッファに収まらない行のためにバッファを大きくする
+TEST(BufferedReaderReadLineViewOk, growsForLongLine) {
+    Mock<IReader> stub;
+    Fake(Method(stub, eof));
+    When(Method(stub, read))
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "1234", 4);
+                return Ok(4ul);
+            })
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "567\n", 4);
+                return Ok(4ul);
+            });
+
+    BufferedReader reader(&stub.get(), 4, 16);
+    auto result = reader.readLineView("\n");
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), "1234567\n");
+}
+
+// 上限を超える行は分割して返す
+TEST(BufferedReaderReadLineViewOk, lineLongerThanMaxBuffer) {
+    Mock<IReader> stub;
+    Fake(Method(stub, eof));
+    When(Method(stub, read))
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "1234", 4);
+                return Ok(4ul);
+            })
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "5678", 4);
+                return Ok(4ul);
+            })
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "9\n", 2);
+                return Ok(2ul);
+            });
+
+    BufferedReader reader(&stub.get(), 4, 8);
+    auto result = reader.readLineView("\n");
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), "12345678");
+    result = reader.readLineView("\n");
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), "9\n");
+}
+
 // TODO: 改行で終わらない場合の readLine のテスト
 // eof がいつ true を返すようにスタブするべきかが実装依存
 
@@ -0,0 +1,58 @@
+#include "utils/byte_search.hpp"
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+    const char *naiveSearch(const std::string &haystack, const std::string &needle) {
+        const std::size_t pos = haystack.find(needle);
+        return pos == std::string::npos ? nullptr : haystack.data() + pos;
+    }
+} // namespace
+
+TEST(SearchBytes, emptyNeedle) {
+    const std::string haystack = "abc";
+    EXPECT_EQ(utils::searchBytes(haystack.data(), haystack.size(), "", 0), haystack.data());
+    EXPECT_EQ(utils::searchBytes(haystack.data(), 0, "", 0), haystack.data());
+}
+
+TEST(SearchBytes, needleLongerThanHaystack) {
+    EXPECT_EQ(utils::searchBytes("ab", 2, "abc", 3), nullptr);
+}
+
+// 末尾を含むどの位置でも見つかる
+TEST(SearchBytes, crlfAtEveryPosition) {
+    for (std::size_t len = 2; len <= 100; len++) {
+        for (std::size_t pos = 0; pos + 2 <= len; pos++) {
+            std::string haystack(len, 'a');
+            haystack[pos] = '\r';
+            haystack[pos + 1] = '\n';
+            EXPECT_EQ(utils::searchBytes(haystack.data(), haystack.size(), "\r\n", 2), haystack.data() + pos) << "len=" << len << " pos=" << pos;
+            EXPECT_EQ(utils::searchBytes(haystack.data(), haystack.size(), "\n", 1), haystack.data() + pos + 1) << "len=" << len << " pos=" << pos;
+        }
+    }
+}
+
+// 範囲の外にある一致は無視する
+TEST(SearchBytes, doesNotMatchOutsideLen) {
+    const std::string haystack = std::string(40, 'a') + "\r\n";
+    EXPECT_EQ(utils::searchBytes(haystack.data(), 41, "\r\n", 2), nullptr);
+    EXPECT_EQ(utils::searchBytes(haystack.data(), 41, "\n", 1), nullptr);
+}
+
+// 先頭と末尾だけが一致する候補を正しく捨てる
+TEST(SearchBytes, matchesNaiveSearchOnRandomInput) {
+    std::srand(42);
+    const char alphabet[] = "ab\r\n";
+    for (int round = 0; round < 2000; round++) {
+        std::string haystack(std::rand() % 100, ' ');
+        for (char &c : haystack) {
+            c = alphabet[std::rand() % 4];
+        }
+        std::string needle(1 + std::rand() % 5, ' ');
+        for (char &c : needle) {
+            c = alphabet[std::rand() % 4];
+        }
+        EXPECT_EQ(utils::searchBytes(haystack.data(), haystack.size(), needle.data(), needle.size()), naiveSearch(haystack, needle));
+    }
+}
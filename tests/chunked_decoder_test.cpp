@@ -0,0 +1,135 @@
+#include "http/chunked_decoder.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+    // 1 回の read で pieces を 1 つずつ返す. "" は今読めるデータがないことを表す
+    class ScriptedReader : public IReader {
+    public:
+        explicit ScriptedReader(const std::vector<std::string> &pieces) : pieces_(pieces), next_(0) {}
+
+        virtual Result<std::size_t, std::string> read(char *buf, std::size_t n) {
+            if (next_ >= pieces_.size()) {
+                return Ok<std::size_t>(0);
+            }
+            std::string &piece = pieces_[next_];
+            const std::size_t bytes_read = std::min(n, piece.size());
+            piece.copy(buf, bytes_read);
+            piece.erase(0, bytes_read);
+            if (piece.empty()) {
+                next_++;
+            }
+            return Ok(bytes_read);
+        }
+
+        virtual bool eof() const {
+            return next_ >= pieces_.size();
+        }
+
+    private:
+        std::vector<std::string> pieces_;
+        std::size_t next_;
+    };
+
+    // 読めるデータがなくなるか完了するまで decode を繰り返す
+    Result<bool, std::string> decodeAll(ChunkedDecoder &decoder, IBufferedReader &reader, RequestBody &body) {
+        for (int i = 0; i < 100 && !decoder.isDone(); i++) {
+            TRY(decoder.decode(reader, body));
+        }
+        return Ok(decoder.isDone());
+    }
+} // namespace
+
+TEST(ChunkedDecoderTest, decodesChunks) {
+    ScriptedReader scripted({"5\r\nhello\r\n7;name=value\r\n, world\r\n0\r\n\r\n"});
+    BufferedReader reader(&scripted, 64);
+    RequestBody body;
+    ChunkedDecoder decoder;
+
+    EXPECT_TRUE(decoder.decode(reader, body).isOk());
+    EXPECT_TRUE(decoder.isDone());
+    EXPECT_EQ(decoder.bodySize(), 12U);
+    EXPECT_EQ(body.toString().unwrap(), "hello, world");
+}
+
+TEST(ChunkedDecoderTest, resumesAcrossReads) {
+    ScriptedReader scripted({"A", "", "\r", "", "\n0123", "", "456789\r", "", "\n0\r\nTrailer: x\r", "", "\n\r\n"});
+    BufferedReader reader(&scripted, 64);
+    RequestBody body;
+    ChunkedDecoder decoder;
+
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(decoder.decode(reader, body).isOk());
+        EXPECT_FALSE(decoder.isDone());
+    }
+    EXPECT_TRUE(decodeAll(decoder, reader, body).unwrap());
+    EXPECT_EQ(body.toString().unwrap(), "0123456789");
+}
+
+TEST(ChunkedDecoderTest, upperCaseHex) {
+    ScriptedReader scripted({"1F\r\n" + std::string(31, 'x') + "\r\n0\r\n\r\n"});
+    BufferedReader reader(&scripted, 16);
+    RequestBody body;
+    ChunkedDecoder decoder;
+
+    EXPECT_TRUE(decodeAll(decoder, reader, body).unwrap());
+    EXPECT_EQ(body.size(), 31U);
+}
+
+TEST(ChunkedDecoderTest, leavesNextRequestInReader) {
+    ScriptedReader scripted({"3\r\nabc\r\n0\r\n\r\nGET / HTTP/1.1\r\n"});
+    BufferedReader reader(&scripted, 64);
+    RequestBody body;
+    ChunkedDecoder decoder;
+
+    EXPECT_TRUE(decodeAll(decoder, reader, body).unwrap());
+    EXPECT_EQ(reader.readLine("\r\n").unwrap(), "GET / HTTP/1.1\r\n");
+}
+
+TEST(ChunkedDecoderTest, bodyTooLarge) {
+    ScriptedReader scripted({"4\r\nabcd\r\n4\r\nefgh\r\n0\r\n\r\n"});
+    BufferedReader reader(&scripted, 64);
+    RequestBody body;
+    ChunkedDecoder decoder(6);
+
+    EXPECT_TRUE(decodeAll(decoder, reader, body).isErr());
+    EXPECT_EQ(body.size(), 4U);
+}
+
+TEST(ChunkedDecoderTest, invalidChunkSize) {
+    ScriptedReader scripted({"x\r\n"});
+    BufferedReader reader(&scripted, 64);
+    RequestBody body;
+    ChunkedDecoder decoder;
+
+    EXPECT_TRUE(decoder.decode(reader, body).isErr());
+}
+
+TEST(ChunkedDecoderTest, chunkSizeOverflow) {
+    ScriptedReader scripted({"10000000000000000\r\n"});
+    BufferedReader reader(&scripted, 64);
+    RequestBody body;
+    ChunkedDecoder decoder;
+
+    EXPECT_TRUE(decoder.decode(reader, body).isErr());
+}
+
+TEST(ChunkedDecoderTest, dataLongerThanChunkSize) {
+    ScriptedReader scripted({"2\r\nabc\r\n0\r\n\r\n"});
+    BufferedReader reader(&scripted, 64);
+    RequestBody body;
+    ChunkedDecoder decoder;
+
+    EXPECT_TRUE(decoder.decode(reader, body).isErr());
+}
+
+// 読み捨てる chunk-ext も, 上限を超えたらそれ以上溜めずに失敗する
+TEST(ChunkedDecoderTest, chunkExtensionTooLong) {
+    ScriptedReader scripted({"1;ext=" + std::string(16 * 1024, 'a') + "\r\na\r\n0\r\n\r\n"});
+    BufferedReader reader(&scripted, 64, 1024);
+    RequestBody body;
+    ChunkedDecoder decoder;
+
+    EXPECT_TRUE(decodeAll(decoder, reader, body).isErr());
+    EXPECT_EQ(body.size(), 0U);
+}
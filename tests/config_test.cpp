@@ -0,0 +1,70 @@
+#include "config/config.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+    RouteConfig route(const std::string &path, const Option<unsigned int> &client_max_body_size) {
+        return RouteConfig(path, std::vector<HttpMethod>(), "/", "/tmp", "/", false, "index.html",
+                           std::vector<std::string>(), std::map<std::string, std::string>(), client_max_body_size);
+    }
+
+    VirtualServerConfig server(const std::string &name, const std::vector<RouteConfig> &routes, const Option<unsigned int> &client_max_body_size) {
+        VirtualServerConfig virtual_server(routes, "0.0.0.0", "80", std::vector<std::string>(1, name));
+        virtual_server.setClientMaxBodySize(client_max_body_size);
+        return virtual_server;
+    }
+
+    Config config() {
+        std::vector<RouteConfig> default_routes;
+        default_routes.push_back(route("/", None));
+        default_routes.push_back(route("/upload", Some(300u)));
+        default_routes.push_back(route("/upload/large", Some(0u)));
+        std::vector<RouteConfig> api_routes;
+        api_routes.push_back(route("/", None));
+
+        std::vector<VirtualServerConfig> servers;
+        servers.push_back(server("example.com", default_routes, None));
+        servers.push_back(server("api.example.com", api_routes, Some(200u)));
+        return Config(servers, std::map<HttpStatusCode, std::string>(), 100);
+    }
+} // namespace
+
+TEST(ConfigTest, clientMaxBodySizeInheritsGlobal) {
+    EXPECT_EQ(config().resolveClientMaxBodySize("example.com", "/index.html"), 100u);
+}
+
+TEST(ConfigTest, clientMaxBodySizeOfVirtualServer) {
+    EXPECT_EQ(config().resolveClientMaxBodySize("api.example.com", "/"), 200u);
+    // ホスト名は大文字小文字を区別せず, ポートは無視する
+    EXPECT_EQ(config().resolveClientMaxBodySize("API.example.com:8080", "/"), 200u);
+}
+
+TEST(ConfigTest, clientMaxBodySizeOfLongestRoute) {
+    EXPECT_EQ(config().resolveClientMaxBodySize("example.com", "/upload/file"), 300u);
+    EXPECT_EQ(config().resolveClientMaxBodySize("example.com", "/upload/large/file"), 0u);
+}
+
+// 名前が一致しなければ最初の仮想サーバーを使う
+TEST(ConfigTest, clientMaxBodySizeOfDefaultServer) {
+    EXPECT_EQ(config().resolveClientMaxBodySize("unknown.example.com", "/upload"), 300u);
+    EXPECT_EQ(config().resolveClientMaxBodySize("", "/"), 100u);
+}
+
+TEST(ConfigTest, clientMaxBodySizeWithoutVirtualServer) {
+    const Config empty(std::vector<VirtualServerConfig>(), std::map<HttpStatusCode, std::string>(), 100);
+    EXPECT_EQ(empty.resolveClientMaxBodySize("example.com", "/"), 100u);
+}
+
+// 設定した項目だけが変わり, 他は既定値のまま
+TEST(ConfigTest, setterChangesOnlyItsField) {
+    const Config defaults;
+    Config config;
+    config.setPipelineDepth(1);
+    EXPECT_EQ(config.getPipelineDepth(), 1u);
+    EXPECT_EQ(config.getKeepaliveRequests(), defaults.getKeepaliveRequests());
+    EXPECT_EQ(config.getClientBodyBufferSize(), defaults.getClientBodyBufferSize());
+    EXPECT_EQ(config.getClientBodyTempPath(), defaults.getClientBodyTempPath());
+
+    // 複製にも引き継がれる
+    const Config copied = config;
+    EXPECT_EQ(copied.getPipelineDepth(), 1u);
+}
@@ -0,0 +1,104 @@
+#include "server/connection_pool.hpp"
+#include "without_date.hpp"
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class ConnectionPoolTest : public ::testing::Test {
+protected:
+    IOTaskManager manager_;
+    Handler handler_;
+    Config config_;
+
+    // 戻り値の [0] はサーバー側で, Connection が close する
+    static std::pair<int, int> connect() {
+        int fds[2] = {-1, -1};
+        EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        EXPECT_NE(fcntl(fds[0], F_SETFL, O_NONBLOCK), -1);
+        EXPECT_NE(fcntl(fds[1], F_SETFL, O_NONBLOCK), -1);
+        return std::make_pair(fds[0], fds[1]);
+    }
+
+    static void send(int fd, const std::string &data) {
+        ASSERT_EQ(write(fd, data.c_str(), data.size()), static_cast<ssize_t>(data.size()));
+    }
+
+    static std::string receive(int fd) {
+        char buf[4096];
+        const ssize_t n = read(fd, buf, sizeof(buf));
+        return n > 0 ? withoutDate(std::string(buf, n)) : "";
+    }
+
+    void runLoop() {
+        for (int i = 0; i < 8; i++) {
+            ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+        }
+    }
+};
+
+TEST_F(ConnectionPoolTest, reusesClosedConnection) {
+    ConnectionPool pool(manager_, &handler_, config_);
+
+    const std::pair<int, int> first = connect();
+    Connection *connection = pool.acquire(first.first);
+    connection->start();
+    // 閉じる前に届いたリクエストの残りは次のクライアントに引き継がれない
+    send(first.second, "GET / HTTP/1.1\r\nConnection: close\r\n\r\nGET /leftover HTTP/1.1\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(first.second), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_EQ(pool.idle(), 1U);
+    close(first.second);
+
+    const std::pair<int, int> second = connect();
+    EXPECT_EQ(pool.acquire(second.first), connection);
+    EXPECT_EQ(pool.idle(), 0U);
+    connection->start();
+    send(second.second, "POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\ntwo");
+    runLoop();
+    EXPECT_EQ(receive(second.second), "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nContent-Type: text/plain\r\n\r\ntwo");
+
+    shutdown(second.second, SHUT_WR);
+    runLoop();
+    EXPECT_EQ(pool.idle(), 1U);
+    close(second.second);
+}
+
+TEST_F(ConnectionPoolTest, keepsAtMostMaxIdle) {
+    ConnectionPool pool(manager_, &handler_, config_, 2);
+
+    std::vector<int> clients;
+    for (int i = 0; i < 4; i++) {
+        const std::pair<int, int> fds = connect();
+        pool.acquire(fds.first)->start();
+        clients.push_back(fds.second);
+    }
+    for (std::size_t i = 0; i < clients.size(); i++) {
+        close(clients[i]);
+    }
+    runLoop();
+    EXPECT_EQ(pool.idle(), 2U);
+}
+
+// keep-alive で次のリクエストを待つ接続は読み込みバッファを持たない
+TEST_F(ConnectionPoolTest, idleConnectionHoldsNoBuffer) {
+    ConnectionPool pool(manager_, &handler_, config_);
+
+    const std::pair<int, int> fds = connect();
+    pool.acquire(fds.first)->start();
+    runLoop();
+    EXPECT_EQ(pool.buffers().available(), 0U);
+
+    send(fds.second, "GET / HTTP/1.1\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(fds.second), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_EQ(pool.buffers().available(), 1U);
+
+    send(fds.second, "GET / HTTP/1.1\r\nHo");
+    runLoop();
+    EXPECT_EQ(pool.buffers().available(), 0U);
+
+    close(fds.second);
+    runLoop();
+    EXPECT_EQ(pool.buffers().available(), 1U);
+}
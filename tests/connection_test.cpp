@@ -0,0 +1,473 @@
+#include "allocation_counter.hpp"
+#include "http/date_header.hpp"
+#include "server/connection.hpp"
+#include "without_date.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class ConnectionTest : public ::testing::Test {
+protected:
+    IOTaskManager manager_;
+    Handler handler_;
+    // fds_[0] はサーバー側で, Connection が close する
+    int fds_[2] = {-1, -1};
+
+    void SetUp() override {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_), 0);
+        ASSERT_NE(fcntl(fds_[0], F_SETFL, O_NONBLOCK), -1);
+        ASSERT_NE(fcntl(fds_[1], F_SETFL, O_NONBLOCK), -1);
+    }
+
+    void TearDown() override {
+        close(fds_[1]);
+    }
+
+    void startConnection(const Config &config) {
+        Connection *connection = new Connection(manager_, fds_[0], &handler_, config);
+        connection->start();
+    }
+
+    void send(const std::string &data) {
+        ASSERT_EQ(write(fds_[1], data.c_str(), data.size()), static_cast<ssize_t>(data.size()));
+    }
+
+    void runLoop() {
+        for (int i = 0; i < 8; i++) {
+            ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+        }
+    }
+
+    std::string receive() {
+        char buf[4096];
+        const ssize_t n = read(fds_[1], buf, sizeof(buf));
+        return n > 0 ? withoutDate(std::string(buf, n)) : "";
+    }
+
+    // サーバー側が close していれば EOF になる
+    // 読まれていないリクエストのバイトを残して閉じた場合は ECONNRESET になる
+    bool isClosedByServer() {
+        char c;
+        const ssize_t n = read(fds_[1], &c, 1);
+        return n == 0 || (n == -1 && errno == ECONNRESET);
+    }
+};
+
+TEST_F(ConnectionTest, keepAlive) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\none");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nContent-Type: text/plain\r\n\r\none");
+
+    send("POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\ntwo");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nContent-Type: text/plain\r\n\r\ntwo");
+    EXPECT_FALSE(isClosedByServer());
+
+    // クライアントが切断したら Connection も閉じる
+    shutdown(fds_[1], SHUT_WR);
+    runLoop();
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 先に送られていたリクエストもバッファから読まれる
+TEST_F(ConnectionTest, bufferedRequest) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\none"
+         "POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\ntwo");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nContent-Type: text/plain\r\n\r\none"
+                         "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nContent-Type: text/plain\r\n\r\ntwo");
+
+    shutdown(fds_[1], SHUT_WR);
+    runLoop();
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, connectionClose) {
+    Config config;
+    startConnection(config);
+
+    send("GET / HTTP/1.1\r\nConnection: close\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, http10KeepAlive) {
+    Config config;
+    startConnection(config);
+
+    send("GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: keep-alive\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_FALSE(isClosedByServer());
+
+    send("GET / HTTP/1.0\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, maxRequests) {
+    Config config;
+    config.setKeepaliveRequests(2);
+    startConnection(config);
+
+    send("GET / HTTP/1.1\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nContent-Type: text/plain\r\n\r\n");
+
+    send("GET / HTTP/1.1\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, malformedRequestClosesConnection) {
+    Config config;
+    startConnection(config);
+
+    send("XXX / HTTP/1.1\r\n\r\n");
+    runLoop();
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, idleConnectionTimesOut) {
+    Config config;
+    config.setClientHeaderTimeout(1);
+    startConnection(config);
+
+    send("GET / HTTP/1.1\r\n");
+    for (int i = 0; i < 8 && !isClosedByServer(); i++) {
+        ASSERT_TRUE(manager_.executeReadyTasks(500).isOk());
+    }
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 読み込みバッファより長いヘッダーも受け付ける
+TEST_F(ConnectionTest, headerLongerThanBuffer) {
+    Config config;
+    startConnection(config);
+
+    send("GET / HTTP/1.1\r\nX-Long: " + std::string(6 * 1024, 'a') + "\r\nConnection: close\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+namespace {
+    // 読み込みバッファが 1 KiB から 4 KiB まで伸びる設定
+    Config smallHeaderConfig() {
+        Config config;
+        config.setClientHeaderBufferSize(1024);
+        config.setLargeClientHeaderBufferSize(4096);
+        return config;
+    }
+} // namespace
+
+// 上限を超えた request-line は, 行の終わりを待たずに拒否する
+TEST_F(ConnectionTest, requestLineTooLong) {
+    const Config config = smallHeaderConfig();
+    startConnection(config);
+
+    send("GET /" + std::string(5 * 1024, 'a'));
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 414 URI Too Long\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, headerFieldTooLong) {
+    const Config config = smallHeaderConfig();
+    startConnection(config);
+
+    send("GET / HTTP/1.1\r\nX-Long: " + std::string(5 * 1024, 'a'));
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 1 行ずつは上限に収まっても, header section 全体が上限を超えれば拒否する
+TEST_F(ConnectionTest, headerSectionTooLarge) {
+    const Config config = smallHeaderConfig();
+    startConnection(config);
+
+    std::string request = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i < 10; i++) {
+        request += "X-Field-" + utils::toString(i) + ": " + std::string(500, 'a') + "\r\n";
+    }
+    send(request + "\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, tooManyHeaderFields) {
+    Config config;
+    startConnection(config);
+
+    std::string request = "GET / HTTP/1.1\r\n";
+    for (int i = 0; i < 101; i++) {
+        request += "X-" + utils::toString(i) + ": a\r\n";
+    }
+    send(request + "\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// client_body_buffer_size より大きい body は一時ファイルを経由して渡される
+TEST_F(ConnectionTest, bodyLargerThanBodyBuffer) {
+    Config config;
+    config.setClientBodyBufferSize(16);
+    startConnection(config);
+
+    const std::string body(100, 'b');
+    send("POST / HTTP/1.1\r\nContent-Length: 100\r\nConnection: close\r\n\r\n" + body);
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 100\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n" + body);
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, chunkedBody) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n3\r\non");
+    runLoop();
+    send("e\r\n0\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\none");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 最後の transfer-coding が chunked でなければ message-body の終わりが決まらないので, 400 を返して閉じる (MUST)
+// refs: https://datatracker.ietf.org/doc/html/rfc9112#section-6.3
+TEST_F(ConnectionTest, unsupportedTransferCodingIsRejected) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\none");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 値の異なる Content-Length は, どちらで区切るかが中継するサーバーと食い違いうるので拒否する
+TEST_F(ConnectionTest, conflictingContentLengthIsRejected) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 5\r\n\r\nonetw");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 数値として読めない Content-Length では message-body の終わりが決まらない
+TEST_F(ConnectionTest, invalidContentLengthIsRejected) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nContent-Length: 3x\r\n\r\none");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, overflowingContentLengthIsRejected) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\none");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, repeatedContentLengthWithSameValue) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nContent-Length: 3\r\ncontent-length: 3\r\nConnection: close\r\n\r\none");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\none");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 先に届いたリクエストには応答し, 続きを読まずに閉じる
+TEST_F(ConnectionTest, transferEncodingWithContentLengthIsRejected) {
+    Config config;
+    startConnection(config);
+
+    send("GET / HTTP/1.1\r\n\r\n"
+         "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 3\r\n\r\n0\r\n\r\nGET / HTTP/1.1\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nContent-Type: text/plain\r\n\r\n"
+                         "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 繰り返された Transfer-Encoding はつないで最後の transfer-coding を見るので, chunked としては読まない
+TEST_F(ConnectionTest, repeatedTransferEncodingUsesLastCoding) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: gzip\r\n\r\n0\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, repeatedTransferEncodingEndingWithChunked) {
+    Config config;
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nTransfer-Encoding: \r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n3\r\none\r\n0\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 3\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\none");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 不正なリクエストより前に届いたリクエストには応答してから閉じる
+TEST_F(ConnectionTest, malformedPipelinedRequestClosesAfterResponses) {
+    Config config;
+    startConnection(config);
+
+    send("GET / HTTP/1.1\r\n\r\nXXX / HTTP/1.1\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// pipeline_depth が 1 なら, レスポンスを書き終えるまで次のリクエストを読まない
+TEST_F(ConnectionTest, pipelineDepthOne) {
+    Config config;
+    config.setPipelineDepth(1);
+    startConnection(config);
+
+    send("GET / HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\nConnection: close\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nContent-Type: text/plain\r\n\r\n"
+                         "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+namespace {
+    // client_max_body_size が 8 バイトで, /upload だけ 16 バイトの設定
+    Config smallBodyConfig() {
+        std::vector<RouteConfig> routes;
+        routes.push_back(RouteConfig("/", std::vector<HttpMethod>()));
+        routes.push_back(RouteConfig("/upload", std::vector<HttpMethod>(), "/", "/tmp", "/", false, "index.html",
+                                     std::vector<std::string>(), std::map<std::string, std::string>(), Some(16u)));
+        std::vector<VirtualServerConfig> servers;
+        servers.push_back(VirtualServerConfig(routes));
+        return Config(servers, std::map<HttpStatusCode, std::string>(), 8);
+    }
+} // namespace
+
+// 宣言された Content-Length が上限を超えていれば, message-body を待たずに 413 を返して閉じる
+TEST_F(ConnectionTest, contentLengthTooLarge) {
+    const Config config = smallBodyConfig();
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 経路の client_max_body_size が優先される
+TEST_F(ConnectionTest, routeMaxBodySize) {
+    const Config config = smallBodyConfig();
+    startConnection(config);
+
+    send("POST /upload/file HTTP/1.1\r\nContent-Length: 12\r\n\r\nhello, world");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 12\r\nContent-Type: text/plain\r\n\r\nhello, world");
+
+    send("POST / HTTP/1.1\r\nContent-Length: 12\r\n\r\nhello, world");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+TEST_F(ConnectionTest, chunkedBodyTooLarge) {
+    const Config config = smallBodyConfig();
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n7\r\n, world\r\n0\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 受け付ける message-body には 100 Continue を返してから読む
+TEST_F(ConnectionTest, expectContinue) {
+    const Config config = smallBodyConfig();
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nContent-Length: 5\r\nExpect: 100-continue\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 100 Continue\r\n\r\n");
+
+    send("hello");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nContent-Type: text/plain\r\n\r\nhello");
+    EXPECT_FALSE(isClosedByServer());
+
+    shutdown(fds_[1], SHUT_WR);
+    runLoop();
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 拒否する message-body には 100 Continue を返さない
+TEST_F(ConnectionTest, expectContinueTooLarge) {
+    const Config config = smallBodyConfig();
+    startConnection(config);
+
+    send("POST / HTTP/1.1\r\nContent-Length: 12\r\nExpect: 100-continue\r\n\r\n");
+    runLoop();
+    EXPECT_EQ(receive(), "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\nContent-Type: text/plain\r\n\r\n");
+    EXPECT_TRUE(isClosedByServer());
+}
+
+// 同じ接続で繰り返される GET は, バッファやタスクが確保された後はヒープを使わない
+TEST_F(ConnectionTest, keepAliveAllocatesNothingInSteadyState) {
+    Config config;
+    startConnection(config);
+
+    const std::string request = "GET /index.html?lang=ja HTTP/1.1\r\n"
+                                "Host: localhost:8080\r\n"
+                                "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n"
+                                "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+                                "Accept-Encoding: gzip, deflate\r\n"
+                                "X-Request-Id: 0123456789abcdef0123456789abcdef\r\n"
+                                "\r\n";
+    const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nContent-Type: text/plain\r\n\r\n";
+    char buf[4096];
+    for (int i = 0; i < 8; i++) {
+        send(request);
+        runLoop();
+        ASSERT_EQ(receive(), response);
+    }
+
+    const AllocationCounter counter;
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(write(fds_[1], request.data(), request.size()), static_cast<ssize_t>(request.size()));
+        runLoop();
+        ASSERT_EQ(read(fds_[1], buf, sizeof(buf)), static_cast<ssize_t>(response.size() + DateHeader::kSize));
+    }
+    EXPECT_EQ(counter.count(), 0);
+    ASSERT_EQ(withoutDate(std::string(buf, response.size() + DateHeader::kSize)), response);
+
+    shutdown(fds_[1], SHUT_WR);
+    runLoop();
+    EXPECT_TRUE(isClosedByServer());
+}
@@ -1,3 +1,4 @@
+#include "allocation_counter.hpp"
 #include "http/context.hpp"
 #include <gtest/gtest.h>
 
@@ -6,10 +7,11 @@ protected:
     IOTaskManager manager_;
     const int client_fd_ = 0;
     Context context_ = Context(manager_, client_fd_);
-    Request request_ = Request(kMethodPost, "/path", "HTTP/1.1", {}, "body");
+    Request request_ = Request(kMethodPost, "/path", "HTTP/1.1");
 
     void SetUp() override {
-        context_.setRequest(request_);
+        Request request = request_;
+        context_.setRequest(request);
     }
 };
 
@@ -18,9 +20,35 @@ TEST_F(ContextTest, getRequest) {
 }
 
 TEST_F(ContextTest, setRequest) {
-    Request new_request = Request(kMethodGet, "/new_path", "HTTP/1.0", {{"key", "value"}}, "");
+    const Request expected = Request(kMethodGet, "/new_path", "HTTP/1.0", {{"key", "value"}});
+    Request new_request = expected;
     context_.setRequest(new_request);
-    EXPECT_EQ(context_.getRequest(), new_request);
+    EXPECT_EQ(context_.getRequest(), expected);
+    // 入れ替えなので, 前のリクエストが残る
+    EXPECT_EQ(new_request, request_);
+}
+
+// ReadRequest と同じく Context のアリーナに組み立てたリクエストは, フィールドをコピーせずに引き渡される
+TEST_F(ContextTest, setRequestDoesNotCopyFields) {
+    Arena &arena = context_.getArena();
+    const StringView target = arena.copy("/index.html");
+    const StringView version = arena.copy("HTTP/1.1");
+    HeaderTable headers(&arena);
+    headers.add("Host", "localhost");
+    headers.add("X-Request-Id", "0123456789abcdef");
+    Request request(kMethodGet, target, version, headers, arena);
+    const std::size_t capacity = arena.capacity();
+
+    const AllocationCounter counter;
+    context_.setRequest(request);
+    EXPECT_EQ(counter.count(), 0);
+    EXPECT_EQ(arena.capacity(), capacity);
+
+    const Request &borrowed = context_.getRequest();
+    EXPECT_EQ(borrowed.path().data(), target.data());
+    EXPECT_EQ(borrowed.httpVersion().data(), version.data());
+    EXPECT_EQ(borrowed.header(kHeaderHost).unwrap().data(), headers.get(kHeaderHost).unwrap().data());
+    EXPECT_EQ(borrowed.header("X-Request-Id").unwrap().data(), headers.get("X-Request-Id").unwrap().data());
 }
 
 TEST_F(ContextTest, getManager) {
@@ -31,4 +59,12 @@ TEST_F(ContextTest, getClientFd) {
     EXPECT_EQ(context_.getClientFd(), client_fd_);
 }
 
+TEST_F(ContextTest, resetClearsRequestBody) {
+    ASSERT_TRUE(context_.getRequestBody().append("body", 4).isOk());
+    EXPECT_EQ(context_.getRequestBody().size(), 4U);
+    context_.reset();
+    EXPECT_EQ(context_.getRequestBody().size(), 0U);
+    EXPECT_EQ(context_.getRequest(), Request());
+}
+
 // TODO: add tests
@@ -0,0 +1,17 @@
+#include "http/date_header.hpp"
+#include <gtest/gtest.h>
+
+TEST(DateHeaderTest, formatsImfFixdate) {
+    EXPECT_EQ(DateHeader::get(784111777).toString(), "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n");
+    EXPECT_EQ(DateHeader::get(0).toString(), "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n");
+    EXPECT_EQ(DateHeader::get(1709251199).toString(), "Date: Thu, 29 Feb 2024 23:59:59 GMT\r\n");
+    EXPECT_EQ(DateHeader::get(0).size(), DateHeader::kSize);
+}
+
+// 同じ秒の間は作り直さず, 同じ領域を返す
+TEST(DateHeaderTest, reusesLineWithinSecond) {
+    const StringView first = DateHeader::get(784111777);
+    const StringView second = DateHeader::get(784111777);
+    EXPECT_EQ(first.data(), second.data());
+    EXPECT_EQ(DateHeader::get(784111778).toString(), "Date: Sun, 06 Nov 1994 08:49:38 GMT\r\n");
+}
@@ -1,5 +1,9 @@
 #include "io/reader.hpp"
+#include <chrono>
+#include <csignal>
 #include <gtest/gtest.h>
+#include <pthread.h>
+#include <thread>
 
 class FdReaderTest : public ::testing::Test {
 protected:
@@ -95,4 +99,40 @@ TEST_F(FdReaderTest, readError) {
     auto result = reader.read(buf, 16);
 
     EXPECT_TRUE(result.isErr());
-}
\ No newline at end of file
+}
+
+namespace {
+    void ignoreSignal(int) {}
+} // namespace
+
+TEST(FdReaderSignalTest, retriesWhenInterrupted) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    // SA_RESTART を付けないので, ブロック中の read はシグナルで EINTR になる
+    struct sigaction action = {};
+    struct sigaction old_action = {};
+    action.sa_handler = ignoreSignal;
+    sigemptyset(&action.sa_mask);
+    ASSERT_EQ(sigaction(SIGUSR1, &action, &old_action), 0);
+
+    const pthread_t reader_thread = pthread_self();
+    std::thread writer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        pthread_kill(reader_thread, SIGUSR1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ASSERT_EQ(write(fds[1], "a", 1), 1);
+    });
+
+    FdReader reader(fds[0]);
+    char buf[1];
+    auto result = reader.read(buf, 1);
+    writer.join();
+    sigaction(SIGUSR1, &old_action, NULL);
+    close(fds[0]);
+    close(fds[1]);
+
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), 1);
+    EXPECT_EQ(buf[0], 'a');
+}
@@ -0,0 +1,113 @@
+#include "http/header_table.hpp"
+#include <gtest/gtest.h>
+
+TEST(HttpHeaderFromName, knownNames) {
+    for (int i = 0; i < kHeaderUnknown; i++) {
+        const HttpHeader header = static_cast<HttpHeader>(i);
+        EXPECT_EQ(httpHeaderFromName(httpHeaderName(header)), header) << httpHeaderName(header);
+    }
+}
+
+TEST(HttpHeaderFromName, caseInsensitive) {
+    EXPECT_EQ(httpHeaderFromName("content-length"), kHeaderContentLength);
+    EXPECT_EQ(httpHeaderFromName("HOST"), kHeaderHost);
+    EXPECT_EQ(httpHeaderFromName("tRANSFER-eNCODING"), kHeaderTransferEncoding);
+}
+
+TEST(HttpHeaderFromName, unknownNames) {
+    EXPECT_EQ(httpHeaderFromName(""), kHeaderUnknown);
+    EXPECT_EQ(httpHeaderFromName("X-Forwarded-For"), kHeaderUnknown);
+    // 長さと先頭・末尾のバイトが既知の名前と同じ
+    EXPECT_EQ(httpHeaderFromName("Hxst"), kHeaderUnknown);
+    EXPECT_EQ(httpHeaderFromName("Content-Lengtx"), kHeaderUnknown);
+    EXPECT_EQ(httpHeaderFromName("Content-Lengths"), kHeaderUnknown);
+}
+
+TEST(HeaderTable, knownField) {
+    HeaderTable headers;
+    EXPECT_EQ(headers.add("Content-Length", "42"), Some(kHeaderContentLength));
+    EXPECT_EQ(headers.get(kHeaderContentLength), Some(StringView("42")));
+    EXPECT_EQ(headers.get("content-length"), Some(StringView("42")));
+    EXPECT_EQ(headers.get(kHeaderHost), None);
+    EXPECT_EQ(headers.size(), 1);
+}
+
+TEST(HeaderTable, unknownField) {
+    HeaderTable headers;
+    EXPECT_EQ(headers.add("X-Request-Id", "abc"), Some(kHeaderUnknown));
+    EXPECT_EQ(headers.get("x-request-id"), Some(StringView("abc")));
+    EXPECT_EQ(headers.get("X-Request"), None);
+    EXPECT_EQ(headers.size(), 1);
+}
+
+TEST(HeaderTable, emptyValue) {
+    HeaderTable headers;
+    EXPECT_EQ(headers.add("Accept", ""), Some(kHeaderAccept));
+    EXPECT_EQ(headers.get(kHeaderAccept), Some(StringView("")));
+}
+
+TEST(HeaderTable, duplicateKeepsFirst) {
+    HeaderTable headers;
+    EXPECT_EQ(headers.add("Host", "a"), Some(kHeaderHost));
+    EXPECT_EQ(headers.add("host", "b"), None);
+    EXPECT_EQ(headers.add("X-Foo", "c"), Some(kHeaderUnknown));
+    EXPECT_EQ(headers.add("x-foo", "d"), None);
+    EXPECT_EQ(headers.get(kHeaderHost), Some(StringView("a")));
+    EXPECT_EQ(headers.get("X-Foo"), Some(StringView("c")));
+    EXPECT_EQ(headers.size(), 2);
+}
+
+TEST(HeaderTable, combine) {
+    HeaderTable headers;
+    headers.combine("Transfer-Encoding", "gzip");
+    headers.combine("transfer-encoding", "chunked");
+    headers.combine("X-Foo", "a");
+    headers.combine("x-foo", "b, c");
+    EXPECT_EQ(headers.get(kHeaderTransferEncoding), Some(StringView("gzip, chunked")));
+    EXPECT_EQ(headers.get("X-Foo"), Some(StringView("a, b, c")));
+    EXPECT_EQ(headers.size(), 2);
+}
+
+TEST(HeaderTable, clear) {
+    HeaderTable headers;
+    headers.add("Host", "a");
+    headers.add("X-Foo", "b");
+    headers.clear();
+    EXPECT_EQ(headers.size(), 0);
+    EXPECT_EQ(headers.get(kHeaderHost), None);
+    EXPECT_EQ(headers.get("X-Foo"), None);
+    EXPECT_EQ(headers.add("Host", "c"), Some(kHeaderHost));
+    EXPECT_EQ(headers.get(kHeaderHost), Some(StringView("c")));
+}
+
+TEST(HeaderTable, copy) {
+    HeaderTable headers;
+    headers.add("Host", "a");
+    headers.add("X-Foo", "b");
+    HeaderTable copy;
+    copy.add("Accept", "c");
+    copy = headers;
+    EXPECT_EQ(copy.get(kHeaderHost), Some(StringView("a")));
+    EXPECT_EQ(copy.get("X-Foo"), Some(StringView("b")));
+    EXPECT_EQ(copy.get(kHeaderAccept), None);
+    EXPECT_EQ(copy, headers);
+}
+
+TEST(HeaderTable, equalityIgnoresOrder) {
+    HeaderTable a;
+    a.add("Host", "h");
+    a.add("X-Foo", "1");
+    a.add("X-Bar", "2");
+    HeaderTable b;
+    b.add("x-bar", "2");
+    b.add("HOST", "h");
+    b.add("X-Foo", "1");
+    EXPECT_EQ(a, b);
+
+    HeaderTable c;
+    c.add("Host", "h");
+    c.add("X-Foo", "1");
+    EXPECT_FALSE(a == c);
+    c.add("X-Bar", "3");
+    EXPECT_FALSE(a == c);
+}
@@ -0,0 +1,201 @@
+#include "allocation_counter.hpp"
+#include "task/io_task_manager.hpp"
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// execute() の回数と delete されたかを記録するタスク
+class RecordingTask : public IOTask {
+public:
+    RecordingTask(IOTaskManager &m, int fd, unsigned int events, IOTaskResult result, int &executed, bool &deleted)
+        : IOTask(m, fd, events), result_(result), executed_(executed), deleted_(deleted) {}
+
+    ~RecordingTask() override {
+        deleted_ = true;
+    }
+
+    Result<IOTaskResult, std::string> execute() override {
+        executed_++;
+        return Ok(result_);
+    }
+
+private:
+    IOTaskResult result_;
+    int &executed_;
+    bool &deleted_;
+};
+
+class IOTaskManagerTest : public ::testing::Test {
+protected:
+    IOTaskManager manager_;
+    int fds_[2] = {-1, -1};
+
+    void SetUp() override {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_), 0);
+    }
+
+    void TearDown() override {
+        close(fds_[0]);
+        close(fds_[1]);
+    }
+};
+
+TEST_F(IOTaskManagerTest, readTaskWaitsForData) {
+    int executed = 0;
+    bool deleted = false;
+    new RecordingTask(manager_, fds_[0], kEventRead, kTaskComplete, executed, deleted);
+
+    ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+    EXPECT_EQ(executed, 0);
+    EXPECT_FALSE(deleted);
+
+    ASSERT_EQ(write(fds_[1], "a", 1), 1);
+    ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+    EXPECT_EQ(executed, 1);
+    EXPECT_TRUE(deleted);
+}
+
+TEST_F(IOTaskManagerTest, suspendedTaskIsExecutedAgain) {
+    int executed = 0;
+    bool deleted = false;
+    RecordingTask task(manager_, fds_[0], kEventRead, kTaskSuspend, executed, deleted);
+
+    ASSERT_EQ(write(fds_[1], "a", 1), 1);
+    ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+    ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+    EXPECT_EQ(executed, 2);
+    EXPECT_FALSE(deleted);
+}
+
+TEST_F(IOTaskManagerTest, onlyReadyInterestIsExecuted) {
+    int read_executed = 0;
+    int write_executed = 0;
+    bool read_deleted = false;
+    bool write_deleted = false;
+    RecordingTask reader(manager_, fds_[0], kEventRead, kTaskSuspend, read_executed, read_deleted);
+    RecordingTask writer(manager_, fds_[0], kEventWrite, kTaskSuspend, write_executed, write_deleted);
+
+    // ソケットは書き込み可能だが, 読み込むデータはない
+    ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+    EXPECT_EQ(read_executed, 0);
+    EXPECT_EQ(write_executed, 1);
+}
+
+TEST_F(IOTaskManagerTest, removedTaskIsNotExecuted) {
+    int executed = 0;
+    bool deleted = false;
+    RecordingTask *task = new RecordingTask(manager_, fds_[0], kEventRead, kTaskSuspend, executed, deleted);
+    delete task;
+
+    ASSERT_EQ(write(fds_[1], "a", 1), 1);
+    ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+    EXPECT_EQ(executed, 0);
+}
+
+TEST_F(IOTaskManagerTest, unpollableFdIsAlwaysReady) {
+    FILE *file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    int executed = 0;
+    bool deleted = false;
+    new RecordingTask(manager_, fileno(file), kEventWrite, kTaskComplete, executed, deleted);
+
+    ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+    EXPECT_EQ(executed, 1);
+    EXPECT_TRUE(deleted);
+    std::fclose(file);
+}
+
+// タイムアウトを設定し, onTimeout() の回数を記録するタスク
+class TimeoutTask : public IOTask {
+public:
+    TimeoutTask(IOTaskManager &m, int fd, unsigned int timeout_ms, int &timed_out)
+        : IOTask(m, fd, kEventRead), timed_out_(timed_out) {
+        setTimeout(timeout_ms);
+    }
+
+    Result<IOTaskResult, std::string> execute() override {
+        return Ok(kTaskSuspend);
+    }
+
+    Result<IOTaskResult, std::string> onTimeout() override {
+        timed_out_++;
+        return Ok(kTaskComplete);
+    }
+
+    void rearm(unsigned int timeout_ms) {
+        setTimeout(timeout_ms);
+    }
+
+private:
+    int &timed_out_;
+};
+
+TEST_F(IOTaskManagerTest, timeoutWakesUpEventLoop) {
+    int timed_out = 0;
+    new TimeoutTask(manager_, fds_[0], 10, timed_out);
+
+    ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+    EXPECT_EQ(timed_out, 0);
+
+    // fd は ready にならないが, タイマーの期限で起きる
+    for (int i = 0; i < 10 && timed_out == 0; i++) {
+        ASSERT_TRUE(manager_.executeReadyTasks(1000).isOk());
+    }
+    EXPECT_EQ(timed_out, 1);
+}
+
+TEST_F(IOTaskManagerTest, clearedTimeoutDoesNotFire) {
+    int timed_out = 0;
+    TimeoutTask task(manager_, fds_[0], 10, timed_out);
+    task.rearm(0);
+
+    ASSERT_TRUE(manager_.executeReadyTasks(50).isOk());
+    EXPECT_EQ(timed_out, 0);
+}
+
+// execute() でイベントループを止めるタスク
+class StopTask : public IOTask {
+public:
+    StopTask(IOTaskManager &m, int fd) : IOTask(m, fd, kEventRead) {}
+
+    Result<IOTaskResult, std::string> execute() override {
+        manager_.stop();
+        return Ok(kTaskComplete);
+    }
+};
+
+TEST_F(IOTaskManagerTest, stopEndsEventLoop) {
+    int executed = 0;
+    bool deleted = false;
+    RecordingTask task(manager_, fds_[0], kEventRead, kTaskSuspend, executed, deleted);
+    new StopTask(manager_, fds_[0]);
+
+    ASSERT_EQ(write(fds_[1], "a", 1), 1);
+    EXPECT_TRUE(manager_.executeTasks().isOk());
+    // 止めたタスクと同じ iteration のタスクは実行される
+    EXPECT_EQ(executed, 1);
+    EXPECT_FALSE(deleted);
+}
+
+// 接続の開始と終了を繰り返しても, 登録・削除・実行でメモリが増えない
+TEST_F(IOTaskManagerTest, churnDoesNotAllocate) {
+    int executed = 0;
+    bool deleted = false;
+    ASSERT_EQ(write(fds_[1], "a", 1), 1);
+    const auto churn = [&](int n) {
+        for (int i = 0; i < n; i++) {
+            RecordingTask reader(manager_, fds_[0], kEventRead, kTaskSuspend, executed, deleted);
+            RecordingTask writer(manager_, fds_[i % 2], kEventWrite, kTaskSuspend, executed, deleted);
+            ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+        }
+    };
+    churn(16);
+
+    const int before = executed;
+    const AllocationCounter counter;
+    churn(100000);
+    EXPECT_EQ(counter.count(), 0);
+    EXPECT_EQ(executed - before, 100000 * 2);
+}
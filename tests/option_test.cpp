@@ -1,3 +1,4 @@
+#include "allocation_counter.hpp"
 #include "utils/option.hpp"
 #include <gtest/gtest.h>
 
@@ -106,3 +107,34 @@ TEST(OptionTest, unwrapOrNone) {
     Option<std::string> target = None;
     EXPECT_EQ(target.unwrapOr("none"), "none");
 }
+
+TEST(OptionTest, copyIsIndependent) {
+    Option<std::string> original = Some<std::string>("some");
+    Option<std::string> copy = original;
+    copy.unwrap() = "changed";
+    EXPECT_EQ(original.unwrap(), "some");
+}
+
+TEST(OptionTest, assignNoneToSome) {
+    Option<std::string> target = Some<std::string>("some");
+    target = None;
+    EXPECT_TRUE(target.isNone());
+
+    target = Some<std::string>("again");
+    EXPECT_EQ(target.unwrap(), "again");
+}
+
+// 生成・コピーを繰り返してもヒープ確保が発生しない
+TEST(OptionTest, copyWithoutAllocation) {
+    const std::size_t copies = 100000;
+    AllocationCounter counter;
+    Option<std::size_t> target = None;
+    for (std::size_t i = 0; i < copies; i++) {
+        Option<std::size_t> next = Some(target.unwrapOr(0) + 1);
+        target = next;
+    }
+    const std::size_t allocations = counter.count();
+
+    EXPECT_EQ(allocations, 0);
+    EXPECT_EQ(target.unwrap(), copies);
+}
@@ -11,7 +11,7 @@ TEST(ReadRequestOk, withBody) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
-    Fake(Method(stub_callback, trigger));
+    Fake(Method(stub_callback, trigger), Method(stub_callback, maxBodySize));
 
     // NOTE: 参照型の引数の検証が非対応なので, 変数に保存する
     // refs: https://github.com/eranpeer/FakeIt/issues/31
@@ -19,24 +19,28 @@ TEST(ReadRequestOk, withBody) {
     When(Method(stub_context, setRequest)).Do([&](auto req) {
         req_set = req;
     });
+    RequestBody body;
+    When(Method(stub_context, getRequestBody)).AlwaysDo([&]() -> RequestBody & {
+        return body;
+    });
 
     // body として hello を返す
     When(Method(stub_reader, read)).Do([](auto buf, auto) {
         std::memcpy(buf, "hello", 5);
         return Ok(5ul);
     });
-    When(Method(stub_reader, readLine))
+    When(Method(stub_reader, readLineView))
             .Do([](auto) {
-                return Ok<std::string>("POST / HTTP/1.1\r\n");
+                return Ok(StringView("POST / HTTP/1.1\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("Content-Length: 5\r\n");
+                return Ok(StringView("Content-Length: 5\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("\r\n");
+                return Ok(StringView("\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("hello");
+                return Ok(StringView("hello"));
             });
 
     ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
@@ -46,15 +50,16 @@ TEST(ReadRequestOk, withBody) {
     auto task_result = result.unwrap();
     EXPECT_EQ(task_result, kTaskComplete);
 
-    // readLine が 4 回呼ばれる
-    Verify(Method(stub_reader, readLine)).Exactly(3_Times);
+    // readLineView が 3 回呼ばれる
+    Verify(Method(stub_reader, readLineView)).Exactly(3_Times);
 
     // read が 1 回以上呼ばれる
     Verify(Method(stub_reader, read)).AtLeastOnce();
 
     // パース結果
-    auto req = Request(kMethodPost, "/", "HTTP/1.1", {{"Content-Length", "5"}}, "hello");
+    auto req = Request(kMethodPost, "/", "HTTP/1.1", {{"Content-Length", "5"}});
     EXPECT_EQ(req, req_set);
+    EXPECT_EQ(body.toString().unwrap(), "hello");
     // TODO: Fakeit が対応したらコメントアウトを外す
     // Verify(Method(stub_context, setRequest).Using(req)).Once();
 
@@ -69,19 +74,19 @@ TEST(ReadRequestOk, withoutBody) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
-    Fake(Method(stub_callback, trigger));
+    Fake(Method(stub_callback, trigger), Method(stub_callback, maxBodySize));
 
     Request req_set;
     When(Method(stub_context, setRequest)).Do([&](auto req) {
         req_set = req;
     });
 
-    When(Method(stub_reader, readLine))
+    When(Method(stub_reader, readLineView))
             .Do([](auto) {
-                return Ok<std::string>("GET / HTTP/1.1\r\n");
+                return Ok(StringView("GET / HTTP/1.1\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("\r\n");
+                return Ok(StringView("\r\n"));
             });
 
     ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
@@ -91,15 +96,118 @@ TEST(ReadRequestOk, withoutBody) {
     auto task_result = result.unwrap();
     EXPECT_EQ(task_result, kTaskComplete);
 
-    Verify(Method(stub_reader, readLine)).Exactly(2_Times);
+    Verify(Method(stub_reader, readLineView)).Exactly(2_Times);
     Verify(Method(stub_reader, read)).Never();
 
-    auto req = Request(kMethodGet, "/", "HTTP/1.1", {}, "");
+    auto req = Request(kMethodGet, "/", "HTTP/1.1");
     EXPECT_EQ(req, req_set);
 
     Verify(Method(stub_callback, trigger)).Once();
 }
 
+// 行の途中で読めるデータがなくなった場合は中断し, 次回の実行で続きから読む
+TEST(ReadRequestOk, resumeRequestLine) {
+    Mock<IContext> stub_context;
+    Mock<IReadRequestCallback> stub_callback;
+    Mock<IBufferedReader> stub_reader;
+
+    Fake(Method(stub_context, getManager),
+         Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, trigger), Method(stub_callback, triggerSuspend), Method(stub_callback, maxBodySize));
+
+    Request req_set;
+    When(Method(stub_context, setRequest)).Do([&](auto req) {
+        req_set = req;
+    });
+
+    When(Method(stub_reader, eof)).AlwaysReturn(false);
+    When(Method(stub_reader, readLineView))
+            .Do([](auto) {
+                return Ok(StringView("GET / HT"));
+            })
+            .Do([](auto) {
+                return Ok(StringView("TP/1.1\r"));
+            })
+            .Do([](auto) {
+                return Ok(StringView("\n"));
+            })
+            .Do([](auto) {
+                return Ok(StringView("\r\n"));
+            });
+
+    ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
+    auto result = task.execute();
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), kTaskSuspend);
+    Verify(Method(stub_callback, trigger)).Never();
+
+    result = task.execute();
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), kTaskSuspend);
+
+    result = task.execute();
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), kTaskComplete);
+
+    auto req = Request(kMethodGet, "/", "HTTP/1.1");
+    EXPECT_EQ(req, req_set);
+    Verify(Method(stub_callback, trigger)).Once();
+}
+
+TEST(ReadRequestOk, resumeBody) {
+    Mock<IContext> stub_context;
+    Mock<IReadRequestCallback> stub_callback;
+    Mock<IBufferedReader> stub_reader;
+
+    Fake(Method(stub_context, getManager),
+         Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, trigger), Method(stub_callback, triggerSuspend), Method(stub_callback, maxBodySize));
+
+    Request req_set;
+    When(Method(stub_context, setRequest)).Do([&](auto req) {
+        req_set = req;
+    });
+    RequestBody body;
+    When(Method(stub_context, getRequestBody)).AlwaysDo([&]() -> RequestBody & {
+        return body;
+    });
+
+    When(Method(stub_reader, eof)).AlwaysReturn(false);
+    When(Method(stub_reader, readLineView))
+            .Do([](auto) {
+                return Ok(StringView("POST / HTTP/1.1\r\n"));
+            })
+            .Do([](auto) {
+                return Ok(StringView("Content-Length: 5\r\n"));
+            })
+            .Do([](auto) {
+                return Ok(StringView("\r\n"));
+            });
+    When(Method(stub_reader, read))
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "he", 2);
+                return Ok(2ul);
+            })
+            .Do([](auto buf, auto) {
+                std::memcpy(buf, "llo", 3);
+                return Ok(3ul);
+            });
+
+    ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
+    auto result = task.execute();
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), kTaskSuspend);
+
+    result = task.execute();
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap(), kTaskComplete);
+
+    auto req = Request(kMethodPost, "/", "HTTP/1.1", {{"Content-Length", "5"}});
+    EXPECT_EQ(req, req_set);
+    EXPECT_EQ(body.toString().unwrap(), "hello");
+    Verify(Method(stub_callback, trigger)).Once();
+}
+
 TEST(ReadRequestErr, readLineErr) {
     Mock<IContext> stub_context;
     Mock<IReadRequestCallback> stub_callback;
@@ -107,15 +215,20 @@ TEST(ReadRequestErr, readLineErr) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
-    Fake(Method(stub_callback, trigger));
+    Fake(Method(stub_callback, triggerError));
+    Fake(Method(stub_callback, trigger), Method(stub_callback, maxBodySize));
 
-    When(Method(stub_reader, readLine)).Do([](auto) {
+    When(Method(stub_reader, readLineView)).Do([](auto) {
         return Err<std::string>("readLine error");
     });
 
     ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
     auto result = task.execute();
     ASSERT_TRUE(result.isErr());
+
+    // エラーはコールバックに通知される
+    Verify(Method(stub_callback, triggerError)).Once();
+    Verify(Method(stub_callback, trigger)).Never();
 }
 
 TEST(ReadRequestErr, readErr) {
@@ -125,16 +238,22 @@ TEST(ReadRequestErr, readErr) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, triggerError), Method(stub_callback, maxBodySize));
+    Fake(Method(stub_context, setRequest));
+    RequestBody body;
+    When(Method(stub_context, getRequestBody)).AlwaysDo([&]() -> RequestBody & {
+        return body;
+    });
 
-    When(Method(stub_reader, readLine))
+    When(Method(stub_reader, readLineView))
             .Do([](auto) {
-                return Ok<std::string>("POST / HTTP/1.1\r\n");
+                return Ok(StringView("POST / HTTP/1.1\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("Content-Length: 5\r\n");
+                return Ok(StringView("Content-Length: 5\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("\r\n");
+                return Ok(StringView("\r\n"));
             });
     When(Method(stub_reader, read)).Return(Err<std::string>("read error"));
 
@@ -150,13 +269,14 @@ TEST(ReadRequestErr, parseErr) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, triggerError));
 
-    When(Method(stub_reader, readLine))
+    When(Method(stub_reader, readLineView))
             .Do([](auto) {
-                return Ok<std::string>("XXX / HTTP/1.1\r\n");
+                return Ok(StringView("XXX / HTTP/1.1\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("\r\n");
+                return Ok(StringView("\r\n"));
             });
 
     ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
@@ -171,10 +291,12 @@ TEST(ReadRequestErr, requestLineEnd) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, triggerError));
 
-    When(Method(stub_reader, readLine)).Do([](auto) {
-        return Ok<std::string>("GET / HTTP/1.1");
+    When(Method(stub_reader, readLineView)).Do([](auto) {
+        return Ok(StringView("GET / HTTP/1.1"));
     });
+    When(Method(stub_reader, eof)).AlwaysReturn(true);
 
     ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
     auto result = task.execute();
@@ -188,14 +310,16 @@ TEST(ReadRequestErr, headerLineEnd) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, triggerError));
 
-    When(Method(stub_reader, readLine))
+    When(Method(stub_reader, readLineView))
             .Do([](auto) {
-                return Ok<std::string>("GET / HTTP/1.1\r\n");
+                return Ok(StringView("GET / HTTP/1.1\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("Content-Length: 5");
+                return Ok(StringView("Content-Length: 5"));
             });
+    When(Method(stub_reader, eof)).AlwaysReturn(true);
 
     ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
     auto result = task.execute();
@@ -209,10 +333,11 @@ TEST(ReadRequestErr, headerLineReadErr) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, triggerError));
 
-    When(Method(stub_reader, readLine))
+    When(Method(stub_reader, readLineView))
             .Do([](auto) {
-                return Ok<std::string>("GET / HTTP/1.1\r\n");
+                return Ok(StringView("GET / HTTP/1.1\r\n"));
             })
             .Return(Err<std::string>("readLine error"));
 
@@ -228,13 +353,14 @@ TEST(ReadRequestErr, parseHeaderFieldLineErr) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, triggerError));
 
-    When(Method(stub_reader, readLine))
+    When(Method(stub_reader, readLineView))
             .Do([](auto) {
-                return Ok<std::string>("GET / HTTP/1.1\r\n");
+                return Ok(StringView("GET / HTTP/1.1\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("INVALID_HEADER\r\n");
+                return Ok(StringView("INVALID_HEADER\r\n"));
             });
 
     ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
@@ -242,6 +368,7 @@ TEST(ReadRequestErr, parseHeaderFieldLineErr) {
     ASSERT_TRUE(result.isErr());
 }
 
+// 数値として読めない Content-Length は 400 で拒否する
 TEST(ReadRequestErr, invalidContentLength) {
     Mock<IContext> stub_context;
     Mock<IReadRequestCallback> stub_callback;
@@ -249,16 +376,102 @@ TEST(ReadRequestErr, invalidContentLength) {
 
     Fake(Method(stub_context, getManager),
          Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, triggerError), Method(stub_callback, triggerReject));
 
-    When(Method(stub_reader, readLine))
+    When(Method(stub_reader, readLineView))
             .Do([](auto) {
-                return Ok<std::string>("GET / HTTP/1.1\r\n");
+                return Ok(StringView("GET / HTTP/1.1\r\n"));
             })
             .Do([](auto) {
-                return Ok<std::string>("Content-Length: INVALID\r\n");
+                return Ok(StringView("Content-Length: INVALID\r\n"));
             });
 
     ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
     auto result = task.execute();
     ASSERT_TRUE(result.isErr());
-}
\ No newline at end of file
+    // 区切りが決まらないので, 接続を閉じるだけでなく 400 を返す
+    Verify(Method(stub_callback, triggerReject).Using(_, kStatusBadRequest, _)).Once();
+    Verify(Method(stub_callback, triggerError)).Never();
+}
+
+TEST(ReadRequestErr, bareLf) {
+    Mock<IContext> stub_context;
+    Mock<IReadRequestCallback> stub_callback;
+    Mock<IBufferedReader> stub_reader;
+
+    Fake(Method(stub_context, getManager),
+         Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, triggerError));
+
+    When(Method(stub_reader, readLineView)).Do([](auto) {
+        return Ok(StringView("GET / HTTP/1.1\n"));
+    });
+
+    ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
+    auto result = task.execute();
+    ASSERT_TRUE(result.isErr());
+}
+
+TEST(ReadRequestErr, closedBeforeBody) {
+    Mock<IContext> stub_context;
+    Mock<IReadRequestCallback> stub_callback;
+    Mock<IBufferedReader> stub_reader;
+
+    Fake(Method(stub_context, getManager),
+         Method(stub_context, getClientFd));
+    Fake(Method(stub_callback, triggerError), Method(stub_callback, maxBodySize));
+    Fake(Method(stub_context, setRequest));
+    RequestBody body;
+    When(Method(stub_context, getRequestBody)).AlwaysDo([&]() -> RequestBody & {
+        return body;
+    });
+
+    When(Method(stub_reader, readLineView))
+            .Do([](auto) {
+                return Ok(StringView("POST / HTTP/1.1\r\n"));
+            })
+            .Do([](auto) {
+                return Ok(StringView("Content-Length: 5\r\n"));
+            })
+            .Do([](auto) {
+                return Ok(StringView("\r\n"));
+            });
+    When(Method(stub_reader, read)).Return(Ok(0ul));
+    When(Method(stub_reader, eof)).AlwaysReturn(true);
+
+    ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
+    auto result = task.execute();
+    ASSERT_TRUE(result.isErr());
+}
+
+// 宣言された Content-Length が上限を超えていれば, message-body を読まずに拒否する
+TEST(ReadRequestErr, contentLengthTooLarge) {
+    Mock<IContext> stub_context;
+    Mock<IReadRequestCallback> stub_callback;
+    Mock<IBufferedReader> stub_reader;
+
+    Fake(Method(stub_context, getManager),
+         Method(stub_context, getClientFd),
+         Method(stub_context, setRequest));
+    Fake(Method(stub_callback, triggerError), Method(stub_callback, triggerBodyTooLarge));
+    When(Method(stub_callback, maxBodySize)).Return(4ul);
+
+    When(Method(stub_reader, readLineView))
+            .Do([](auto) {
+                return Ok(StringView("POST / HTTP/1.1\r\n"));
+            })
+            .Do([](auto) {
+                return Ok(StringView("Content-Length: 5\r\n"));
+            })
+            .Do([](auto) {
+                return Ok(StringView("\r\n"));
+            });
+
+    ReadRequest task(&stub_context.get(), &stub_callback.get(), &stub_reader.get());
+    auto result = task.execute();
+    ASSERT_TRUE(result.isErr());
+
+    Verify(Method(stub_reader, read)).Never();
+    Verify(Method(stub_callback, triggerBodyTooLarge)).Once();
+    Verify(Method(stub_callback, triggerError)).Never();
+}
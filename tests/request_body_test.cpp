@@ -0,0 +1,106 @@
+#include "http/request_body.hpp"
+#include <dirent.h>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+namespace {
+    std::string readAll(RequestBody &body, std::size_t chunk_size) {
+        std::string result;
+        std::vector<char> buf(chunk_size);
+        while (!body.eof()) {
+            const std::size_t n = body.read(buf.data(), buf.size()).unwrap();
+            if (n == 0) {
+                break;
+            }
+            result.append(buf.data(), n);
+        }
+        return result;
+    }
+
+    // 開いている fd のうち, パスが path_prefix で始まるもの
+    std::vector<int> findOpenFds(const std::string &path_prefix) {
+        std::vector<int> fds;
+        DIR *dir = opendir("/proc/self/fd");
+        if (dir == NULL) {
+            return fds;
+        }
+        while (const struct dirent *entry = readdir(dir)) {
+            const std::string link = std::string("/proc/self/fd/") + entry->d_name;
+            char target[4096];
+            const ssize_t n = readlink(link.c_str(), target, sizeof(target));
+            if (n > 0 && std::string(target, n).compare(0, path_prefix.size(), path_prefix) == 0) {
+                fds.push_back(std::atoi(entry->d_name));
+            }
+        }
+        closedir(dir);
+        return fds;
+    }
+} // namespace
+
+TEST(RequestBodyTest, keepsSmallBodyInMemory) {
+    RequestBody body(8);
+    ASSERT_TRUE(body.append("hello", 5).isOk());
+    ASSERT_TRUE(body.append("!", 1).isOk());
+    EXPECT_FALSE(body.isSpilled());
+    EXPECT_EQ(body.size(), 6U);
+    EXPECT_EQ(readAll(body, 4), "hello!");
+    EXPECT_TRUE(body.eof());
+}
+
+TEST(RequestBodyTest, spillsLargeBodyToFile) {
+    RequestBody body(8);
+    ASSERT_TRUE(body.append("hello, ", 7).isOk());
+    EXPECT_FALSE(body.isSpilled());
+    ASSERT_TRUE(body.append("world", 5).isOk());
+    EXPECT_TRUE(body.isSpilled());
+    ASSERT_TRUE(body.append("!", 1).isOk());
+    EXPECT_EQ(body.size(), 13U);
+    EXPECT_EQ(readAll(body, 3), "hello, world!");
+    EXPECT_EQ(body.toString().unwrap(), "hello, world!");
+}
+
+TEST(RequestBodyTest, rewind) {
+    RequestBody body(4);
+    ASSERT_TRUE(body.append("abcdef", 6).isOk());
+    EXPECT_EQ(readAll(body, 4), "abcdef");
+    body.rewind();
+    EXPECT_FALSE(body.eof());
+    EXPECT_EQ(readAll(body, 2), "abcdef");
+}
+
+TEST(RequestBodyTest, clearDiscardsSpilledBody) {
+    RequestBody body(4);
+    ASSERT_TRUE(body.append("abcdef", 6).isOk());
+    ASSERT_TRUE(body.isSpilled());
+    body.clear();
+    EXPECT_FALSE(body.isSpilled());
+    EXPECT_EQ(body.size(), 0U);
+    EXPECT_TRUE(body.eof());
+
+    ASSERT_TRUE(body.append("xy", 2).isOk());
+    EXPECT_FALSE(body.isSpilled());
+    EXPECT_EQ(body.toString().unwrap(), "xy");
+}
+
+TEST(RequestBodyTest, tempDirNotFound) {
+    RequestBody body(4, "/nonexistent/webserv");
+    EXPECT_TRUE(body.append("ab", 2).isOk());
+    EXPECT_TRUE(body.append("cdef", 4).isErr());
+}
+
+// CGI などの子プロセスに引き継がれないよう, 一時ファイルは close-on-exec で開かれる
+TEST(RequestBodyTest, spilledFileIsCloseOnExec) {
+    char dir_template[] = "/tmp/webserv_body_test_XXXXXX";
+    ASSERT_NE(mkdtemp(dir_template), nullptr);
+    const std::string temp_dir = dir_template;
+    {
+        RequestBody body(4, temp_dir);
+        ASSERT_TRUE(body.append("abcdef", 6).isOk());
+        ASSERT_TRUE(body.isSpilled());
+        const std::vector<int> fds = findOpenFds(temp_dir + "/webserv_body_");
+        ASSERT_EQ(fds.size(), 1U);
+        EXPECT_TRUE(fcntl(fds[0], F_GETFD) & FD_CLOEXEC);
+    }
+    rmdir(temp_dir.c_str());
+}
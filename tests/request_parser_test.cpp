@@ -68,92 +68,154 @@ TEST(ParseHeaderFieldLineOk, spaceInValue) {
 }
 
 TEST(ParseRequestRequestLineErr, empty) {
-    const auto result = RequestParser::parseRequest("", {}, "");
+    const auto result = RequestParser::parseRequest("", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, noSpace) {
-    const auto result = RequestParser::parseRequest("GET/pathHTTP/1.1", {}, "");
+    const auto result = RequestParser::parseRequest("GET/pathHTTP/1.1", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, noMethod) {
-    const auto result = RequestParser::parseRequest("/path HTTP/1.1", {}, "");
+    const auto result = RequestParser::parseRequest("/path HTTP/1.1", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, noRequestTarget) {
-    const auto result = RequestParser::parseRequest("GET HTTP/1.1", {}, "");
+    const auto result = RequestParser::parseRequest("GET HTTP/1.1", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, noHTTPVersion) {
-    const auto result = RequestParser::parseRequest("GET /path", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, invalidMethod) {
-    const auto result = RequestParser::parseRequest("XXX /path HTTP/1.1", {}, "");
+    const auto result = RequestParser::parseRequest("XXX /path HTTP/1.1", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, invalidHTTPVersion) {
-    const auto result = RequestParser::parseRequest("GET /path XXX/1.0", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path XXX/1.0", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, lowerCaseHTTPVersion) {
-    const auto result = RequestParser::parseRequest("GET /path http/1.1", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path http/1.1", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, noVersionNumber) {
-    const auto result = RequestParser::parseRequest("GET /path HTTP/", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path HTTP/", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, noVersionNumber2) {
-    const auto result = RequestParser::parseRequest("GET /path HTTP/.", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path HTTP/.", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, noMajorVersion) {
-    const auto result = RequestParser::parseRequest("GET /path HTTP/.1", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path HTTP/.1", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, noMinorVersion) {
-    const auto result = RequestParser::parseRequest("GET /path HTTP/1.", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path HTTP/1.", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, nonDigitMajorVersion) {
-    const auto result = RequestParser::parseRequest("GET /path HTTP/X.1", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path HTTP/X.1", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, nonDigitMinorVersion) {
-    const auto result = RequestParser::parseRequest("GET /path HTTP/1.X", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path HTTP/1.X", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineErr, longVersion) {
-    const auto result = RequestParser::parseRequest("GET /path HTTP/1.1.1", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path HTTP/1.1.1", {});
     EXPECT_TRUE(result.isErr());
 }
 
 TEST(ParseRequestRequestLineOk, normal) {
-    const auto result = RequestParser::parseRequest("GET /path HTTP/1.1", {}, "");
+    const auto result = RequestParser::parseRequest("GET /path HTTP/1.1", {});
     EXPECT_TRUE(result.isOk());
 
-    Request expected(kMethodGet, "/path", "HTTP/1.1", {}, "");
+    Request expected(kMethodGet, "/path", "HTTP/1.1");
     EXPECT_EQ(result.unwrap(), expected);
 }
 
 TEST(ParseRequestOk, normal) {
-    const auto result = RequestParser::parseRequest("GET /path HTTP/1.1", {"Host: example.com"}, "body");
+    const auto result = RequestParser::parseRequest("GET /path HTTP/1.1", {"Host: example.com"});
     EXPECT_TRUE(result.isOk());
 
-    Request expected(kMethodGet, "/path", "HTTP/1.1", {{"Host", "example.com"}}, "body");
+    Request expected(kMethodGet, "/path", "HTTP/1.1", {{"Host", "example.com"}});
     EXPECT_EQ(result.unwrap(), expected);
 }
+
+TEST(ParseHeaderFieldLineErr, controlCharacterInValue) {
+    const auto result = RequestParser::parseHeaderFieldLine(std::string("Host: exa\0mple.com", 18));
+    EXPECT_TRUE(result.isErr());
+}
+
+TEST(ParseHeaderFieldLineErr, nonTokenFieldName) {
+    const auto result = RequestParser::parseHeaderFieldLine("Ho(st: example.com");
+    EXPECT_TRUE(result.isErr());
+}
+
+// field-value = *field-content なので空でもよい
+TEST(ParseHeaderFieldLineOk, emptyValue) {
+    const auto result = RequestParser::parseHeaderFieldLine("X-Empty: \t ");
+    EXPECT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap().first, "X-Empty");
+    EXPECT_EQ(result.unwrap().second, "");
+}
+
+TEST(ParseHeaderFieldLineOk, tabInValue) {
+    const auto result = RequestParser::parseHeaderFieldLine("X-Tab: a\tb");
+    EXPECT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap().second, "a\tb");
+}
+
+TEST(ParseHeaderFieldLineOk, obsTextInValue) {
+    const auto result = RequestParser::parseHeaderFieldLine("X-Obs: caf\xc3\xa9");
+    EXPECT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap().second, "caf\xc3\xa9");
+}
+
+TEST(ParseRequestRequestLineErr, spaceInRequestTarget) {
+    const auto result = RequestParser::parseRequest("GET /a b HTTP/1.1", {});
+    EXPECT_TRUE(result.isErr());
+}
+
+TEST(ParseRequestRequestLineErr, doubleSpace) {
+    const auto result = RequestParser::parseRequest("GET  /path HTTP/1.1", {});
+    EXPECT_TRUE(result.isErr());
+}
+
+// scan はコピーせず, 行の中を指す
+TEST(ScanHeaderFieldLineOk, viewsIntoLine) {
+    const StringView line("Host:  example.com ");
+    const auto result = RequestParser::scanHeaderFieldLine(line);
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap().name.data(), line.data());
+    EXPECT_EQ(result.unwrap().name.size(), 4u);
+    EXPECT_EQ(result.unwrap().value.data(), line.data() + 7);
+    EXPECT_EQ(result.unwrap().value.size(), 11u);
+}
+
+TEST(ScanRequestLineOk, viewsIntoLine) {
+    const StringView line("POST /upload?x=1 HTTP/1.0");
+    const auto result = RequestParser::scanRequestLine(line);
+    ASSERT_TRUE(result.isOk());
+    EXPECT_EQ(result.unwrap().method, kMethodPost);
+    EXPECT_EQ(result.unwrap().request_target.data(), line.data() + 5);
+    EXPECT_EQ(result.unwrap().request_target.size(), 11u);
+    EXPECT_EQ(result.unwrap().http_version.data(), line.data() + 17);
+    EXPECT_EQ(result.unwrap().http_version.size(), 8u);
+}
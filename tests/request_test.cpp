@@ -0,0 +1,63 @@
+#include "http/request.hpp"
+#include <gtest/gtest.h>
+
+TEST(RequestKeepAlive, http11Default) {
+    Request request(kMethodGet, "/", "HTTP/1.1");
+    EXPECT_TRUE(request.isKeepAlive());
+}
+
+TEST(RequestKeepAlive, http11Close) {
+    Request request(kMethodGet, "/", "HTTP/1.1", {{"Connection", "close"}});
+    EXPECT_FALSE(request.isKeepAlive());
+}
+
+TEST(RequestKeepAlive, http11CloseCaseInsensitiveInList) {
+    Request request(kMethodGet, "/", "HTTP/1.1", {{"Connection", "Upgrade , Close"}});
+    EXPECT_FALSE(request.isKeepAlive());
+}
+
+TEST(RequestKeepAlive, http11OtherOption) {
+    Request request(kMethodGet, "/", "HTTP/1.1", {{"Connection", "closed"}});
+    EXPECT_TRUE(request.isKeepAlive());
+}
+
+TEST(RequestKeepAlive, http10Default) {
+    Request request(kMethodGet, "/", "HTTP/1.0");
+    EXPECT_FALSE(request.isKeepAlive());
+}
+
+TEST(RequestKeepAlive, http10KeepAlive) {
+    Request request(kMethodGet, "/", "HTTP/1.0", {{"Connection", "Keep-Alive"}});
+    EXPECT_TRUE(request.isKeepAlive());
+}
+
+TEST(RequestHeader, caseInsensitive) {
+    Request request(kMethodGet, "/", "HTTP/1.1", {{"content-type", "text/plain"}, {"X-Foo", "bar"}});
+    EXPECT_EQ(request.header(kHeaderContentType), Some(StringView("text/plain")));
+    EXPECT_EQ(request.header("Content-Type"), Some(StringView("text/plain")));
+    EXPECT_EQ(request.header("x-foo"), Some(StringView("bar")));
+    EXPECT_EQ(request.header(kHeaderHost), None);
+}
+
+// 自分のアリーナを使うリクエストも, 借りたアリーナを使うリクエストも入れ替えられる
+TEST(RequestSwap, exchangesOwnAndBorrowedArenas) {
+    Arena arena;
+    HeaderTable headers(&arena);
+    headers.add("Host", "borrowed");
+    Request borrowed(kMethodGet, arena.copy("/borrowed"), arena.copy("HTTP/1.1"), headers, arena);
+    Request own(kMethodPost, "/own", "HTTP/1.0", {{"Host", "own"}});
+    const StringView own_path = own.path();
+
+    borrowed.swap(own);
+    EXPECT_EQ(borrowed.path(), "/own");
+    EXPECT_EQ(borrowed.path().data(), own_path.data());
+    EXPECT_EQ(borrowed.header(kHeaderHost).unwrap(), "own");
+    EXPECT_EQ(own.path(), "/borrowed");
+    EXPECT_EQ(own.header(kHeaderHost).unwrap(), "borrowed");
+
+    // 入れ替えた後も, それぞれのアリーナに追加できる
+    Request copy = borrowed;
+    EXPECT_EQ(copy, borrowed);
+    own = Request(kMethodGet, "/again", "HTTP/1.1");
+    EXPECT_EQ(own.path(), "/again");
+}
@@ -0,0 +1,223 @@
+#include "task/response_queue.hpp"
+#include <climits>
+#include <csignal>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class CountingCallback : public IWriteFileCallback {
+public:
+    int written = 0;
+    int errors = 0;
+
+    Result<types::Unit, std::string> trigger() override {
+        written++;
+        return Ok(unit);
+    }
+
+    Result<types::Unit, std::string> triggerError(const std::string &) override {
+        errors++;
+        return Ok(unit);
+    }
+};
+
+class ResponseQueueTest : public ::testing::Test {
+protected:
+    IOTaskManager manager_;
+    CountingCallback callback_;
+    int fds_[2] = {-1, -1};
+
+    void SetUp() override {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds_), 0);
+        ASSERT_NE(fcntl(fds_[0], F_SETFL, O_NONBLOCK), -1);
+        ASSERT_NE(fcntl(fds_[1], F_SETFL, O_NONBLOCK), -1);
+    }
+
+    void TearDown() override {
+        close(fds_[0]);
+        close(fds_[1]);
+    }
+
+    void runLoop() {
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(manager_.executeReadyTasks(0).isOk());
+        }
+    }
+
+    std::string receive() {
+        std::string received;
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fds_[1], buf, sizeof(buf))) > 0) {
+            received.append(buf, n);
+        }
+        return received;
+    }
+};
+
+// body はコピーされずに引き取られ, head と body が順に書かれる
+TEST_F(ResponseQueueTest, writesHeadsAndBodiesInOrder) {
+    ResponseQueue queue(manager_, fds_[0], &callback_);
+    std::string first = "one";
+    std::string second(10000, 'x');
+
+    queue.push("HEAD1\r\n\r\n", first);
+    queue.push("HTTP/1.1 100 Continue\r\n\r\n");
+    queue.push("HEAD2\r\n\r\n", second);
+    EXPECT_TRUE(first.empty());
+    EXPECT_TRUE(second.empty());
+    EXPECT_EQ(queue.size(), 3);
+
+    queue.flush();
+    runLoop();
+    EXPECT_EQ(receive(), "HEAD1\r\n\r\none"
+                         "HTTP/1.1 100 Continue\r\n\r\n"
+                         "HEAD2\r\n\r\n" + std::string(10000, 'x'));
+    EXPECT_EQ(queue.size(), 0);
+    EXPECT_EQ(callback_.written, 1);
+
+    std::string third = "three";
+    queue.push("HEAD3\r\n\r\n", third);
+    queue.push("HEAD4\r\n\r\n", third);
+    EXPECT_TRUE(third.empty());
+    queue.flush();
+    runLoop();
+    EXPECT_EQ(receive(), "HEAD3\r\n\r\nthreeHEAD4\r\n\r\n");
+    EXPECT_EQ(callback_.written, 2);
+}
+
+// 書き込み中に積まれたレスポンスは, その後にまとめて書かれる
+TEST_F(ResponseQueueTest, pushWhileWriting) {
+    ResponseQueue queue(manager_, fds_[0], &callback_);
+    std::string body = "a";
+    queue.push("H1 ", body);
+    queue.flush();
+
+    body = "b";
+    queue.push("H2 ", body);
+    queue.flush(); // 書き込み中なので何もしない
+    EXPECT_EQ(queue.size(), 2);
+
+    runLoop();
+    EXPECT_EQ(receive(), "H1 aH2 b");
+    EXPECT_EQ(queue.size(), 0);
+    EXPECT_EQ(callback_.written, 1);
+}
+
+TEST_F(ResponseQueueTest, clearDiscardsResponses) {
+    ResponseQueue queue(manager_, fds_[0], &callback_);
+    std::string body = "a";
+    queue.push("H1 ", body);
+    queue.flush();
+    queue.push("H2 ");
+    queue.clear();
+    EXPECT_EQ(queue.size(), 0);
+
+    runLoop();
+    EXPECT_EQ(receive(), "");
+    EXPECT_EQ(callback_.written, 0);
+}
+
+// ソケットのバッファに収まらないレスポンスは, 読まれるたびに続きから書かれる
+TEST_F(ResponseQueueTest, resumesPartialWrites) {
+    const int buffer_size = 4096;
+    ASSERT_EQ(setsockopt(fds_[0], SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size)), 0);
+    ASSERT_EQ(setsockopt(fds_[1], SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size)), 0);
+    ResponseQueue queue(manager_, fds_[0], &callback_);
+    const std::string head = "HEAD\r\n\r\n";
+    std::string expected = head;
+    for (std::size_t i = 0; i < 1024 * 1024; i++) {
+        expected += static_cast<char>('a' + i % 26);
+    }
+    std::string body = expected.substr(head.size());
+    queue.push(head, body);
+    queue.flush();
+
+    runLoop();
+    std::string received = receive();
+    ASSERT_LT(received.size(), expected.size());
+    EXPECT_EQ(callback_.written, 0);
+    EXPECT_EQ(queue.size(), 1);
+
+    for (int i = 0; i < 100000 && received.size() < expected.size(); i++) {
+        runLoop();
+        received += receive();
+    }
+    EXPECT_EQ(received.size(), expected.size());
+    EXPECT_TRUE(received == expected);
+    EXPECT_EQ(callback_.written, 1);
+    EXPECT_EQ(callback_.errors, 0);
+    EXPECT_EQ(queue.size(), 0);
+}
+
+// 1 回の writev に渡せる数を超えるセグメントも全て書かれる
+TEST_F(ResponseQueueTest, writesMoreSegmentsThanIovMax) {
+    ResponseQueue queue(manager_, fds_[0], &callback_);
+    std::string expected;
+    for (int i = 0; i < IOV_MAX; i++) {
+        std::string body = std::to_string(i);
+        expected += "H" + body;
+        queue.push("H", body);
+    }
+    queue.flush();
+
+    std::string received;
+    for (int i = 0; i < 100 && callback_.written == 0; i++) {
+        runLoop();
+        received += receive();
+    }
+    EXPECT_EQ(received, expected);
+    EXPECT_EQ(callback_.written, 1);
+}
+
+TEST_F(ResponseQueueTest, reportsWriteError) {
+    signal(SIGPIPE, SIG_IGN);
+    close(fds_[1]);
+    fds_[1] = -1;
+    ResponseQueue queue(manager_, fds_[0], &callback_);
+    std::string body = "a";
+    queue.push("H1 ", body);
+    queue.flush();
+
+    runLoop();
+    EXPECT_EQ(callback_.written, 0);
+    EXPECT_EQ(callback_.errors, 1);
+    EXPECT_EQ(queue.size(), 0);
+}
+
+// 書き終えた body の領域は, 接続が続いても合計で kMaxRetainedBodySize までしか持ち続けない
+TEST_F(ResponseQueueTest, releasesBodiesOnceWritten) {
+    ResponseQueue queue(manager_, fds_[0], &callback_);
+    const std::size_t body_size = 40 * 1024;
+    for (int i = 0; i < 4; i++) {
+        std::string body(body_size, 'a');
+        queue.push("H", body);
+    }
+    queue.flush();
+    EXPECT_GE(queue.bodyCapacity(), 4 * body_size);
+
+    std::string received;
+    for (int i = 0; i < 1000 && callback_.written == 0; i++) {
+        runLoop();
+        received += receive();
+    }
+    EXPECT_EQ(received.size(), 4 * (1 + body_size));
+    ASSERT_EQ(callback_.written, 1);
+    EXPECT_LE(queue.bodyCapacity(), ResponseQueue::kMaxRetainedBodySize);
+
+    // 接続を閉じてプールに戻すときは全て解放する
+    queue.clear();
+    EXPECT_LT(queue.bodyCapacity(), 1024);
+}
+
+TEST_F(ResponseQueueTest, clearReleasesPendingBodies) {
+    ResponseQueue queue(manager_, fds_[0], &callback_);
+    std::string body(1024 * 1024, 'a');
+    queue.push("H", body);
+    queue.flush();
+    std::string pending(1024 * 1024, 'b');
+    queue.push("H", pending);
+    queue.clear();
+    EXPECT_LT(queue.bodyCapacity(), 1024);
+}
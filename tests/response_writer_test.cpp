@@ -1,5 +1,6 @@
 #include "fakeit.hpp"
 #include "http/response_writer.hpp"
+#include "without_date.hpp"
 #include <gtest/gtest.h>
 
 using namespace fakeit;
@@ -25,7 +26,7 @@ TEST(ResponseWriterTest, sendShortBodyToOStream) {
     writer.addBody("Hello, world!");
     writer.send();
 
-    EXPECT_EQ("HTTP/1.1 200 OK\r\nContent-Length: 13\r\n\r\nHello, world!", output.str());
+    EXPECT_EQ("HTTP/1.1 200 OK\r\nContent-Length: 13\r\n\r\nHello, world!", withoutDate(output.str()));
 }
 
 TEST(ResponseWriterTest, sendLongBodyToOStream) {
@@ -38,7 +39,7 @@ TEST(ResponseWriterTest, sendLongBodyToOStream) {
     writer.send();
 
     std::string expected = "HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n" + long_body;
-    EXPECT_EQ(expected, output.str());
+    EXPECT_EQ(expected, withoutDate(output.str()));
 }
 
 TEST(ResponseWriterTest, sendHeadersToOStream) {
@@ -50,7 +51,7 @@ TEST(ResponseWriterTest, sendHeadersToOStream) {
     writer.send();
 
     std::string expected = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nContent-Type: text/plain\r\n\r\n";
-    EXPECT_EQ(expected, output.str());
+    EXPECT_EQ(expected, withoutDate(output.str()));
 }
 
 TEST(ResponseWriterTest, sendStatusToOStream) {
@@ -62,5 +63,28 @@ TEST(ResponseWriterTest, sendStatusToOStream) {
     writer.send();
 
     std::string expected = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+    EXPECT_EQ(expected, withoutDate(output.str()));
+}
+
+// Date は status-line の直後に書かれる
+TEST(ResponseWriterTest, sendDateToOStream) {
+    IOTaskManager manager;
+    std::ostringstream output;
+    ResponseWriter<std::ostream &> writer(manager, output, NULL);
+
+    writer.send();
+
+    const std::string expected = "HTTP/1.1 200 OK\r\n" + DateHeader::get(manager.getCurrentTime()).toString() + "Content-Length: 0\r\n\r\n";
     EXPECT_EQ(expected, output.str());
 }
+
+TEST(ResponseWriterTest, sendUndefinedStatusToOStream) {
+    IOTaskManager manager;
+    std::ostringstream output;
+    ResponseWriter<std::ostream &> writer(manager, output, NULL);
+
+    writer.setStatus(static_cast<HttpStatusCode>(299));
+    writer.send();
+
+    EXPECT_EQ("HTTP/1.1 299 \r\nContent-Length: 0\r\n\r\n", withoutDate(output.str()));
+}
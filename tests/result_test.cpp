@@ -1,3 +1,4 @@
+#include "allocation_counter.hpp"
 #include "utils/result.hpp"
 #include <gtest/gtest.h>
 
@@ -148,3 +149,49 @@ TEST(ResultTest, tryOrErr) {
     Result<int, std::string> target = Err<std::string>("error");
     EXPECT_EQ(doubleIf(target, 0), 0);
 }
+
+TEST(ResultTest, unwrapReturnsReference) {
+    Result<std::string, int> target = Ok<std::string>("ok");
+    target.unwrap() += "!";
+    EXPECT_EQ(target.unwrap(), "ok!");
+    EXPECT_EQ(&target.unwrap(), &target.unwrap());
+}
+
+TEST(ResultTest, copyIsIndependent) {
+    Result<std::string, int> original = Ok<std::string>("ok");
+    Result<std::string, int> copy = original;
+    copy.unwrap() = "changed";
+    EXPECT_EQ(original.unwrap(), "ok");
+}
+
+TEST(ResultTest, assignOkToErr) {
+    Result<std::string, std::string> target = Err<std::string>("error");
+    target = Ok<std::string>("ok");
+    ASSERT_TRUE(target.isOk());
+    EXPECT_EQ(target.unwrap(), "ok");
+
+    target = Err<std::string>("error");
+    ASSERT_TRUE(target.isErr());
+    EXPECT_EQ(target.unwrapErr(), "error");
+}
+
+Result<std::size_t, std::string> addOneToSize(const Result<std::size_t, std::string> &res) {
+    std::size_t value = TRY(res);
+
+    return Ok(value + 1);
+}
+
+// 生成・コピー・TRY による取り出しを繰り返してもヒープ確保が発生しない
+TEST(ResultTest, roundTripWithoutAllocation) {
+    const std::size_t round_trips = 100000;
+    AllocationCounter counter;
+    Result<std::size_t, std::string> target = Ok<std::size_t>(0);
+    for (std::size_t i = 0; i < round_trips; i++) {
+        Result<std::size_t, std::string> copy = target;
+        target = addOneToSize(copy);
+    }
+    const std::size_t allocations = counter.count();
+
+    EXPECT_EQ(allocations, 0);
+    EXPECT_EQ(target.unwrap(), round_trips);
+}
@@ -0,0 +1,26 @@
+#include "http/status.hpp"
+#include <gtest/gtest.h>
+
+TEST(HttpStatusTest, statusLine) {
+    EXPECT_EQ(getHttpStatusLine(kStatusOk).toString(), "HTTP/1.1 200 OK\r\n");
+    EXPECT_EQ(getHttpStatusLine(kStatusNotFound).toString(), "HTTP/1.1 404 Not Found\r\n");
+    EXPECT_EQ(getHttpStatusLine(kStatusNetworkAuthenticationRequired).toString(), "HTTP/1.1 511 Network Authentication Required\r\n");
+    EXPECT_TRUE(getHttpStatusLine(kStatusUnknown).empty());
+    EXPECT_TRUE(getHttpStatusLine(static_cast<HttpStatusCode>(299)).empty());
+    EXPECT_TRUE(getHttpStatusLine(static_cast<HttpStatusCode>(1000)).empty());
+}
+
+TEST(HttpStatusTest, statusText) {
+    EXPECT_EQ(getHttpStatusText(kStatusOk), "OK");
+    EXPECT_EQ(getHttpStatusText(kStatusImATeapot), "I'm a teapot");
+    EXPECT_EQ(getHttpStatusText(kStatusUnknown), "");
+}
+
+TEST(HttpStatusTest, fromInt) {
+    EXPECT_EQ(httpStatusCodeFromInt(200), kStatusOk);
+    EXPECT_EQ(httpStatusCodeFromInt(301), kStatusMovedPermanently);
+    EXPECT_EQ(httpStatusCodeFromInt(0), kStatusUnknown);
+    EXPECT_EQ(httpStatusCodeFromInt(306), kStatusUnknown);
+    EXPECT_EQ(httpStatusCodeFromInt(-1), kStatusUnknown);
+    EXPECT_EQ(httpStatusCodeFromInt(600), kStatusUnknown);
+}
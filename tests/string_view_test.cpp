@@ -0,0 +1,54 @@
+#include "utils/string_view.hpp"
+#include <gtest/gtest.h>
+
+TEST(StringView, construct) {
+    const std::string str = "hello";
+    EXPECT_EQ(StringView(str).data(), str.data());
+    EXPECT_EQ(StringView(str).size(), 5);
+    EXPECT_EQ(StringView("hello", 4), "hell");
+    EXPECT_TRUE(StringView().empty());
+}
+
+TEST(StringView, substr) {
+    const StringView view("hello");
+    EXPECT_EQ(view.substr(1, 3), "ell");
+    EXPECT_EQ(view.substr(1), "ello");
+    EXPECT_EQ(view.substr(5), "");
+    // 範囲外は末尾に丸める
+    EXPECT_EQ(view.substr(10), "");
+    EXPECT_EQ(view.substr(3, 10), "lo");
+}
+
+TEST(StringView, find) {
+    const StringView view("a b c");
+    EXPECT_EQ(view.find(' '), 1);
+    EXPECT_EQ(view.find(' ', 2), 3);
+    EXPECT_EQ(view.find('x'), StringView::npos);
+    EXPECT_EQ(view.rfind(' '), 3);
+    EXPECT_EQ(view.rfind('x'), StringView::npos);
+}
+
+TEST(StringView, findNotOf) {
+    const StringView view(" \tvalue \t");
+    EXPECT_EQ(view.findFirstNotOf(" \t"), 2);
+    EXPECT_EQ(view.findLastNotOf(" \t"), 6);
+    EXPECT_EQ(StringView(" \t").findFirstNotOf(" \t"), StringView::npos);
+    EXPECT_EQ(StringView(" \t").findLastNotOf(" \t"), StringView::npos);
+}
+
+TEST(StringView, startsEndsWith) {
+    const StringView view("line\r\n");
+    EXPECT_TRUE(view.startsWith("li"));
+    EXPECT_FALSE(view.startsWith("ne"));
+    EXPECT_TRUE(view.endsWith("\r\n"));
+    EXPECT_FALSE(view.endsWith("\n\n"));
+    EXPECT_FALSE(StringView("n").endsWith("\r\n"));
+}
+
+TEST(StringView, removeSuffix) {
+    StringView view("line\r\n");
+    view.removeSuffix(2);
+    EXPECT_EQ(view, "line");
+    view.removeSuffix(10);
+    EXPECT_TRUE(view.empty());
+}
@@ -0,0 +1,134 @@
+#include "task/timer_wheel.hpp"
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace {
+    std::vector<Timer *> popAll(TimerWheel &wheel) {
+        std::vector<Timer *> expired;
+        for (Timer *timer = wheel.popExpired(); timer != NULL; timer = wheel.popExpired()) {
+            expired.push_back(timer);
+        }
+        return expired;
+    }
+} // namespace
+
+TEST(TimerWheelTest, expiresAtDeadline) {
+    TimerWheel wheel(1000);
+    Timer timer(NULL);
+    wheel.arm(timer, 1010);
+    EXPECT_TRUE(timer.isArmed());
+    EXPECT_EQ(wheel.timeUntilNextExpiry(1000), 10);
+
+    wheel.advance(1009);
+    EXPECT_EQ(wheel.popExpired(), nullptr);
+
+    wheel.advance(1010);
+    EXPECT_EQ(wheel.popExpired(), &timer);
+    EXPECT_FALSE(timer.isArmed());
+    EXPECT_EQ(wheel.size(), 0);
+}
+
+TEST(TimerWheelTest, cancelledTimerDoesNotExpire) {
+    TimerWheel wheel(0);
+    Timer timer(NULL);
+    wheel.arm(timer, 5);
+    wheel.cancel(timer);
+    EXPECT_FALSE(timer.isArmed());
+    EXPECT_EQ(wheel.timeUntilNextExpiry(0), TimerWheel::kNoTimer);
+
+    wheel.advance(100);
+    EXPECT_EQ(wheel.popExpired(), nullptr);
+}
+
+TEST(TimerWheelTest, rearmReplacesDeadline) {
+    TimerWheel wheel(0);
+    Timer timer(NULL);
+    wheel.arm(timer, 5);
+    wheel.arm(timer, 5000);
+    EXPECT_EQ(wheel.size(), 1);
+
+    wheel.advance(4999);
+    EXPECT_EQ(wheel.popExpired(), nullptr);
+    wheel.advance(5000);
+    EXPECT_EQ(wheel.popExpired(), &timer);
+}
+
+// 上の段に置かれたタイマーも cascade されて期限ちょうどに切れる
+TEST(TimerWheelTest, cascadesFromUpperLevels) {
+    TimerWheel wheel(10);
+    const uint64_t deadlines[] = {70, 4105, 300000, 20000000, 40000000};
+    const std::size_t n = sizeof(deadlines) / sizeof(deadlines[0]);
+    std::vector<Timer *> timers;
+    for (std::size_t i = 0; i < n; i++) {
+        timers.push_back(new Timer(NULL));
+        wheel.arm(*timers[i], deadlines[i]);
+    }
+
+    for (std::size_t i = 0; i < n; i++) {
+        // 期限の直前まで 1 回で進めても早く切れない
+        wheel.advance(deadlines[i] - 1);
+        EXPECT_TRUE(popAll(wheel).empty()) << deadlines[i];
+        ASSERT_GE(wheel.timeUntilNextExpiry(deadlines[i] - 1), 0);
+        EXPECT_LE(wheel.timeUntilNextExpiry(deadlines[i] - 1), 1);
+
+        wheel.advance(deadlines[i]);
+        const std::vector<Timer *> expired = popAll(wheel);
+        ASSERT_EQ(expired.size(), 1);
+        EXPECT_EQ(expired[0], timers[i]);
+    }
+    for (std::size_t i = 0; i < n; i++) {
+        delete timers[i];
+    }
+}
+
+TEST(TimerWheelTest, pastDeadlineExpiresOnNextAdvance) {
+    TimerWheel wheel(100);
+    wheel.advance(200);
+    Timer timer(NULL);
+    wheel.arm(timer, 150);
+    EXPECT_EQ(wheel.timeUntilNextExpiry(200), 0);
+
+    wheel.advance(200);
+    EXPECT_EQ(wheel.popExpired(), &timer);
+}
+
+TEST(TimerWheelTest, destroyedTimerIsUnlinked) {
+    TimerWheel wheel(0);
+    {
+        Timer timer(NULL);
+        wheel.arm(timer, 10);
+        wheel.advance(10);
+    }
+    EXPECT_EQ(wheel.size(), 0);
+    EXPECT_EQ(wheel.popExpired(), nullptr);
+}
+
+// 大量のタイマーを設定しても, 期限の順に漏れなく切れる
+TEST(TimerWheelTest, manyTimers) {
+    const std::size_t n = 100000;
+    TimerWheel wheel(0);
+    std::vector<std::unique_ptr<Timer> > timers;
+    std::map<Timer *, uint64_t> deadlines;
+    for (std::size_t i = 0; i < n; i++) {
+        timers.emplace_back(new Timer(NULL));
+        deadlines[timers[i].get()] = (i * 7919) % 600000 + 1;
+        wheel.arm(*timers[i], deadlines[timers[i].get()]);
+    }
+    EXPECT_EQ(wheel.size(), n);
+
+    std::size_t expired = 0;
+    uint64_t now = 0;
+    while (wheel.size() > 0) {
+        const int wait = wheel.timeUntilNextExpiry(now);
+        ASSERT_NE(wait, TimerWheel::kNoTimer);
+        now += wait;
+        wheel.advance(now);
+        for (Timer *timer = wheel.popExpired(); timer != NULL; timer = wheel.popExpired()) {
+            EXPECT_EQ(deadlines[timer], now);
+            expired++;
+        }
+    }
+    EXPECT_EQ(expired, n);
+}
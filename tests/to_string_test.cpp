@@ -1,4 +1,6 @@
 #include "utils/utils.hpp"
+#include <climits>
+#include <cstring>
 #include <gtest/gtest.h>
 
 TEST(ToStringTest, IntToString) {
@@ -8,3 +10,31 @@ TEST(ToStringTest, IntToString) {
 
     ASSERT_EQ(expected, actual);
 }
+
+TEST(FormatDecimalTest, formatsWithoutTerminator) {
+    const unsigned long values[] = {0, 7, 10, 99, 100, 1000, 4096, 123456789, ULONG_MAX};
+    for (std::size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        char buf[utils::kMaxDecimalDigits + 1];
+        std::memset(buf, '#', sizeof(buf));
+        const std::size_t size = utils::formatDecimal(buf, values[i]);
+        EXPECT_EQ(std::string(buf, size), utils::toString(values[i]));
+        EXPECT_EQ(buf[size], '#');
+    }
+}
+
+TEST(ParseDecimalTest, parsesDigits) {
+    const unsigned long values[] = {0, 7, 10, 4096, 123456789, ULONG_MAX};
+    for (std::size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        const std::string str = utils::toString(values[i]);
+        EXPECT_EQ(utils::parseDecimal(str), Some(values[i])) << str;
+    }
+    EXPECT_EQ(utils::parseDecimal("007"), Some(7ul));
+}
+
+// 空, 数字以外, 符号, 空白, 溢れる値は読まない
+TEST(ParseDecimalTest, rejectsNonDecimal) {
+    const char *const strs[] = {"", "3x", "-1", "+1", " 1", "1 ", "18446744073709551616", "99999999999999999999999"};
+    for (std::size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++) {
+        EXPECT_TRUE(utils::parseDecimal(strs[i]).isNone()) << strs[i];
+    }
+}
@@ -0,0 +1,65 @@
+#include "allocation_counter.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::size_t allocation_count = 0;
+
+    void *allocate(std::size_t size) {
+        allocation_count++;
+        void *ptr = std::malloc(size == 0 ? 1 : size);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+} // namespace
+
+AllocationCounter::AllocationCounter() : start_(allocation_count) {}
+
+std::size_t AllocationCounter::count() const {
+    return allocation_count - start_;
+}
+
+// new / delete は組で置き換えないと, サニタイザーが確保と解放の不一致を検出する
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    allocation_count++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    allocation_count++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    std::free(ptr);
+}
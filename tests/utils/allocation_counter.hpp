@@ -0,0 +1,17 @@
+#ifndef TESTS_UTILS_ALLOCATION_COUNTER_HPP
+#define TESTS_UTILS_ALLOCATION_COUNTER_HPP
+
+#include <cstddef>
+
+// Counts the calls to the global operator new made while the counter is alive
+// Linking this file replaces the global operator new / delete of the test executable
+class AllocationCounter {
+public:
+    AllocationCounter();
+    std::size_t count() const;
+
+private:
+    std::size_t start_;
+};
+
+#endif //TESTS_UTILS_ALLOCATION_COUNTER_HPP
@@ -0,0 +1,14 @@
+#include "without_date.hpp"
+
+std::string withoutDate(const std::string &responses) {
+    std::string result = responses;
+    std::size_t pos = 0;
+    while ((pos = result.find("\r\nDate: ", pos)) != std::string::npos) {
+        const std::size_t end = result.find("\r\n", pos + 2);
+        if (end == std::string::npos) {
+            break;
+        }
+        result.erase(pos + 2, end - pos);
+    }
+    return result;
+}
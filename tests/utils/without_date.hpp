@@ -0,0 +1,9 @@
+#ifndef TESTS_UTILS_WITHOUT_DATE_HPP
+#define TESTS_UTILS_WITHOUT_DATE_HPP
+
+#include <string>
+
+// Removes the Date header lines from the responses, since their value depends on when they were written
+std::string withoutDate(const std::string &responses);
+
+#endif //TESTS_UTILS_WITHOUT_DATE_HPP